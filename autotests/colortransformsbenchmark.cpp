@@ -0,0 +1,173 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QColor>
+#include <QImage>
+
+#include "../ui/colortransforms.h"
+
+// The loops PagePainter used before ColorTransforms, to compare with.
+
+static void loopRecolor( QImage *image, const QColor &foreground, const QColor &background )
+{
+    const float scaleRed = background.redF() - foreground.redF();
+    const float scaleGreen = background.greenF() - foreground.greenF();
+    const float scaleBlue = background.blueF() - foreground.blueF();
+
+    for ( int y = 0; y < image->height(); y++ )
+    {
+        QRgb *pixels = reinterpret_cast< QRgb * >( image->scanLine( y ) );
+
+        for ( int x = 0; x < image->width(); x++ )
+        {
+            const int lightness = qGray( pixels[ x ] );
+            pixels[ x ] = qRgba( scaleRed * lightness + foreground.red(),
+                                 scaleGreen * lightness + foreground.green(),
+                                 scaleBlue * lightness + foreground.blue(),
+                                 qAlpha( pixels[ x ] ) );
+        }
+    }
+}
+
+static void loopBlackWhite( QImage *image, int con, int thr )
+{
+    unsigned int *data = (unsigned int *)image->bits();
+    int val, pixels = image->width() * image->height();
+    for ( int i = 0; i < pixels; ++i )
+    {
+        val = qGray( data[ i ] );
+        if ( val > thr )
+            val = 128 + ( 127 * ( val - thr ) ) / ( 255 - thr );
+        else if ( val < thr )
+            val = ( 128 * val ) / thr;
+        if ( con > 2 )
+        {
+            val = con * ( val - thr ) / 2 + thr;
+            if ( val > 255 )
+                val = 255;
+            else if ( val < 0 )
+                val = 0;
+        }
+        data[ i ] = qRgba( val, val, val, 255 );
+    }
+}
+
+// A page sized image of random opaque pixels, with an odd width so that the
+// pixels left after the vectorized ones are covered too.
+static QImage createImage()
+{
+    QImage image( 1275, 1650, QImage::Format_ARGB32_Premultiplied );
+    // a fixed linear congruential generator, for the same pixels everywhere
+    quint32 seed = 7;
+    for ( int y = 0; y < image.height(); ++y )
+    {
+        QRgb *pixels = reinterpret_cast< QRgb * >( image.scanLine( y ) );
+        for ( int x = 0; x < image.width(); ++x )
+        {
+            seed = seed * 1664525 + 1013904223;
+            pixels[ x ] = qRgba( ( seed >> 24 ) & 0xff, ( seed >> 16 ) & 0xff, ( seed >> 8 ) & 0xff, 255 );
+        }
+    }
+    return image;
+}
+
+static const QColor foreground( 0x20, 0xc0, 0x40 );
+static const QColor background( 0x10, 0x10, 0x30 );
+
+class ColorTransformsBenchmark : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void initTestCase();
+        void testRecolor();
+        void testBlackWhite_data();
+        void testBlackWhite();
+        void benchmarkRecolorLoop();
+        void benchmarkRecolor();
+        void benchmarkBlackWhiteLoop();
+        void benchmarkBlackWhite();
+
+    private:
+        QImage m_image;
+};
+
+void ColorTransformsBenchmark::initTestCase()
+{
+    m_image = createImage();
+}
+
+void ColorTransformsBenchmark::testRecolor()
+{
+    QImage expected = m_image.copy();
+    loopRecolor( &expected, foreground, background );
+    QImage image = m_image.copy();
+    ColorTransforms::recolor( &image, foreground, background );
+    QCOMPARE( image, expected );
+}
+
+void ColorTransformsBenchmark::testBlackWhite_data()
+{
+    QTest::addColumn< int >( "contrast" );
+    QTest::addColumn< int >( "threshold" );
+
+    QTest::newRow( "defaults" ) << 2 << 127;
+    QTest::newRow( "contrast" ) << 6 << 100;
+    QTest::newRow( "dark threshold" ) << 4 << 0;
+    QTest::newRow( "light threshold" ) << 4 << 255;
+}
+
+void ColorTransformsBenchmark::testBlackWhite()
+{
+    QFETCH( int, contrast );
+    QFETCH( int, threshold );
+
+    QImage expected = m_image.copy();
+    loopBlackWhite( &expected, contrast, threshold );
+    QImage image = m_image.copy();
+    ColorTransforms::blackWhite( &image, contrast, threshold );
+    QCOMPARE( image, expected );
+}
+
+void ColorTransformsBenchmark::benchmarkRecolorLoop()
+{
+    QImage image = m_image.copy();
+    QBENCHMARK {
+        loopRecolor( &image, foreground, background );
+    }
+}
+
+void ColorTransformsBenchmark::benchmarkRecolor()
+{
+    QImage image = m_image.copy();
+    QBENCHMARK {
+        ColorTransforms::recolor( &image, foreground, background );
+    }
+}
+
+void ColorTransformsBenchmark::benchmarkBlackWhiteLoop()
+{
+    QImage image = m_image.copy();
+    QBENCHMARK {
+        loopBlackWhite( &image, 4, 127 );
+    }
+}
+
+void ColorTransformsBenchmark::benchmarkBlackWhite()
+{
+    QImage image = m_image.copy();
+    QBENCHMARK {
+        ColorTransforms::blackWhite( &image, 4, 127 );
+    }
+}
+
+QTEST_MAIN( ColorTransformsBenchmark )
+#include "colortransformsbenchmark.moc"
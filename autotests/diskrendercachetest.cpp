@@ -0,0 +1,145 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QImage>
+#include <QPixmap>
+#include <QTemporaryDir>
+#include <QTransform>
+
+#include "../core/diskrendercache_p.h"
+#include "../core/generator.h"
+#include "../core/thumbnailpipeline_p.h"
+
+Q_DECLARE_METATYPE( Okular::PixmapRequest * )
+Q_DECLARE_METATYPE( Okular::Rotation )
+
+class DiskRenderCacheTest : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void initTestCase();
+        void testRoundTrip_data();
+        void testRoundTrip();
+        void testRetrieve();
+        void testThumbnailPipeline();
+
+    private:
+        QTemporaryDir m_cacheDir;
+};
+
+static const QString hints = QStringLiteral( "hints" );
+
+// opaque, so that PNG gives back the very same pixels
+static QImage createImage( int width, int height )
+{
+    QImage image( width, height, QImage::Format_ARGB32_Premultiplied );
+    for ( int y = 0; y < height; ++y )
+        for ( int x = 0; x < width; ++x )
+            image.setPixel( x, y, qRgb( x * 5, y * 7, ( x + y ) % 256 ) );
+    return image;
+}
+
+void DiskRenderCacheTest::initTestCase()
+{
+    QVERIFY( m_cacheDir.isValid() );
+    // the caches live in the generic cache location
+    qputenv( "XDG_CACHE_HOME", QFile::encodeName( m_cacheDir.path() ) );
+    qRegisterMetaType< Okular::PixmapRequest * >();
+    qRegisterMetaType< Okular::Rotation >();
+}
+
+void DiskRenderCacheTest::testRoundTrip_data()
+{
+    QTest::addColumn< int >( "storage" );
+
+    QTest::newRow( "raw" ) << (int)Okular::DiskRenderCache::Raw;
+    QTest::newRow( "compressed" ) << (int)Okular::DiskRenderCache::Compressed;
+}
+
+void DiskRenderCacheTest::testRoundTrip()
+{
+    QFETCH( int, storage );
+
+    Okular::DiskRenderCache cache( QStringLiteral( "roundtrip" ), (Okular::DiskRenderCache::Storage)storage );
+    cache.open( QStringLiteral( "document" ), 1024 * 1024 );
+    QVERIFY( cache.cacheRoot().startsWith( m_cacheDir.path() ) );
+
+    const QImage image = createImage( 40, 30 );
+    cache.store( 3, QPixmap::fromImage( image ), hints );
+    const QString fileName = cache.fileName( 3, 40, 30, hints );
+    QTRY_VERIFY( QFile::exists( fileName ) );
+
+    QCOMPARE( cache.loadFile( fileName, 40, 30 ).convertToFormat( image.format() ), image );
+    // a render of another size is not one
+    QVERIFY( cache.loadFile( fileName, 30, 40 ).isNull() );
+
+    cache.removePage( 3 );
+    QTRY_VERIFY( !QFile::exists( fileName ) );
+}
+
+void DiskRenderCacheTest::testRetrieve()
+{
+    Okular::DiskRenderCache cache;
+    cache.open( QStringLiteral( "document" ), 1024 * 1024 );
+    QSignalSpy spy( &cache, &Okular::DiskRenderCache::retrieved );
+
+    Okular::PixmapRequest request( nullptr, 0, 20, 10, 0, Okular::PixmapRequest::Asynchronous );
+    QVERIFY( !cache.retrieve( &request, hints ) );
+
+    const QImage image = createImage( request.width(), request.height() );
+    cache.store( 0, QPixmap::fromImage( image ), hints );
+    QTRY_VERIFY( QFile::exists( cache.fileName( 0, request.width(), request.height(), hints ) ) );
+
+    QVERIFY( cache.retrieve( &request, hints ) );
+    QTRY_COMPARE( spy.count(), 1 );
+    QCOMPARE( spy.at( 0 ).at( 0 ).value< Okular::PixmapRequest * >(), &request );
+    QCOMPARE( spy.at( 0 ).at( 1 ).value< QImage >().convertToFormat( image.format() ), image );
+    QCOMPARE( spy.at( 0 ).at( 2 ).value< Okular::Rotation >(), Okular::Rotation0 );
+
+    // a page shown turned gets the unrotated render, turned
+    Okular::PixmapRequest rotatedRequest( nullptr, 0, 10, 20, 0, Okular::PixmapRequest::Asynchronous );
+    QVERIFY( !cache.retrieve( &rotatedRequest, hints ) );
+    QVERIFY( cache.retrieve( &rotatedRequest, hints, Okular::Rotation90 ) );
+    QTRY_COMPARE( spy.count(), 2 );
+    QCOMPARE( spy.at( 1 ).at( 0 ).value< Okular::PixmapRequest * >(), &rotatedRequest );
+    QCOMPARE( spy.at( 1 ).at( 1 ).value< QImage >().convertToFormat( image.format() ), image.transformed( QTransform().rotate( 90 ) ) );
+    QCOMPARE( spy.at( 1 ).at( 2 ).value< Okular::Rotation >(), Okular::Rotation90 );
+}
+
+void DiskRenderCacheTest::testThumbnailPipeline()
+{
+    Okular::ThumbnailPipeline pipeline;
+    QVERIFY( !pipeline.isOpen() );
+    pipeline.open( QStringLiteral( "document" ), 1024 * 1024, nullptr );
+    QVERIFY( pipeline.isOpen() );
+    QSignalSpy spy( &pipeline, &Okular::ThumbnailPipeline::fetched );
+
+    Okular::PixmapRequest request( nullptr, 1, 16, 24, 0, Okular::PixmapRequest::Asynchronous | Okular::PixmapRequest::Thumbnail );
+
+    // not kept yet
+    pipeline.fetch( &request, hints );
+    QTRY_COMPARE( spy.count(), 1 );
+    QVERIFY( spy.at( 0 ).at( 1 ).value< QImage >().isNull() );
+
+    const QImage image = createImage( request.width(), request.height() );
+    pipeline.store( 1, QPixmap::fromImage( image ), hints );
+    const QDir directory( m_cacheDir.path() + QStringLiteral( "/okular/thumbnails/document" ) );
+    QTRY_VERIFY( !directory.entryList( QDir::Files ).isEmpty() );
+
+    pipeline.fetch( &request, hints );
+    QTRY_COMPARE( spy.count(), 2 );
+    QCOMPARE( spy.at( 1 ).at( 0 ).value< Okular::PixmapRequest * >(), &request );
+    QCOMPARE( spy.at( 1 ).at( 1 ).value< QImage >().convertToFormat( image.format() ), image );
+}
+
+QTEST_MAIN( DiskRenderCacheTest )
+#include "diskrendercachetest.moc"
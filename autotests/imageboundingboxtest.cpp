@@ -0,0 +1,108 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <QImage>
+
+#include "../core/area.h"
+#include "../core/utils.h"
+#include "../settings_core.h"
+
+class ImageBoundingBoxTest : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void initTestCase();
+        void testBlank();
+        void testInk_data();
+        void testInk();
+        void testPremultiplied();
+        void testIndexed();
+};
+
+static const int width = 37;
+static const int height = 23;
+
+static QImage paperImage( QImage::Format format )
+{
+    QImage image( width, height, format );
+    image.fill( Okular::SettingsCore::paperColor() );
+    return image;
+}
+
+static Okular::NormalizedRect normalized( const QRect &rect )
+{
+    return Okular::NormalizedRect( rect, width, height );
+}
+
+void ImageBoundingBoxTest::initTestCase()
+{
+    Okular::SettingsCore::instance( QStringLiteral("imageboundingboxtest") );
+}
+
+void ImageBoundingBoxTest::testBlank()
+{
+    const QImage image = paperImage( QImage::Format_RGB32 );
+    QCOMPARE( Okular::Utils::imageBoundingBox( &image ), Okular::NormalizedRect( 0, 0, 0, 0 ) );
+}
+
+void ImageBoundingBoxTest::testInk_data()
+{
+    QTest::addColumn< QList< QPoint > >( "points" );
+    QTest::addColumn< QRect >( "box" );
+
+    QTest::newRow( "corner" ) << ( QList< QPoint >() << QPoint( 0, 0 ) ) << QRect( 0, 0, 1, 1 );
+    QTest::newRow( "last pixel" ) << ( QList< QPoint >() << QPoint( width - 1, height - 1 ) ) << QRect( width - 1, height - 1, 1, 1 );
+    QTest::newRow( "diagonal" ) << ( QList< QPoint >() << QPoint( 30, 2 ) << QPoint( 5, 20 ) ) << QRect( 5, 2, 26, 19 );
+    // the widest row is neither the first nor the last one, nor a row of the estimate
+    QTest::newRow( "middle row" ) << ( QList< QPoint >() << QPoint( 18, 1 ) << QPoint( 1, 12 ) << QPoint( 35, 12 ) << QPoint( 18, 21 ) )
+                                  << QRect( 1, 1, 35, 21 );
+    // a column right next to the one known from the first and last rows
+    QTest::newRow( "next column" ) << ( QList< QPoint >() << QPoint( 10, 3 ) << QPoint( 11, 5 ) << QPoint( 10, 7 ) ) << QRect( 10, 3, 2, 5 );
+}
+
+void ImageBoundingBoxTest::testInk()
+{
+    QFETCH( QList< QPoint >, points );
+    QFETCH( QRect, box );
+
+    QImage image = paperImage( QImage::Format_ARGB32 );
+    foreach ( const QPoint &point, points )
+        image.setPixel( point, qRgb( 0, 0, 0 ) );
+    QCOMPARE( Okular::Utils::imageBoundingBox( &image ), normalized( box ) );
+}
+
+void ImageBoundingBoxTest::testPremultiplied()
+{
+    // the premultiplied values are compared as they are, as QImage::pixel()
+    // gives them: an opaque pixel of the paper color is paper whatever the
+    // format, a translucent one is not
+    QImage image = paperImage( QImage::Format_ARGB32_Premultiplied );
+    QCOMPARE( Okular::Utils::imageBoundingBox( &image ), Okular::NormalizedRect( 0, 0, 0, 0 ) );
+
+    QColor translucentPaper = Okular::SettingsCore::paperColor();
+    translucentPaper.setAlpha( 128 );
+    image.setPixelColor( 3, 4, translucentPaper );
+    QCOMPARE( Okular::Utils::imageBoundingBox( &image ), normalized( QRect( 3, 4, 1, 1 ) ) );
+}
+
+void ImageBoundingBoxTest::testIndexed()
+{
+    QImage image = paperImage( QImage::Format_RGB32 ).convertToFormat( QImage::Format_Indexed8 );
+    image.setColorCount( 2 );
+    image.setColor( 1, qRgb( 0, 0, 0 ) );
+    image.setPixel( 7, 8, 1 );
+    image.setPixel( 9, 15, 1 );
+    QCOMPARE( Okular::Utils::imageBoundingBox( &image ), normalized( QRect( 7, 8, 3, 8 ) ) );
+}
+
+QTEST_MAIN( ImageBoundingBoxTest )
+#include "imageboundingboxtest.moc"
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "../core/memorybudget_p.h"
+
+class MemoryBudgetTest : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void init();
+        void testNoCgroup();
+        void testCgroupLimit();
+        void testTightestAncestor();
+        void testPressure();
+        void testCgroupPressure();
+
+    private:
+        void writeFile( const QString &fileName, const QByteArray &contents );
+
+        QScopedPointer< QTemporaryDir > m_root;
+};
+
+void MemoryBudgetTest::init()
+{
+    m_root.reset( new QTemporaryDir );
+    QVERIFY( m_root->isValid() );
+}
+
+void MemoryBudgetTest::writeFile( const QString &fileName, const QByteArray &contents )
+{
+    const QString path = m_root->path() + fileName;
+    QVERIFY( QDir().mkpath( QFileInfo( path ).absolutePath() ) );
+    QFile file( path );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    file.write( contents );
+}
+
+void MemoryBudgetTest::testNoCgroup()
+{
+    // cgroup v1 only
+    writeFile( QStringLiteral( "/proc/self/cgroup" ), "4:memory:/user.slice\n" );
+    Okular::MemoryBudget budget( m_root->path() + QStringLiteral( "/proc" ), m_root->path() + QStringLiteral( "/cgroup" ) );
+    budget.update( 1000, true );
+    QVERIFY( !budget.hasLimit() );
+    QCOMPARE( budget.pressure(), -1.0 );
+    QCOMPARE( budget.pixmapBudget( 1000 ), ~Q_UINT64_C( 0 ) );
+}
+
+void MemoryBudgetTest::testCgroupLimit()
+{
+    writeFile( QStringLiteral( "/proc/self/cgroup" ), "0::/app.slice/okular.scope\n" );
+    writeFile( QStringLiteral( "/cgroup/app.slice/okular.scope/memory.max" ), "1000000\n" );
+    writeFile( QStringLiteral( "/cgroup/app.slice/okular.scope/memory.current" ), "600000\n" );
+    writeFile( QStringLiteral( "/cgroup/app.slice/memory.max" ), "max\n" );
+    writeFile( QStringLiteral( "/cgroup/app.slice/memory.current" ), "5000000\n" );
+    Okular::MemoryBudget budget( m_root->path() + QStringLiteral( "/proc" ), m_root->path() + QStringLiteral( "/cgroup" ) );
+    budget.update( 1000, true );
+    QVERIFY( budget.hasLimit() );
+    QCOMPARE( budget.limit(), Q_UINT64_C( 1000000 ) );
+    QCOMPARE( budget.usage(), Q_UINT64_C( 600000 ) );
+    QCOMPARE( budget.available(), Q_UINT64_C( 400000 ) );
+
+    // 400000 used by the rest of the process, 100000 kept in reserve
+    QCOMPARE( budget.pixmapBudget( 200000 ), Q_UINT64_C( 500000 ) );
+}
+
+void MemoryBudgetTest::testTightestAncestor()
+{
+    writeFile( QStringLiteral( "/proc/self/cgroup" ), "0::/user.slice/okular.scope\n" );
+    writeFile( QStringLiteral( "/cgroup/user.slice/okular.scope/memory.max" ), "8000000\n" );
+    writeFile( QStringLiteral( "/cgroup/user.slice/okular.scope/memory.current" ), "1000000\n" );
+    writeFile( QStringLiteral( "/cgroup/user.slice/memory.max" ), "4000000\n" );
+    writeFile( QStringLiteral( "/cgroup/user.slice/memory.current" ), "3000000\n" );
+    Okular::MemoryBudget budget( m_root->path() + QStringLiteral( "/proc" ), m_root->path() + QStringLiteral( "/cgroup" ) );
+    budget.update( 1000, true );
+    QVERIFY( budget.hasLimit() );
+    QCOMPARE( budget.limit(), Q_UINT64_C( 4000000 ) );
+    QCOMPARE( budget.available(), Q_UINT64_C( 1000000 ) );
+}
+
+void MemoryBudgetTest::testPressure()
+{
+    writeFile( QStringLiteral( "/proc/pressure/memory" ), "some avg10=1.50 avg60=0.00 avg300=0.00 total=100\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n" );
+    Okular::MemoryBudget budget( m_root->path() + QStringLiteral( "/proc" ), m_root->path() + QStringLiteral( "/cgroup" ) );
+    budget.update( 1000, true );
+    QCOMPARE( budget.pressure(), 1.5 );
+    QCOMPARE( budget.pixmapBudget( 1000 ), ~Q_UINT64_C( 0 ) );
+
+    writeFile( QStringLiteral( "/proc/pressure/memory" ), "some avg10=20.00 avg60=5.00 avg300=1.00 total=100\n" );
+    budget.update( 1000 );
+    QCOMPARE( budget.pressure(), 1.5 );
+    budget.update( 1000, true );
+    QCOMPARE( budget.pressure(), 20.0 );
+    QCOMPARE( budget.pixmapBudget( 1000 ), Q_UINT64_C( 800 ) );
+
+    // the target holds until the next update, whatever the pixmaps use
+    QCOMPARE( budget.pixmapBudget( 800 ), Q_UINT64_C( 800 ) );
+    budget.update( 800 );
+    QCOMPARE( budget.pixmapBudget( 800 ), Q_UINT64_C( 800 ) );
+    budget.update( 800, true );
+    QCOMPARE( budget.pixmapBudget( 800 ), Q_UINT64_C( 640 ) );
+}
+
+void MemoryBudgetTest::testCgroupPressure()
+{
+    writeFile( QStringLiteral( "/proc/self/cgroup" ), "0::/app.slice/okular.scope\n" );
+    writeFile( QStringLiteral( "/proc/pressure/memory" ), "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n" );
+    writeFile( QStringLiteral( "/cgroup/app.slice/okular.scope/memory.max" ), "1000000\n" );
+    writeFile( QStringLiteral( "/cgroup/app.slice/okular.scope/memory.current" ), "600000\n" );
+    writeFile( QStringLiteral( "/cgroup/app.slice/okular.scope/memory.pressure" ), "some avg10=30.00 avg60=5.00 avg300=1.00 total=100\n" );
+    Okular::MemoryBudget budget( m_root->path() + QStringLiteral( "/proc" ), m_root->path() + QStringLiteral( "/cgroup" ) );
+    budget.update( 1000, true );
+    QCOMPARE( budget.pressure(), 30.0 );
+    QCOMPARE( budget.pixmapBudget( 1000 ), Q_UINT64_C( 700 ) );
+}
+
+QTEST_MAIN( MemoryBudgetTest )
+#include "memorybudgettest.moc"
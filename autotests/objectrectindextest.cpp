@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include "../core/annotations.h"
+#include "../core/area.h"
+#include "../core/page.h"
+
+class ObjectRectIndexTest : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void testForegroundFirst();
+        void testMatchesLinearScan();
+        void testAnnotations();
+        void testInvalidate();
+};
+
+static const double pageWidth = 600;
+static const double pageHeight = 800;
+
+// the link rects of a 40x40 grid, a few pixels apart
+static QLinkedList< Okular::ObjectRect * > gridOfLinks()
+{
+    QLinkedList< Okular::ObjectRect * > rects;
+    for ( int row = 0; row < 40; ++row )
+        for ( int column = 0; column < 40; ++column )
+            rects.append( new Okular::ObjectRect( column / 40.0, row / 40.0, ( column + 0.6 ) / 40.0, ( row + 0.6 ) / 40.0,
+                                                  false, Okular::ObjectRect::Action, nullptr ) );
+    return rects;
+}
+
+void ObjectRectIndexTest::testForegroundFirst()
+{
+    Okular::Page page( 0, pageWidth, pageHeight, Okular::Rotation0 );
+    QLinkedList< Okular::ObjectRect * > rects = gridOfLinks();
+    // a pile of links over the same spot, the last one on top
+    QList< Okular::ObjectRect * > pile;
+    for ( int i = 0; i < 5; ++i )
+    {
+        pile.append( new Okular::ObjectRect( 0.5, 0.5, 0.52, 0.52, false, Okular::ObjectRect::Action, nullptr ) );
+        rects.append( pile.last() );
+    }
+    page.setObjectRects( rects );
+
+    QCOMPARE( page.objectRect( Okular::ObjectRect::Action, 0.51, 0.51, pageWidth, pageHeight ), pile.last() );
+
+    const QLinkedList< const Okular::ObjectRect * > found = page.objectRects( Okular::ObjectRect::Action, 0.51, 0.51, pageWidth, pageHeight );
+    QList< const Okular::ObjectRect * > foundPile;
+    foreach ( const Okular::ObjectRect *rect, found )
+        if ( pile.contains( const_cast< Okular::ObjectRect * >( rect ) ) )
+            foundPile.append( rect );
+    QCOMPARE( foundPile.count(), pile.count() );
+    for ( int i = 0; i < pile.count(); ++i )
+        QCOMPARE( foundPile.at( i ), pile.at( pile.count() - 1 - i ) );
+}
+
+void ObjectRectIndexTest::testMatchesLinearScan()
+{
+    Okular::Page page( 0, pageWidth, pageHeight, Okular::Rotation0 );
+    const QLinkedList< Okular::ObjectRect * > rects = gridOfLinks();
+    page.setObjectRects( rects );
+
+    qsrand( 42 );
+    for ( int i = 0; i < 2000; ++i )
+    {
+        const double x = qrand() / (double)RAND_MAX;
+        const double y = qrand() / (double)RAND_MAX;
+        const double scale = 0.5 + 2.0 * qrand() / (double)RAND_MAX;
+
+        const Okular::ObjectRect *expected = nullptr;
+        foreach ( const Okular::ObjectRect *rect, rects )
+            if ( rect->distanceSqr( x, y, pageWidth * scale, pageHeight * scale ) < 25 )
+                expected = rect;
+
+        QCOMPARE( page.objectRect( Okular::ObjectRect::Action, x, y, pageWidth * scale, pageHeight * scale ), expected );
+        QCOMPARE( page.hasObjectRect( x, y, pageWidth * scale, pageHeight * scale ), expected != nullptr );
+    }
+}
+
+void ObjectRectIndexTest::testAnnotations()
+{
+    Okular::Page page( 0, pageWidth, pageHeight, Okular::Rotation0 );
+    for ( int i = 0; i < 100; ++i )
+    {
+        Okular::TextAnnotation *note = new Okular::TextAnnotation();
+        note->setBoundingRectangle( Okular::NormalizedRect( ( i % 10 ) / 10.0, ( i / 10 ) / 10.0, ( i % 10 ) / 10.0 + 0.05, ( i / 10 ) / 10.0 + 0.05 ) );
+        page.addAnnotation( note );
+    }
+
+    // a line whose points go past its boundary, drawn with a thick pen
+    Okular::LineAnnotation *line = new Okular::LineAnnotation();
+    line->setBoundingRectangle( Okular::NormalizedRect( 0.1, 0.92, 0.2, 0.93 ) );
+    QLinkedList< Okular::NormalizedPoint > points;
+    points << Okular::NormalizedPoint( 0.1, 0.925 ) << Okular::NormalizedPoint( 0.9, 0.925 );
+    line->setLinePoints( points );
+    line->style().setWidth( 20 );
+    page.addAnnotation( line );
+
+    const Okular::ObjectRect *rect = page.objectRect( Okular::ObjectRect::OAnnotation, 0.77, 0.925 + 9 / pageHeight, pageWidth, pageHeight );
+    QVERIFY( rect );
+    QCOMPARE( static_cast< const Okular::AnnotationObjectRect * >( rect )->annotation(), line );
+
+    rect = page.objectRect( Okular::ObjectRect::OAnnotation, 0.52, 0.52, pageWidth, pageHeight );
+    QVERIFY( rect );
+    QCOMPARE( static_cast< const Okular::AnnotationObjectRect * >( rect )->annotation()->boundingRectangle().left, 0.5 );
+}
+
+void ObjectRectIndexTest::testInvalidate()
+{
+    Okular::Page page( 0, pageWidth, pageHeight, Okular::Rotation0 );
+    page.setObjectRects( gridOfLinks() );
+    QVERIFY( page.objectRect( Okular::ObjectRect::Action, 0.01, 0.01, pageWidth, pageHeight ) );
+
+    // the links are replaced by ones only on the right half
+    QLinkedList< Okular::ObjectRect * > rects;
+    for ( int i = 0; i < 50; ++i )
+        rects.append( new Okular::ObjectRect( 0.5 + i / 100.0, 0.0, 0.5 + ( i + 0.5 ) / 100.0, 1.0, false, Okular::ObjectRect::Action, nullptr ) );
+    page.setObjectRects( rects );
+    QVERIFY( !page.objectRect( Okular::ObjectRect::Action, 0.01, 0.01, pageWidth, pageHeight ) );
+    QCOMPARE( page.objectRect( Okular::ObjectRect::Action, 0.751, 0.5, pageWidth, pageHeight ), rects.toList().at( 25 ) );
+}
+
+QTEST_MAIN( ObjectRectIndexTest )
+#include "objectrectindextest.moc"
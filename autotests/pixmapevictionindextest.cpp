@@ -0,0 +1,187 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include "../core/observer.h"
+#include "../core/pixmapevictionindex_p.h"
+
+class PinningObserver : public Okular::DocumentObserver
+{
+    public:
+        bool canUnloadPixmap( int page ) const override
+        {
+            return !m_pinnedPages.contains( page );
+        }
+
+        QSet< int > m_pinnedPages;
+};
+
+class PixmapEvictionIndexTest : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void testFarthest();
+        void testUnloadableOnly();
+        void testTakeFarthestBudget();
+        void testTakeAndRemoveObserver();
+        void testLeastRecentlyUsed();
+        void testCostWeighted();
+};
+
+void PixmapEvictionIndexTest::testFarthest()
+{
+    PinningObserver o1, o2;
+    Okular::PixmapEvictionIndex index;
+    for ( int page = 0; page < 10; ++page )
+        index.insert( new AllocatedPixmap( &o1, page, 100 ) );
+    index.insert( new AllocatedPixmap( &o2, 30, 100 ) );
+    QCOMPARE( index.count(), 11 );
+
+    AllocatedPixmap *p = index.farthest( 5, false, false );
+    QVERIFY( p->observer == &o2 );
+    QCOMPARE( p->page, 30 );
+    QCOMPARE( index.count(), 11 );
+
+    p = index.farthest( 5, false, false, &o1 );
+    QCOMPARE( p->page, 0 );
+
+    p = index.farthest( 2, false, true, &o1 );
+    QCOMPARE( p->page, 9 );
+    QCOMPARE( index.count(), 10 );
+    delete p;
+
+    // the order follows the viewport without any update of the index
+    p = index.farthest( 8, false, false, &o1 );
+    QCOMPARE( p->page, 0 );
+}
+
+void PixmapEvictionIndexTest::testUnloadableOnly()
+{
+    PinningObserver o1;
+    Okular::PixmapEvictionIndex index;
+    for ( int page = 0; page < 10; ++page )
+        index.insert( new AllocatedPixmap( &o1, page, 100 ) );
+    o1.m_pinnedPages << 0 << 1 << 9;
+
+    AllocatedPixmap *p = index.farthest( 5, true, false );
+    QCOMPARE( p->page, 2 );
+
+    for ( int page = 0; page < 10; ++page )
+        o1.m_pinnedPages << page;
+    QVERIFY( !index.farthest( 5, true, false ) );
+    QVERIFY( index.farthest( 5, false, false ) );
+}
+
+void PixmapEvictionIndexTest::testTakeFarthestBudget()
+{
+    PinningObserver o1, o2;
+    Okular::PixmapEvictionIndex index;
+    for ( int page = 0; page < 10; ++page )
+        index.insert( new AllocatedPixmap( &o1, page, 100 ) );
+    for ( int page = 10; page < 15; ++page )
+        index.insert( new AllocatedPixmap( &o2, page, 10 ) );
+    o2.m_pinnedPages << 14;
+
+    QVERIFY( index.takeFarthest( 0, 0 ).isEmpty() );
+
+    // pages 13 to 10 of o2, then pages 9 to 7 of o1
+    QList< AllocatedPixmap * > evicted = index.takeFarthest( 0, 250 );
+    QCOMPARE( evicted.count(), 7 );
+    qulonglong memory = 0;
+    int expectedPage = 13;
+    foreach ( AllocatedPixmap *p, evicted )
+    {
+        QCOMPARE( p->page, expectedPage-- );
+        QVERIFY( p->observer == ( p->page >= 10 ? &o2 : &o1 ) );
+        memory += p->memory;
+    }
+    QCOMPARE( memory, qulonglong( 340 ) );
+    QCOMPARE( index.count(), 8 );
+    qDeleteAll( evicted );
+
+    evicted = index.takeFarthest( 0, 1000000 );
+    QCOMPARE( evicted.count(), 7 );
+    QCOMPARE( index.count(), 1 );
+    qDeleteAll( evicted );
+}
+
+void PixmapEvictionIndexTest::testTakeAndRemoveObserver()
+{
+    PinningObserver o1, o2;
+    Okular::PixmapEvictionIndex index;
+    index.insert( new AllocatedPixmap( &o1, 3, 100 ) );
+    index.insert( new AllocatedPixmap( &o1, 4, 100 ) );
+    index.insert( new AllocatedPixmap( &o2, 3, 10 ) );
+
+    QVERIFY( !index.take( &o2, 4 ) );
+    AllocatedPixmap *p = index.take( &o1, 3 );
+    QVERIFY( p );
+    QVERIFY( p->observer == &o1 );
+    delete p;
+    QCOMPARE( index.count(), 2 );
+
+    QCOMPARE( index.removeObserver( &o2 ), qulonglong( 10 ) );
+    QCOMPARE( index.removeObserver( &o2 ), qulonglong( 0 ) );
+    QCOMPARE( index.count(), 1 );
+
+    index.clear();
+    QVERIFY( index.isEmpty() );
+}
+
+void PixmapEvictionIndexTest::testLeastRecentlyUsed()
+{
+    PinningObserver o1;
+    Okular::PixmapEvictionIndex index;
+    for ( int page = 0; page < 5; ++page )
+        index.insert( new AllocatedPixmap( &o1, page, 100 ) );
+    QVERIFY( index.touch( &o1, 0 ) );
+    QVERIFY( !index.touch( &o1, 7 ) );
+
+    index.setPolicy( Okular::PixmapEvictionIndex::LeastRecentlyUsed );
+    QCOMPARE( index.farthest( 0, false, false )->page, 1 );
+
+    QVERIFY( index.touch( &o1, 1 ) );
+    o1.m_pinnedPages << 2;
+    QList< AllocatedPixmap * > evicted = index.takeFarthest( 0, 200 );
+    QCOMPARE( evicted.count(), 2 );
+    QCOMPARE( evicted.at( 0 )->page, 3 );
+    QCOMPARE( evicted.at( 1 )->page, 4 );
+    qDeleteAll( evicted );
+
+    // back to the distance order
+    index.setPolicy( Okular::PixmapEvictionIndex::Distance );
+    QCOMPARE( index.farthest( 0, false, false )->page, 2 );
+}
+
+void PixmapEvictionIndexTest::testCostWeighted()
+{
+    PinningObserver o1;
+    Okular::PixmapEvictionIndex index;
+    index.setPolicy( Okular::PixmapEvictionIndex::CostWeighted );
+    index.insert( new AllocatedPixmap( &o1, 0, 100, 800 ) );
+    index.insert( new AllocatedPixmap( &o1, 1, 100, 5 ) );
+    index.insert( new AllocatedPixmap( &o1, 2, 100, 50 ) );
+
+    // the cheapest page goes first, whatever its distance
+    QList< AllocatedPixmap * > evicted = index.takeFarthest( 1, 100 );
+    QCOMPARE( evicted.count(), 1 );
+    QCOMPARE( evicted.at( 0 )->page, 1 );
+    qDeleteAll( evicted );
+
+    QCOMPARE( index.farthest( 1, false, false )->page, 2 );
+
+    // the same cost, a bigger pixmap: less credit per byte
+    index.insert( new AllocatedPixmap( &o1, 3, 10000, 50 ) );
+    QCOMPARE( index.farthest( 1, false, false )->page, 3 );
+}
+
+QTEST_MAIN( PixmapEvictionIndexTest )
+#include "pixmapevictionindextest.moc"
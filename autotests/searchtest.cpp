@@ -12,6 +12,7 @@
 #include "../core/document.h"
 #include "../core/page.h"
 #include "../core/textpage.h"
+#include "../core/textpage_p.h"
 #include "../settings_core.h"
 
 Q_DECLARE_METATYPE(Okular::Document::SearchStatus)
@@ -48,6 +49,7 @@ class SearchTest : public QObject
         void testHyphenAtEndOfPage();
         void testOneColumn();
         void testTwoColumns();
+        void testSearchOptions();
 };
 
 void SearchTest::initTestCase()
@@ -430,5 +432,56 @@ void SearchTest::testTwoColumns()
   delete page;
 }
 
+static int countMatches(Okular::TextPage *tp, const Okular::SearchPattern &pattern, bool forward)
+{
+    Okular::TextPagePrivate *d = Okular::TextPagePrivate::get(tp);
+    int count = 0;
+    Okular::RegularAreaRect* result = d->findText(0, pattern, forward ? Okular::FromTop : Okular::FromBottom);
+    while (result) {
+        ++count;
+        delete result;
+        result = d->findText(0, pattern, forward ? Okular::NextResult : Okular::PreviousResult);
+    }
+    return count;
+}
+
+void SearchTest::testSearchOptions()
+{
+  QVector<QString> text;
+  text << QStringLiteral("The") << QStringLiteral(" ") << QString::fromUtf8("résumé") << QStringLiteral(" ")
+       << QStringLiteral("theme") << QStringLiteral(" ") << QStringLiteral("2026");
+
+  QVector<Okular::NormalizedRect> rect;
+  for (int i = 0; i < text.size(); i++) {
+    rect << Okular::NormalizedRect(0.1*i, 0.0, 0.1*(i+1), 0.1);
+  }
+
+  CREATE_PAGE;
+
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("the"), Qt::CaseInsensitive), true), 2);
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("the"), Qt::CaseInsensitive, Okular::WholeWordsSearchOption), true), 1);
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("the"), Qt::CaseInsensitive, Okular::WholeWordsSearchOption), false), 1);
+
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("resume"), Qt::CaseSensitive), true), 0);
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("resume"), Qt::CaseSensitive, Okular::IgnoreAccentsSearchOption), true), 1);
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("RESUME"), Qt::CaseInsensitive, Okular::IgnoreAccentsSearchOption), false), 1);
+
+  // the match of an accentless text covers the accented letters
+  Okular::RegularAreaRect* result = Okular::TextPagePrivate::get(tp)->findText(0, Okular::SearchPattern(QStringLiteral("resume"),
+      Qt::CaseSensitive, Okular::IgnoreAccentsSearchOption), Okular::FromTop);
+  QVERIFY(result);
+  QCOMPARE(tp->text(result), QString::fromUtf8("résumé"));
+  delete result;
+
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("\\d{4}"), Qt::CaseSensitive, Okular::RegularExpressionSearchOption), true), 1);
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("th\\w+"), Qt::CaseInsensitive, Okular::RegularExpressionSearchOption), true), 2);
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("th\\w+"), Qt::CaseInsensitive, Okular::RegularExpressionSearchOption), false), 2);
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("th\\w+"), Qt::CaseSensitive, Okular::RegularExpressionSearchOption), true), 1);
+  QCOMPARE(countMatches(tp, Okular::SearchPattern(QStringLiteral("x*"), Qt::CaseSensitive, Okular::RegularExpressionSearchOption), true), 0);
+  QVERIFY(!Okular::SearchPattern(QStringLiteral("("), Qt::CaseSensitive, Okular::RegularExpressionSearchOption).isValid());
+
+  delete page;
+}
+
 QTEST_MAIN( SearchTest )
 #include "searchtest.moc"
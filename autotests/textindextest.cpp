@@ -0,0 +1,77 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include "../core/textindex_p.h"
+
+class TextIndexTest : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void testWords();
+        void testHyphenatedWords();
+        void testCandidatePages();
+        void testNotReady();
+};
+
+void TextIndexTest::testWords()
+{
+    QCOMPARE( Okular::TextIndex::words( QStringLiteral( "Hello, World!\nfoo-bar 42" ) ),
+              QStringList() << QStringLiteral( "hello" ) << QStringLiteral( "world" ) << QStringLiteral( "foo" )
+                            << QStringLiteral( "bar" ) << QStringLiteral( "42" ) );
+    QVERIFY( Okular::TextIndex::words( QStringLiteral( " -- ... " ) ).isEmpty() );
+}
+
+void TextIndexTest::testHyphenatedWords()
+{
+    const QString text = QStringLiteral( "an exam-\nple" );
+    QCOMPARE( Okular::TextIndex::words( text ),
+              QStringList() << QStringLiteral( "an" ) << QStringLiteral( "exam" ) << QStringLiteral( "ple" ) );
+    QCOMPARE( Okular::TextIndex::words( text, true ),
+              QStringList() << QStringLiteral( "an" ) << QStringLiteral( "exam" ) << QStringLiteral( "ple" ) << QStringLiteral( "example" ) );
+}
+
+void TextIndexTest::testCandidatePages()
+{
+    Okular::TextIndex index;
+    index.setPageTexts( QStringList() << QStringLiteral( "The quick brown fox" )
+                                      << QStringLiteral( "jumps over the lazy dog" )
+                                      << QStringLiteral( "an exam-\nple of hyphenation" ) );
+    QVERIFY( index.isReady() );
+
+    QCOMPARE( index.candidatePages( QStringLiteral( "fox" ) ), QVector< bool >() << true << false << false );
+    QCOMPARE( index.candidatePages( QStringLiteral( "THE" ) ), QVector< bool >() << true << true << false );
+    // all the words have to be on the page, possibly inside longer ones
+    QCOMPARE( index.candidatePages( QStringLiteral( "lazy do" ) ), QVector< bool >() << false << true << false );
+    QCOMPARE( index.candidatePages( QStringLiteral( "quick dog" ) ), QVector< bool >() << false << false << false );
+    QCOMPARE( index.candidatePages( QStringLiteral( "example" ) ), QVector< bool >() << false << false << true );
+    QCOMPARE( index.candidatePages( QStringLiteral( "xample" ) ), QVector< bool >() << false << false << true );
+    // too short to narrow the search down
+    QCOMPARE( index.candidatePages( QStringLiteral( "he" ) ), QVector< bool >() << true << true << true );
+    // the query is normalized like the text of the pages: fullwidth "fox"
+    QCOMPARE( index.candidatePages( QString::fromUtf8( "\xef\xbd\x86\xef\xbd\x8f\xef\xbd\x98" ) ), QVector< bool >() << true << false << false );
+    // no words, no way to tell
+    QVERIFY( index.candidatePages( QStringLiteral( "--" ) ).isEmpty() );
+}
+
+void TextIndexTest::testNotReady()
+{
+    Okular::TextIndex index;
+    QVERIFY( !index.isReady() );
+    QVERIFY( index.candidatePages( QStringLiteral( "fox" ) ).isEmpty() );
+
+    index.setPageTexts( QStringList() << QStringLiteral( "fox" ) );
+    index.close();
+    QVERIFY( !index.isReady() );
+}
+
+QTEST_MAIN( TextIndexTest )
+#include "textindextest.moc"
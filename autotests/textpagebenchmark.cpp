@@ -0,0 +1,262 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include <QtTest>
+
+#include <cstring>
+
+#include "../core/area.h"
+#include "../core/page.h"
+#include "../core/textpage.h"
+#include "../core/textpage_p.h"
+#include "../settings_core.h"
+
+// A dense page: 80 lines of 100 glyphs, a glyph per character as the pdf
+// generator makes them, with a space between words of five letters.
+static const int lineCount = 80;
+static const int glyphsPerLine = 100;
+
+static Okular::TextPage *createTextPage()
+{
+    Okular::TextPage *tp = new Okular::TextPage();
+    const double glyphWidth = 1.0 / glyphsPerLine;
+    const double lineHeight = 1.0 / lineCount;
+    for ( int line = 0; line < lineCount; ++line )
+    {
+        for ( int i = 0; i < glyphsPerLine; ++i )
+        {
+            const QString text = i % 6 == 5 ? QStringLiteral( " " ) : QString( QChar( 'a' + ( line * 7 + i ) % 26 ) );
+            const double left = i * glyphWidth;
+            const double top = line * lineHeight;
+            tp->append( text, new Okular::NormalizedRect( left, top, left + glyphWidth, top + lineHeight * 0.8 ) );
+        }
+    }
+    return tp;
+}
+
+// The words as TextPage kept them before TextWords, to compare with: a list
+// of heap allocated entities, the texts longer than a pointer in a heap
+// block of their own.
+
+class OldTextEntity
+{
+    static const int MaxStaticChars = sizeof( QChar * ) / sizeof( QChar );
+
+    public:
+        OldTextEntity( const QString &text, const Okular::NormalizedRect &rect )
+            : area( rect ), length( text.length() )
+        {
+            if ( length <= MaxStaticChars )
+                std::memcpy( d.qc, text.constData(), length * sizeof( QChar ) );
+            else
+            {
+                d.data = new QChar[ length ];
+                std::memcpy( d.data, text.constData(), length * sizeof( QChar ) );
+            }
+        }
+
+        ~OldTextEntity()
+        {
+            if ( length > MaxStaticChars )
+                delete [] d.data;
+        }
+
+        QString text() const
+        {
+            return length <= MaxStaticChars ? QString::fromRawData( ( const QChar * )&d.qc[0], length )
+                                            : QString::fromRawData( d.data, length );
+        }
+
+        // the heap memory of the entity and its text
+        qulonglong memory() const
+        {
+            return sizeof( OldTextEntity ) + ( length > MaxStaticChars ? length * sizeof( QChar ) : 0 );
+        }
+
+        Okular::NormalizedRect area;
+
+    private:
+        Q_DISABLE_COPY( OldTextEntity )
+
+        union
+        {
+            QChar *data;
+            ushort qc[MaxStaticChars];
+        } d;
+        int length;
+};
+
+typedef QList< OldTextEntity * > OldTextList;
+
+// the words of the laid out @p textPage, as they were kept
+static OldTextList createOldTextList( const Okular::TextPage *textPage )
+{
+    OldTextList words;
+    const Okular::TextEntity::List entities = textPage->words( nullptr, Okular::TextPage::AnyPixelTextAreaInclusionBehaviour );
+    foreach ( const Okular::TextEntity *entity, entities )
+        words.append( new OldTextEntity( entity->text(), *entity->area() ) );
+    qDeleteAll( entities );
+    return words;
+}
+
+// The search before the search buffer: the query is compared word by word
+// from each word on, and the areas of the words of a match are gathered.
+static int oldFindAll( const OldTextList &words, const QString &query )
+{
+    int matches = 0;
+    for ( int start = 0; start < words.count(); ++start )
+    {
+        Okular::RegularAreaRect area;
+        int matched = 0;
+        for ( int i = start; i < words.count() && matched < query.length(); ++i )
+        {
+            const QString text = words.at( i )->text();
+            const int length = qMin( text.length(), query.length() - matched );
+            if ( text.leftRef( length ).compare( query.midRef( matched, length ), Qt::CaseInsensitive ) != 0 )
+                break;
+            area.appendShape( words.at( i )->area );
+            matched += length;
+        }
+        if ( matched == query.length() )
+            ++matches;
+    }
+    return matches;
+}
+
+class TextPageBenchmark : public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void initTestCase();
+        void init();
+        void cleanup();
+        void benchmarkBuild();
+        void benchmarkLayout();
+        void benchmarkFindAll();
+        void benchmarkFindAllOld();
+        void benchmarkMemory_data();
+        void benchmarkMemory();
+        void benchmarkText();
+        void benchmarkWords();
+
+    private:
+        Okular::Page *m_page;
+        Okular::TextPage *m_textPage;
+};
+
+void TextPageBenchmark::initTestCase()
+{
+    Okular::SettingsCore::instance( QStringLiteral("textpagebenchmark") );
+}
+
+void TextPageBenchmark::init()
+{
+    m_page = new Okular::Page( 0, 1000, 1000, Okular::Rotation0 );
+    m_textPage = createTextPage();
+    m_page->setTextPage( m_textPage );
+}
+
+void TextPageBenchmark::cleanup()
+{
+    // deletes the text page too
+    delete m_page;
+}
+
+void TextPageBenchmark::benchmarkBuild()
+{
+    QBENCHMARK {
+        delete createTextPage();
+    }
+}
+
+void TextPageBenchmark::benchmarkLayout()
+{
+    QBENCHMARK {
+        Okular::Page page( 0, 1000, 1000, Okular::Rotation0 );
+        page.setTextPage( createTextPage() );
+    }
+}
+
+void TextPageBenchmark::benchmarkFindAll()
+{
+    int matches = 0;
+    QBENCHMARK {
+        matches = 0;
+        Okular::RegularAreaRect *match = m_textPage->findText( 0, QStringLiteral( "bc" ), Okular::FromTop, Qt::CaseInsensitive );
+        while ( match )
+        {
+            ++matches;
+            Okular::RegularAreaRect *next = m_textPage->findText( 0, QStringLiteral( "bc" ), Okular::NextResult, Qt::CaseInsensitive, match );
+            delete match;
+            match = next;
+        }
+    }
+    QVERIFY( matches > 0 );
+}
+
+void TextPageBenchmark::benchmarkFindAllOld()
+{
+    const OldTextList words = createOldTextList( m_textPage );
+    int matches = 0;
+    QBENCHMARK {
+        matches = oldFindAll( words, QStringLiteral( "bc" ) );
+    }
+    QVERIFY( matches > 0 );
+    qDeleteAll( words );
+}
+
+void TextPageBenchmark::benchmarkMemory_data()
+{
+    QTest::addColumn< bool >( "old" );
+
+    QTest::newRow( "old" ) << true;
+    QTest::newRow( "new" ) << false;
+}
+
+void TextPageBenchmark::benchmarkMemory()
+{
+    QFETCH( bool, old );
+
+    // the memory of the words of the page once laid out, without the
+    // allocator overhead of the many blocks of the old layout
+    qulonglong bytes = 0;
+    if ( old )
+    {
+        const OldTextList words = createOldTextList( m_textPage );
+        bytes = words.count() * sizeof( void * );
+        foreach ( const OldTextEntity *word, words )
+            bytes += word->memory();
+        qDeleteAll( words );
+    }
+    else
+        bytes = Okular::TextPagePrivate::get( m_textPage )->memory();
+
+    QVERIFY( bytes > 0 );
+    QTest::setBenchmarkResult( bytes, QTest::BytesAllocated );
+}
+
+void TextPageBenchmark::benchmarkText()
+{
+    QString text;
+    QBENCHMARK {
+        text = m_textPage->text();
+    }
+    QVERIFY( text.length() >= lineCount * glyphsPerLine );
+}
+
+void TextPageBenchmark::benchmarkWords()
+{
+    QBENCHMARK {
+        qDeleteAll( m_textPage->words( nullptr, Okular::TextPage::AnyPixelTextAreaInclusionBehaviour ) );
+    }
+}
+
+QTEST_MAIN( TextPageBenchmark )
+#include "textpagebenchmark.moc"
@@ -53,6 +53,7 @@ DlgPresentation::DlgPresentation( QWidget * parent )
     }
     
     m_dlg->kcfg_SlidesAdvanceTime->setSuffix(ki18ncp("Advance every %1 seconds", " second", " seconds"));
+    m_dlg->kcfg_SlidesLookAhead->setSuffix(ki18ncp("Render ahead %1 slides", " slide", " slides"));
 
     connect(m_dlg->screenCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::activated), this, &DlgPresentation::screenComboChanged);
 }
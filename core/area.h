@@ -475,6 +475,7 @@ class OKULARCORE_EXPORT AnnotationObjectRect : public ObjectRect
 class OKULARCORE_EXPORT SourceRefObjectRect : public ObjectRect
 {
     friend class ObjectRect;
+    friend class ObjectRectIndex;
 
     public:
         /**
@@ -0,0 +1,243 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "compressedpixmapcache_p.h"
+
+#include <climits>
+#include <cstring>
+
+#include <threadweaver/job.h>
+#include <threadweaver/qobjectdecorator.h>
+#include <threadweaver/queueing.h>
+
+#include "generator.h"
+
+using namespace Okular;
+
+namespace {
+
+/* Each scanline is XORed with the previous one before deflating it: the
+ * large uniform areas of scanned and text pages become runs of zeros.
+ */
+class PixmapCodecJobInternal : public ThreadWeaver::Job
+{
+    public:
+        explicit PixmapCodecJobInternal( const QImage &image )
+            : mImage( image )
+        {
+            mCompressed.width = 0;
+            mCompressed.height = 0;
+            mCompressed.bytesPerLine = 0;
+            mCompressed.format = QImage::Format_Invalid;
+            mCompressed.rotation = Rotation0;
+        }
+
+        explicit PixmapCodecJobInternal( const CompressedPixmap &compressed )
+            : mCompressed( compressed )
+        {
+        }
+
+        QImage image() const { return mImage; }
+        CompressedPixmap compressed() const { return mCompressed; }
+
+        // decompressions are waited for, compressions are not
+        int priority() const override { return mImage.isNull() ? 1 : 0; }
+
+    protected:
+        void run( ThreadWeaver::JobPointer, ThreadWeaver::Thread * ) override
+        {
+            if ( mImage.isNull() )
+                decompress();
+            else
+                compress();
+        }
+
+    private:
+        void compress()
+        {
+            const int bytesPerLine = mImage.bytesPerLine();
+            const int height = mImage.height();
+            QByteArray raw( reinterpret_cast< const char * >( mImage.constBits() ), bytesPerLine * height );
+            char *data = raw.data();
+            for ( int y = height - 1; y > 0; --y )
+            {
+                char *line = data + y * bytesPerLine;
+                const char *previousLine = line - bytesPerLine;
+                for ( int x = 0; x < bytesPerLine; ++x )
+                    line[x] ^= previousLine[x];
+            }
+
+            mCompressed.data = qCompress( raw, 1 );
+            mCompressed.width = mImage.width();
+            mCompressed.height = height;
+            mCompressed.bytesPerLine = bytesPerLine;
+            mCompressed.format = mImage.format();
+        }
+
+        void decompress()
+        {
+            const QByteArray raw = qUncompress( mCompressed.data );
+            if ( raw.size() != mCompressed.bytesPerLine * mCompressed.height )
+                return;
+
+            QImage image( mCompressed.width, mCompressed.height, mCompressed.format );
+            if ( image.isNull() || image.bytesPerLine() != mCompressed.bytesPerLine )
+                return;
+
+            const int bytesPerLine = mCompressed.bytesPerLine;
+            const uchar *source = reinterpret_cast< const uchar * >( raw.constData() );
+            for ( int y = 0; y < mCompressed.height; ++y )
+            {
+                uchar *line = image.scanLine( y );
+                const uchar *sourceLine = source + y * bytesPerLine;
+                if ( y == 0 )
+                {
+                    memcpy( line, sourceLine, bytesPerLine );
+                    continue;
+                }
+                const uchar *previousLine = image.constScanLine( y - 1 );
+                for ( int x = 0; x < bytesPerLine; ++x )
+                    line[x] = sourceLine[x] ^ previousLine[x];
+            }
+            mImage = image;
+        }
+
+        QImage mImage;
+        CompressedPixmap mCompressed;
+};
+
+class PixmapCodecJob : public ThreadWeaver::QObjectDecorator
+{
+    public:
+        PixmapCodecJob( PixmapCodecJobInternal *job, int generation )
+            : ThreadWeaver::QObjectDecorator( job ), mObserver( nullptr ), mPage( -1 ),
+              mRequest( nullptr ), mRotation( Rotation0 ), mGeneration( generation )
+        {
+        }
+
+        const PixmapCodecJobInternal *internal() const { return static_cast< const PixmapCodecJobInternal * >( job() ); }
+
+        DocumentObserver *mObserver;
+        int mPage;
+        PixmapRequest *mRequest;
+        Rotation mRotation;
+        int mGeneration;
+};
+
+}
+
+CompressedPixmapCache::CompressedPixmapCache()
+    : QObject(), m_generation( 0 )
+{
+    m_weaver.setMaximumNumberOfThreads( 1 );
+    m_cache.setMaxCost( 0 );
+}
+
+CompressedPixmapCache::~CompressedPixmapCache()
+{
+    m_weaver.dequeue();
+    m_weaver.finish();
+}
+
+void CompressedPixmapCache::setMaxBytes( qulonglong bytes )
+{
+    // the cost of the entries is in KiB, QCache works with ints
+    m_cache.setMaxCost( (int)qMin( bytes / 1024, (qulonglong)INT_MAX ) );
+}
+
+qulonglong CompressedPixmapCache::bytes() const
+{
+    return (qulonglong)m_cache.totalCost() * 1024;
+}
+
+void CompressedPixmapCache::store( DocumentObserver *observer, int page, const QImage &image, Rotation rotation )
+{
+    if ( m_cache.maxCost() <= 0 || image.isNull() )
+        return;
+
+    m_cache.remove( Key( observer, page ) );
+
+    PixmapCodecJob *job = new PixmapCodecJob( new PixmapCodecJobInternal( image ), m_generation );
+    job->mObserver = observer;
+    job->mPage = page;
+    job->mRotation = rotation;
+    connect( job, SIGNAL(done(ThreadWeaver::JobPointer)),
+             this, SLOT(jobDone(ThreadWeaver::JobPointer)) );
+    ThreadWeaver::enqueue( &m_weaver, job );
+}
+
+bool CompressedPixmapCache::retrieve( PixmapRequest *request, Rotation rotation )
+{
+    const Key key( request->observer(), request->pageNumber() );
+    const CompressedPixmap *compressed = m_cache.object( key );
+    if ( !compressed )
+        return false;
+
+    if ( compressed->width != request->width() || compressed->height != request->height() || compressed->rotation != rotation )
+    {
+        // the page is shown differently now, the entry is of no use
+        m_cache.remove( key );
+        return false;
+    }
+
+    PixmapCodecJob *job = new PixmapCodecJob( new PixmapCodecJobInternal( *compressed ), m_generation );
+    job->mRequest = request;
+    job->mRotation = compressed->rotation;
+    m_cache.remove( key );
+    connect( job, SIGNAL(done(ThreadWeaver::JobPointer)),
+             this, SLOT(jobDone(ThreadWeaver::JobPointer)) );
+    ThreadWeaver::enqueue( &m_weaver, job );
+    return true;
+}
+
+void CompressedPixmapCache::removePage( int page )
+{
+    ++m_generation;
+    foreach ( const Key &key, m_cache.keys() )
+        if ( key.second == page )
+            m_cache.remove( key );
+}
+
+void CompressedPixmapCache::removeObserver( DocumentObserver *observer )
+{
+    ++m_generation;
+    foreach ( const Key &key, m_cache.keys() )
+        if ( key.first == observer )
+            m_cache.remove( key );
+}
+
+void CompressedPixmapCache::clear()
+{
+    // compressions still running belong to the previous contents
+    ++m_generation;
+    m_cache.clear();
+}
+
+void CompressedPixmapCache::jobDone( const ThreadWeaver::JobPointer &j )
+{
+    const PixmapCodecJob *job = static_cast< const PixmapCodecJob * >( j.data() );
+
+    if ( job->mRequest )
+    {
+        // the request is waiting for its pixmap whatever happened meanwhile
+        emit retrieved( job->mRequest, job->internal()->image(), job->mRotation );
+        return;
+    }
+
+    if ( job->mGeneration != m_generation || m_cache.maxCost() <= 0 )
+        return;
+
+    CompressedPixmap *compressed = new CompressedPixmap( job->internal()->compressed() );
+    compressed->rotation = job->mRotation;
+    const int cost = qMax( compressed->data.size() / 1024, 1 );
+    // QCache deletes the entry if it does not fit
+    m_cache.insert( Key( job->mObserver, job->mPage ), compressed, cost );
+}
+
+#include "moc_compressedpixmapcache_p.cpp"
@@ -0,0 +1,106 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_COMPRESSEDPIXMAPCACHE_P_H_
+#define _OKULAR_COMPRESSEDPIXMAPCACHE_P_H_
+
+#include <QtCore/QByteArray>
+#include <QtCore/QCache>
+#include <QtCore/QObject>
+#include <QtCore/QPair>
+#include <QtGui/QImage>
+
+#include <threadweaver/queue.h>
+
+#include "global.h"
+
+namespace Okular {
+
+class DocumentObserver;
+class PixmapRequest;
+
+struct CompressedPixmap
+{
+    QByteArray data;
+    int width;
+    int height;
+    int bytesPerLine;
+    QImage::Format format;
+    Rotation rotation;
+};
+
+/**
+ * @short The second tier of the pixmap cache.
+ *
+ * When a whole page pixmap is evicted, its image is compressed losslessly
+ * in a background thread and kept here, under its own byte budget. A later
+ * request for the same observer, page, size and rotation is served by
+ * decompressing it in a background thread, which is much cheaper than
+ * asking the generator to render the page again.
+ *
+ * Entries are handed out once: a retrieved pixmap is resident again, and
+ * goes back to this cache if it gets evicted again.
+ */
+class CompressedPixmapCache : public QObject
+{
+    Q_OBJECT
+
+    public:
+        CompressedPixmapCache();
+        ~CompressedPixmapCache();
+
+        /**
+         * Sets the byte budget of the compressed pixmaps; 0 disables the
+         * cache.
+         */
+        void setMaxBytes( qulonglong bytes );
+
+        /**
+         * Returns the memory the compressed pixmaps use.
+         */
+        qulonglong bytes() const;
+
+        /**
+         * Compresses @p image, the pixmap @p observer had for @p page, and
+         * keeps it if there is room for it.
+         */
+        void store( DocumentObserver *observer, int page, const QImage &image, Rotation rotation );
+
+        /**
+         * Starts decompressing the pixmap matching @p request, and returns
+         * whether there was one. retrieved() is emitted once done.
+         */
+        bool retrieve( PixmapRequest *request, Rotation rotation );
+
+        void removePage( int page );
+        void removeObserver( DocumentObserver *observer );
+        void clear();
+
+    Q_SIGNALS:
+        /**
+         * The pixmap for @p request was decompressed. @p image is null if
+         * decompression failed, @p rotation is the one the page had when
+         * the pixmap was stored.
+         */
+        void retrieved( Okular::PixmapRequest *request, const QImage &image, Okular::Rotation rotation );
+
+    private Q_SLOTS:
+        void jobDone( const ThreadWeaver::JobPointer &job );
+
+    private:
+        typedef QPair< DocumentObserver *, int > Key;
+
+        ThreadWeaver::Queue m_weaver;
+        QCache< Key, CompressedPixmap > m_cache;
+        int m_generation;
+};
+
+}
+
+#endif
@@ -0,0 +1,404 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "diskrendercache_p.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QVector>
+#include <QtGui/QTransform>
+
+#include <threadweaver/job.h>
+#include <threadweaver/qobjectdecorator.h>
+#include <threadweaver/queueing.h>
+
+#include "generator.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Okular;
+
+namespace {
+
+struct RenderFileHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 format;
+};
+
+static const char renderFileMagic[4] = { 'O', 'K', 'R', 'C' };
+static const quint32 renderFileVersion = 1;
+
+QString fileSuffix( DiskRenderCache::Storage storage )
+{
+    return storage == DiskRenderCache::Compressed ? QStringLiteral( ".png" ) : QStringLiteral( ".raw" );
+}
+
+/* Removes the least recently used renders until the cache is back to
+ * 90% of its cap, once the cache looks over it.
+ */
+void trimCache( const QString &root, const QString &suffix, qulonglong maxBytes, DiskRenderCacheUsage *usage )
+{
+    if ( usage->known && usage->bytes <= maxBytes )
+        return;
+
+    struct Entry
+    {
+        qint64 time;
+        qint64 size;
+        QString path;
+    };
+
+    QVector< Entry > entries;
+    qulonglong totalBytes = 0;
+    QDirIterator it( root, QStringList() << QStringLiteral( "*" ) + suffix, QDir::Files, QDirIterator::Subdirectories );
+    while ( it.hasNext() )
+    {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        Entry entry;
+        entry.time = qMax( info.lastRead(), info.lastModified() ).toMSecsSinceEpoch();
+        entry.size = info.size();
+        entry.path = info.filePath();
+        entries.append( entry );
+        totalBytes += entry.size;
+    }
+    usage->bytes = totalBytes;
+    usage->known = true;
+    if ( totalBytes <= maxBytes )
+        return;
+
+    std::sort( entries.begin(), entries.end(), []( const Entry &e1, const Entry &e2 ) { return e1.time < e2.time; } );
+    const qulonglong targetBytes = maxBytes / 10 * 9;
+    foreach ( const Entry &entry, entries )
+    {
+        if ( totalBytes <= targetBytes )
+            break;
+        if ( QFile::remove( entry.path ) )
+            totalBytes -= entry.size;
+    }
+    usage->bytes = totalBytes;
+}
+
+void removeFiles( const QDir &dir, const QStringList &entries, DiskRenderCacheUsage *usage )
+{
+    foreach ( const QString &entry, entries )
+    {
+        const qint64 size = QFileInfo( dir, entry ).size();
+        if ( dir.remove( entry ) )
+            usage->bytes -= qMin( (qulonglong)size, usage->bytes );
+    }
+}
+
+class DiskRenderCacheJob : public ThreadWeaver::Job
+{
+    public:
+        enum Kind { Write, RemovePage, RemoveAll };
+
+        DiskRenderCacheJob( Kind kind, DiskRenderCache::Storage storage, const QString &directory, DiskRenderCacheUsage *usage )
+            : mKind( kind ), mStorage( storage ), mDirectory( directory ), mUsage( usage ), mPage( -1 ), mMaxBytes( 0 )
+        {
+        }
+
+        Kind mKind;
+        DiskRenderCache::Storage mStorage;
+        QString mDirectory;
+        DiskRenderCacheUsage *mUsage;
+        QString mFileName;
+        QImage mImage;
+        int mPage;
+        QString mRoot;
+        qulonglong mMaxBytes;
+
+    protected:
+        void run( ThreadWeaver::JobPointer, ThreadWeaver::Thread * ) override
+        {
+            switch ( mKind )
+            {
+                case Write:
+                    if ( write() )
+                    {
+                        mUsage->bytes += QFileInfo( mFileName ).size();
+                        trimCache( mRoot, fileSuffix( mStorage ), mMaxBytes, mUsage );
+                    }
+                    break;
+                case RemovePage:
+                {
+                    const QDir dir( mDirectory );
+                    removeFiles( dir, dir.entryList( QStringList() << QStringLiteral( "%1-*" ).arg( mPage ) + fileSuffix( mStorage ), QDir::Files ), mUsage );
+                }
+                break;
+                case RemoveAll:
+                {
+                    QDir dir( mDirectory );
+                    removeFiles( dir, dir.entryList( QDir::Files ), mUsage );
+                    dir.removeRecursively();
+                }
+                break;
+            }
+        }
+
+    private:
+        bool write()
+        {
+            if ( !QDir().mkpath( mDirectory ) )
+                return false;
+
+            QSaveFile file( mFileName );
+            if ( !file.open( QIODevice::WriteOnly ) )
+                return false;
+
+            if ( mStorage == DiskRenderCache::Compressed )
+            {
+                // the renders stored this way are small, favour speed over size
+                if ( !mImage.save( &file, "PNG", 80 ) )
+                {
+                    file.cancelWriting();
+                    return false;
+                }
+                return file.commit();
+            }
+
+            RenderFileHeader header;
+            memcpy( header.magic, renderFileMagic, sizeof( header.magic ) );
+            header.version = renderFileVersion;
+            header.width = mImage.width();
+            header.height = mImage.height();
+            header.bytesPerLine = mImage.bytesPerLine();
+            header.format = mImage.format();
+
+            file.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+            file.write( reinterpret_cast< const char * >( mImage.constBits() ), (qint64)mImage.bytesPerLine() * mImage.height() );
+            return file.commit();
+        }
+};
+
+class DiskRenderLoadJobInternal : public ThreadWeaver::Job
+{
+    public:
+        DiskRenderLoadJobInternal( const DiskRenderCache *cache, const QString &fileName, int width, int height, Rotation rotation )
+            : mCache( cache ), mFileName( fileName ), mWidth( width ), mHeight( height ), mRotation( rotation )
+        {
+        }
+
+        QImage image() const { return mImage; }
+        Rotation rotation() const { return mRotation; }
+
+    protected:
+        void run( ThreadWeaver::JobPointer, ThreadWeaver::Thread * ) override
+        {
+            mImage = mCache->loadFile( mFileName, mWidth, mHeight );
+            if ( !mImage.isNull() && mRotation != Rotation0 )
+                mImage = mImage.transformed( QTransform().rotate( 90 * mRotation ) );
+        }
+
+    private:
+        const DiskRenderCache *mCache;
+        const QString mFileName;
+        const int mWidth;
+        const int mHeight;
+        const Rotation mRotation;
+        QImage mImage;
+};
+
+class DiskRenderLoadJob : public ThreadWeaver::QObjectDecorator
+{
+    public:
+        DiskRenderLoadJob( DiskRenderLoadJobInternal *job, PixmapRequest *request, const QString &fileName )
+            : ThreadWeaver::QObjectDecorator( job ), mRequest( request ), mFileName( fileName )
+        {
+        }
+
+        const DiskRenderLoadJobInternal *internal() const { return static_cast< const DiskRenderLoadJobInternal * >( job() ); }
+
+        PixmapRequest *mRequest;
+        QString mFileName;
+};
+
+}
+
+DiskRenderCache::DiskRenderCache( const QString &name, Storage storage )
+    : QObject(), m_name( name ), m_storage( storage ), m_maxBytes( 0 )
+{
+    m_weaver.setMaximumNumberOfThreads( 1 );
+    m_loadWeaver.setMaximumNumberOfThreads( 1 );
+}
+
+DiskRenderCache::~DiskRenderCache()
+{
+    m_loadWeaver.dequeue();
+    m_loadWeaver.finish();
+    // pending writes are worth finishing, the next session will use them
+    m_weaver.finish();
+}
+
+QString DiskRenderCache::cacheRoot() const
+{
+    return QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation ) + QStringLiteral( "/okular/" ) + m_name;
+}
+
+void DiskRenderCache::open( const QString &identity, qulonglong maxBytes )
+{
+    m_directory = cacheRoot() + QLatin1Char( '/' ) + identity;
+    m_maxBytes = maxBytes;
+
+    // one listing now spares looking for every render on disk later
+    m_files.clear();
+    foreach ( const QString &entry, QDir( m_directory ).entryList( QStringList() << QStringLiteral( "*" ) + fileSuffix( m_storage ), QDir::Files ) )
+        m_files.insert( m_directory + QLatin1Char( '/' ) + entry );
+}
+
+void DiskRenderCache::close()
+{
+    m_directory.clear();
+    m_files.clear();
+}
+
+bool DiskRenderCache::isOpen() const
+{
+    return !m_directory.isEmpty();
+}
+
+QString DiskRenderCache::fileName( int page, int width, int height, const QString &renderHints ) const
+{
+    const QByteArray hintsDigest = QCryptographicHash::hash( renderHints.toUtf8(), QCryptographicHash::Sha1 ).toHex().left( 12 );
+    return m_directory + QStringLiteral( "/%1-%2x%3-%4" ).arg( page ).arg( width ).arg( height ).arg( QString::fromLatin1( hintsDigest ) )
+           + fileSuffix( m_storage );
+}
+
+bool DiskRenderCache::retrieve( PixmapRequest *request, const QString &renderHints, Rotation rotation )
+{
+    if ( !isOpen() )
+        return false;
+
+    // a quarter turn swaps the size of the unrotated render
+    const bool swapped = (int)rotation % 2;
+    const int width = swapped ? request->height() : request->width();
+    const int height = swapped ? request->width() : request->height();
+    const QString file = fileName( request->pageNumber(), width, height, renderHints );
+    if ( !m_files.contains( file ) )
+        return false;
+
+    DiskRenderLoadJob *job = new DiskRenderLoadJob( new DiskRenderLoadJobInternal( this, file, width, height, rotation ), request, file );
+    connect( job, SIGNAL(done(ThreadWeaver::JobPointer)),
+             this, SLOT(loadDone(ThreadWeaver::JobPointer)) );
+    ThreadWeaver::enqueue( &m_loadWeaver, job );
+    return true;
+}
+
+QImage DiskRenderCache::loadFile( const QString &fileName, int width, int height ) const
+{
+    if ( m_storage == Raw )
+        return loadRaw( fileName, width, height );
+
+    QImage image;
+    if ( !QFile::exists( fileName ) || !image.load( fileName, "PNG" ) || image.width() != width || image.height() != height )
+        return QImage();
+    return image;
+}
+
+QImage DiskRenderCache::loadRaw( const QString &fileName, int width, int height ) const
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return QImage();
+
+    RenderFileHeader header;
+    if ( file.read( reinterpret_cast< char * >( &header ), sizeof( header ) ) != (qint64)sizeof( header )
+         || memcmp( header.magic, renderFileMagic, sizeof( header.magic ) ) != 0 || header.version != renderFileVersion
+         || (int)header.width != width || (int)header.height != height
+         || header.format <= QImage::Format_Invalid || header.format >= QImage::NImageFormats
+         || file.size() != (qint64)sizeof( header ) + (qint64)header.bytesPerLine * header.height )
+        return QImage();
+
+    // read straight into an image the pixmap can be made from as it is
+    QImage image( width, height, (QImage::Format)header.format );
+    if ( image.isNull() || image.bytesPerLine() != (int)header.bytesPerLine )
+        return QImage();
+
+    const qint64 bytes = (qint64)header.bytesPerLine * header.height;
+    if ( file.read( reinterpret_cast< char * >( image.bits() ), bytes ) != bytes )
+        return QImage();
+
+    return image;
+}
+
+void DiskRenderCache::store( int page, const QPixmap &pixmap, const QString &renderHints )
+{
+    if ( !isOpen() || pixmap.isNull() )
+        return;
+
+    // check before paying for the conversion
+    const QString file = fileName( page, pixmap.width(), pixmap.height(), renderHints );
+    if ( m_files.contains( file ) )
+        return;
+
+    m_files.insert( file );
+    DiskRenderCacheJob *job = new DiskRenderCacheJob( DiskRenderCacheJob::Write, m_storage, m_directory, &m_usage );
+    job->mFileName = file;
+    job->mImage = pixmap.toImage();
+    job->mRoot = cacheRoot();
+    job->mMaxBytes = m_maxBytes;
+    m_weaver.enqueue( ThreadWeaver::JobPointer( job ) );
+}
+
+void DiskRenderCache::removePage( int page )
+{
+    if ( !isOpen() )
+        return;
+
+    const QString prefix = m_directory + QStringLiteral( "/%1-" ).arg( page );
+    QSet< QString >::iterator it = m_files.begin();
+    while ( it != m_files.end() )
+    {
+        if ( it->startsWith( prefix ) )
+            it = m_files.erase( it );
+        else
+            ++it;
+    }
+
+    DiskRenderCacheJob *job = new DiskRenderCacheJob( DiskRenderCacheJob::RemovePage, m_storage, m_directory, &m_usage );
+    job->mPage = page;
+    m_weaver.enqueue( ThreadWeaver::JobPointer( job ) );
+}
+
+void DiskRenderCache::clear()
+{
+    if ( !isOpen() )
+        return;
+
+    m_files.clear();
+    m_weaver.enqueue( ThreadWeaver::JobPointer( new DiskRenderCacheJob( DiskRenderCacheJob::RemoveAll, m_storage, m_directory, &m_usage ) ) );
+}
+
+void DiskRenderCache::loadDone( const ThreadWeaver::JobPointer &j )
+{
+    const DiskRenderLoadJob *job = static_cast< const DiskRenderLoadJob * >( j.data() );
+
+    // a render that cannot be loaded is not looked for again
+    const QImage image = job->internal()->image();
+    if ( image.isNull() )
+        m_files.remove( job->mFileName );
+
+    // the request is waiting for its render whatever happened meanwhile
+    emit retrieved( job->mRequest, image, job->internal()->rotation() );
+}
+
+#include "moc_diskrendercache_p.cpp"
@@ -0,0 +1,142 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_DISKRENDERCACHE_P_H_
+#define _OKULAR_DISKRENDERCACHE_P_H_
+
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+
+#include <threadweaver/queue.h>
+
+#include "global.h"
+
+namespace Okular {
+
+class PixmapRequest;
+
+/**
+ * The bytes taken by all the renders of a cache, kept up to date by its
+ * background thread so that not every write has to walk the cache. Other
+ * processes write to the cache too, so it is recounted whenever it looks
+ * over the cap.
+ */
+struct DiskRenderCacheUsage
+{
+    DiskRenderCacheUsage() : bytes( 0 ), known( false ) {}
+
+    qulonglong bytes;
+    bool known;
+};
+
+/**
+ * @short Rendered pages kept on disk across sessions.
+ *
+ * The renders of a document live in their own directory of the okular
+ * cache directory, named after an identity that changes whenever the
+ * document file changes. Each render is keyed by page, size and a digest
+ * of the render hints. It is stored uncompressed, so that loading it is a
+ * plain read, or as PNG for small renders kept in large numbers, like
+ * thumbnails.
+ *
+ * Writes, removals and the trimming of the whole cache to its byte cap
+ * (least recently used renders first) happen in order in a background
+ * thread, and so do loads, in a thread of their own.
+ */
+class DiskRenderCache : public QObject
+{
+    Q_OBJECT
+
+    public:
+        enum Storage
+        {
+            Raw,        ///< Uncompressed, read as it is on load
+            Compressed  ///< PNG compressed
+        };
+
+        /**
+         * Creates a cache keeping its renders in the @p name directory of
+         * the okular cache directory.
+         */
+        explicit DiskRenderCache( const QString &name = QStringLiteral( "renders" ), Storage storage = Raw );
+        ~DiskRenderCache();
+
+        /**
+         * Returns the directory holding the renders of all the documents.
+         */
+        QString cacheRoot() const;
+
+        /**
+         * Starts caching the renders of the document with @p identity, with
+         * a cap of @p maxBytes for the whole cache.
+         */
+        void open( const QString &identity, qulonglong maxBytes );
+        void close();
+        bool isOpen() const;
+
+        /**
+         * Starts loading the render matching @p request and @p renderHints,
+         * and returns whether there was one. retrieved() is emitted once
+         * done. The renders are kept unrotated: for a request of a page
+         * shown with @p rotation, the unrotated render is looked for and
+         * rotated once loaded.
+         */
+        bool retrieve( PixmapRequest *request, const QString &renderHints, Rotation rotation = Rotation0 );
+
+        /**
+         * Returns the file of the render of @p page at the given size with
+         * the given @p renderHints, and loads it. Unlike the other methods,
+         * loadFile() can be called from any thread.
+         */
+        QString fileName( int page, int width, int height, const QString &renderHints ) const;
+        QImage loadFile( const QString &fileName, int width, int height ) const;
+
+        /**
+         * Stores the render @p pixmap of @p page unless it is already there.
+         */
+        void store( int page, const QPixmap &pixmap, const QString &renderHints );
+
+        /**
+         * Forgets the renders of @p page, or of all the pages.
+         */
+        void removePage( int page );
+        void clear();
+
+    Q_SIGNALS:
+        /**
+         * The render for @p request was loaded, and rotated by @p rotation.
+         * @p image is null if it could not be, and the request is then to be
+         * rendered.
+         */
+        void retrieved( Okular::PixmapRequest *request, const QImage &image, Okular::Rotation rotation );
+
+    private Q_SLOTS:
+        void loadDone( const ThreadWeaver::JobPointer &job );
+
+    private:
+        QImage loadRaw( const QString &fileName, int width, int height ) const;
+
+        ThreadWeaver::Queue m_weaver;
+        ThreadWeaver::Queue m_loadWeaver;
+        const QString m_name;
+        const Storage m_storage;
+        QString m_directory;
+        qulonglong m_maxBytes;
+        // the renders of the document, as far as this session knows
+        QSet< QString > m_files;
+        // only touched by the jobs of m_weaver
+        DiskRenderCacheUsage m_usage;
+};
+
+}
+
+#endif
@@ -24,7 +24,11 @@
 
 // qt/kde/system includes
 #include <QtCore/QtAlgorithms>
+#include <QtCore/QBitArray>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QMap>
@@ -69,8 +73,11 @@
 #include "generator_p.h"
 #include "interfaces/configinterface.h"
 #include "interfaces/guiinterface.h"
+#include "interfaces/pagedatainterface.h"
 #include "interfaces/printinterface.h"
+#include "interfaces/reloadinterface.h"
 #include "interfaces/saveinterface.h"
+#include "interfaces/thumbnailinterface.h"
 #include "observer.h"
 #include "misc.h"
 #include "page.h"
@@ -89,22 +96,13 @@
 #include "form.h"
 #include "utils.h"
 
+#include <algorithm>
 #include <memory>
 
 #include <config-okular.h>
 
 using namespace Okular;
 
-struct AllocatedPixmap
-{
-    // owner of the page
-    DocumentObserver *observer;
-    int page;
-    qulonglong memory;
-    // public constructor: initialize data
-    AllocatedPixmap( DocumentObserver *o, int p, qulonglong m ) : observer( o ), page( p ), memory( m ) {}
-};
-
 struct ArchiveData
 {
     ArchiveData()
@@ -126,10 +124,24 @@ struct RunningSearch
     QString cachedString;
     Document::SearchType cachedType;
     Qt::CaseSensitivity cachedCaseSensitivity;
+    SearchOptions cachedOptions;
     bool cachedViewportMove : 1;
     bool isCurrentlySearching : 1;
     QColor cachedColor;
     int pagesDone;
+
+    // pages that may match according to the text index, empty if unknown
+    QVector< bool > candidatePages;
+    // what next and previous match searches look for
+    SearchPattern pattern;
+
+    // fields related to whole document searches
+    QVector< SearchTerm > terms;
+    bool matchAll : 1;
+    bool matchFound : 1;
+    QList< Page * > pagesToSearch;
+    int pagesPending;
+    int documentSearchRun;
 };
 
 #define foreachObserver( cmd ) {\
@@ -247,6 +259,19 @@ qulonglong DocumentPrivate::calculateMemoryToFree()
     if ( clipValue > memoryToFree )
         memoryToFree = clipValue;
 
+    // [MEM] whatever the profile, stay within the cgroup limit and give
+    // memory back when the system stalls on it; the text pages count in
+    // the budget too, and give back their share
+    m_memoryBudget.update( m_allocatedPixmapsTotalMemory + m_allocatedTextPagesTotalMemory );
+    const qulonglong usedMemory = m_allocatedPixmapsTotalMemory + m_allocatedTextPagesTotalMemory;
+    const qulonglong budget = m_memoryBudget.pixmapBudget( usedMemory );
+    if ( usedMemory > budget )
+    {
+        const qulonglong pixmapBudget = (qulonglong)( (double)budget * m_allocatedPixmapsTotalMemory / usedMemory );
+        if ( m_allocatedPixmapsTotalMemory - pixmapBudget > memoryToFree )
+            memoryToFree = m_allocatedPixmapsTotalMemory - pixmapBudget;
+    }
+
     return memoryToFree;
 }
 
@@ -255,13 +280,117 @@ void DocumentPrivate::cleanupPixmapMemory()
     cleanupPixmapMemory( calculateMemoryToFree() );
 }
 
+qulonglong DocumentPrivate::calculateTextPageMemoryToFree()
+{
+    // [MEM] the text pages get a share of the memory depending on the profile
+    const qulonglong totalMemory = getTotalMemory();
+    qulonglong limit = 0;
+    switch ( SettingsCore::memoryLevel() )
+    {
+        case SettingsCore::EnumMemoryLevel::Low:
+            limit = totalMemory / 64;
+            break;
+
+        case SettingsCore::EnumMemoryLevel::Normal:
+            limit = totalMemory / 16;
+            break;
+
+        case SettingsCore::EnumMemoryLevel::Aggressive:
+            limit = totalMemory / 8;
+            break;
+
+        case SettingsCore::EnumMemoryLevel::Greedy:
+            limit = totalMemory / 4;
+            break;
+    }
+
+    // [MEM] and their share of the memory budget, as the pixmaps
+    m_memoryBudget.update( m_allocatedPixmapsTotalMemory + m_allocatedTextPagesTotalMemory );
+    const qulonglong usedMemory = m_allocatedPixmapsTotalMemory + m_allocatedTextPagesTotalMemory;
+    const qulonglong budget = m_memoryBudget.pixmapBudget( usedMemory );
+    if ( usedMemory > budget )
+        limit = qMin( limit, (qulonglong)( (double)budget * m_allocatedTextPagesTotalMemory / usedMemory ) );
+
+    return m_allocatedTextPagesTotalMemory > limit ? m_allocatedTextPagesTotalMemory - limit : 0;
+}
+
+void DocumentPrivate::updateTextPageMemory()
+{
+    // searching builds buffers in the text pages, so the sizes grow
+    // after the text pages are generated: take them again
+    m_allocatedTextPagesTotalMemory = 0;
+    QHash< int, qulonglong >::iterator it = m_allocatedTextPages.begin();
+    while ( it != m_allocatedTextPages.end() )
+    {
+        if ( it.key() >= m_pagesVector.count() || !m_pagesVector.at( it.key() )->hasTextPage() )
+        {
+            it = m_allocatedTextPages.erase( it );
+            continue;
+        }
+        it.value() = m_pagesVector.at( it.key() )->d->textPageMemory();
+        m_allocatedTextPagesTotalMemory += it.value();
+        ++it;
+    }
+}
+
+void DocumentPrivate::cleanupTextPageMemory( int keepPage )
+{
+    qulonglong memoryToFree = calculateTextPageMemoryToFree();
+    int pagesToFree = m_allocatedTextPages.count() - m_maxAllocatedTextPages;
+    if ( memoryToFree == 0 && pagesToFree <= 0 )
+        return;
+
+    // free a tenth more, not to go through all the text pages again for
+    // each one generated next
+    if ( memoryToFree > 0 )
+        memoryToFree += m_allocatedTextPagesTotalMemory / 10;
+    if ( pagesToFree > 0 )
+        pagesToFree += m_maxAllocatedTextPages / 10;
+
+    // Free the text pages farthest from the current one first, keeping the
+    // visible ones: they are used for the selection
+    QSet< int > visiblePages;
+    foreach ( VisiblePageRect *rect, m_pageRects )
+        visiblePages.insert( rect->pageNumber );
+    const int currentViewportPage = (*m_viewportIterator).pageNumber;
+    QList< int > pages = m_allocatedTextPages.keys();
+    std::sort( pages.begin(), pages.end(), [currentViewportPage]( int a, int b ) {
+        return qAbs( a - currentViewportPage ) > qAbs( b - currentViewportPage );
+    } );
+
+    foreach ( int page, pages )
+    {
+        if ( memoryToFree == 0 && pagesToFree <= 0 )
+            break;
+        if ( page == keepPage || visiblePages.contains( page ) )
+            continue;
+
+        const qulonglong memory = m_allocatedTextPages.take( page );
+        qCDebug(OkularCoreDebug).nospace() << "Evicting text page=" << page << " memory=" << memory;
+        if ( page < m_pagesVector.count() )
+            m_pagesVector.at( page )->d->evictTextPage();
+        m_allocatedTextPagesTotalMemory -= memory;
+        memoryToFree = memory > memoryToFree ? 0 : memoryToFree - memory;
+        --pagesToFree;
+    }
+}
+
 void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
 {
     if ( memoryToFree < 1 )
         return;
 
+    updatePixmapCachePolicy();
     const int currentViewportPage = (*m_viewportIterator).pageNumber;
 
+    // [MEM] evicted page pixmaps go to the compressed tier, which may use a
+    // sixteenth of the memory available to it, unless memory is to be kept
+    // as low as possible
+    if ( SettingsCore::memoryLevel() == SettingsCore::EnumMemoryLevel::Low )
+        m_compressedPixmaps.setMaxBytes( 0 );
+    else
+        m_compressedPixmaps.setMaxBytes( ( getFreeMemory() + m_compressedPixmaps.bytes() ) / 16 );
+
     // Create a QMap of visible rects, indexed by page number
     QMap< int, VisiblePageRect * > visibleRects;
     QVector< Okular::VisiblePageRect * >::const_iterator vIt = m_pageRects.constBegin(), vEnd = m_pageRects.constEnd();
@@ -270,12 +399,9 @@ void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
 
     // Free memory starting from pages that are farthest from the current one
     int pagesFreed = 0;
-    while ( memoryToFree > 0 )
+    const QList< AllocatedPixmap * > evictedPixmaps = m_allocatedPixmaps.takeFarthest( currentViewportPage, memoryToFree );
+    foreach ( AllocatedPixmap * p, evictedPixmaps )
     {
-        AllocatedPixmap * p = searchLowestPriorityPixmap( true, true );
-        if ( !p ) // No pixmap to remove
-            break;
-
         qCDebug(OkularCoreDebug).nospace() << "Evicting cache pixmap observer=" << p->observer << " page=" << p->page;
 
         // m_allocatedPixmapsTotalMemory can't underflow because we always add or remove
@@ -287,6 +413,14 @@ void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
         else
             memoryToFree -= p->memory;
         pagesFreed++;
+        // keep a compressed copy of whole page pixmaps
+        const Page *page = m_pagesVector.at( p->page );
+        if ( !page->d->tilesManager( p->observer ) )
+        {
+            QMap< DocumentObserver*, PagePrivate::PixmapObject >::const_iterator it = page->d->m_pixmaps.constFind( p->observer );
+            if ( it != page->d->m_pixmaps.constEnd() )
+                m_compressedPixmaps.store( p->observer, p->page, it.value().m_pixmap->toImage(), it.value().m_rotation );
+        }
         // delete pixmap
         m_pagesVector.at( p->page )->deletePixmap( p->observer );
         // delete allocation descriptor
@@ -328,7 +462,10 @@ void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
                 if ( p->memory > 0 )
                     pixmapsToKeep.append( p );
                 else
+                {
+                    m_allocatedPixmaps.evicted( p );
                     delete p;
+                }
             }
             else
                 pixmapsToKeep.append( p );
@@ -337,10 +474,27 @@ void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
         if (clean_hits == 0) break;
     }
 
-    m_allocatedPixmaps += pixmapsToKeep;
+    foreach ( AllocatedPixmap * p, pixmapsToKeep )
+        m_allocatedPixmaps.insert( p );
     //p--rintf("freeMemory A:[%d -%d = %d] \n", m_allocatedPixmaps.count() + pagesFreed, pagesFreed, m_allocatedPixmaps.count() );
 }
 
+void DocumentPrivate::updatePixmapCachePolicy()
+{
+    switch ( SettingsCore::cachePolicy() )
+    {
+        case SettingsCore::EnumCachePolicy::LeastRecentlyUsed:
+            m_allocatedPixmaps.setPolicy( PixmapEvictionIndex::LeastRecentlyUsed );
+            break;
+        case SettingsCore::EnumCachePolicy::CostWeighted:
+            m_allocatedPixmaps.setPolicy( PixmapEvictionIndex::CostWeighted );
+            break;
+        default:
+            m_allocatedPixmaps.setPolicy( PixmapEvictionIndex::Distance );
+            break;
+    }
+}
+
 /* Returns the next pixmap to evict from cache, or NULL if no suitable pixmap
  * if found. If unloadableOnly is set, only unloadable pixmaps are returned. If
  * thenRemoveIt is set, the pixmap is removed from m_allocatedPixmaps before
@@ -348,40 +502,47 @@ void DocumentPrivate::cleanupPixmapMemory( qulonglong memoryToFree )
  */
 AllocatedPixmap * DocumentPrivate::searchLowestPriorityPixmap( bool unloadableOnly, bool thenRemoveIt, DocumentObserver *observer )
 {
-    QLinkedList< AllocatedPixmap * >::iterator pIt = m_allocatedPixmaps.begin();
-    QLinkedList< AllocatedPixmap * >::iterator pEnd = m_allocatedPixmaps.end();
-    QLinkedList< AllocatedPixmap * >::iterator farthestPixmap = pEnd;
+    updatePixmapCachePolicy();
     const int currentViewportPage = (*m_viewportIterator).pageNumber;
+    return m_allocatedPixmaps.farthest( currentViewportPage, unloadableOnly, thenRemoveIt, observer );
+}
 
-    /* Find the pixmap that is farthest from the current viewport */
-    int maxDistance = -1;
-    while ( pIt != pEnd )
+void DocumentPrivate::pixmapLookedUp( DocumentObserver *observer, int page, bool found )
+{
+    if ( !found )
     {
-        const AllocatedPixmap * p = *pIt;
-        // Filter by observer
-        if ( observer == nullptr || p->observer == observer )
-        {
-            const int distance = qAbs( p->page - currentViewportPage );
-            if ( maxDistance < distance && ( !unloadableOnly || p->observer->canUnloadPixmap( p->page ) ) )
-            {
-                maxDistance = distance;
-                farthestPixmap = pIt;
-            }
-        }
-        ++pIt;
+        ++m_pixmapCacheMisses;
+        return;
     }
 
-    /* No pixmap to remove */
-    if ( farthestPixmap == pEnd )
-        return nullptr;
-
-    AllocatedPixmap * selectedPixmap = *farthestPixmap;
-    if ( thenRemoveIt )
-        m_allocatedPixmaps.erase( farthestPixmap );
-    return selectedPixmap;
+    ++m_pixmapCacheHits;
+    // a hit refreshes the pixmap for the LeastRecentlyUsed policy
+    m_allocatedPixmaps.touch( observer, page );
 }
 
 qulonglong DocumentPrivate::getTotalMemory()
+{
+    const qulonglong physicalMemory = getPhysicalMemory();
+    m_memoryBudget.update( m_allocatedPixmapsTotalMemory + m_allocatedTextPagesTotalMemory );
+    if ( m_memoryBudget.hasLimit() )
+        return qMin( physicalMemory, m_memoryBudget.limit() );
+    return physicalMemory;
+}
+
+qulonglong DocumentPrivate::getFreeMemory( qulonglong *freeSwap )
+{
+    const qulonglong freeMemory = getSystemFreeMemory( freeSwap );
+    m_memoryBudget.update( m_allocatedPixmapsTotalMemory + m_allocatedTextPagesTotalMemory );
+    if ( !m_memoryBudget.hasLimit() )
+        return freeMemory;
+
+    // swapping does not make room within the cgroup limit
+    if ( freeSwap )
+        *freeSwap = 0;
+    return qMin( freeMemory, m_memoryBudget.available() );
+}
+
+qulonglong DocumentPrivate::getPhysicalMemory()
 {
     static qulonglong cachedValue = 0;
     if ( cachedValue )
@@ -417,7 +578,7 @@ qulonglong DocumentPrivate::getTotalMemory()
     return (cachedValue = 134217728);
 }
 
-qulonglong DocumentPrivate::getFreeMemory( qulonglong *freeSwap )
+qulonglong DocumentPrivate::getSystemFreeMemory( qulonglong *freeSwap )
 {
     static QTime lastUpdate = QTime::currentTime().addSecs(-3);
     static qulonglong cachedValue = 0;
@@ -850,6 +1011,10 @@ Document::OpenResult DocumentPrivate::openDocumentInternal( const KPluginMetaDat
     qCDebug(OkularCoreDebug) << "Output DPI:" << dpi;
     m_generator->setDPI(dpi);
 
+    ReloadInterface *reloadIface = qobject_cast< ReloadInterface * >( m_generator );
+    if ( reloadIface )
+        reloadIface->setReloadable( m_reloadable && !isstdin );
+
     Document::OpenResult openResult = Document::OpenError;
     if ( !isstdin )
     {
@@ -1055,6 +1220,9 @@ void DocumentPrivate::performModifyPageAnnotation( int page, Annotation * annota
         proxy->notifyModification( annotation, page, appearanceChanged );
     }
 
+    // the annotation may have been moved or resized
+    kp->d->m_objectRectIndex.invalidate();
+
     // notify observers about the change
     notifyAnnotationChanges( page );
     if ( appearanceChanged && (annotation->flags() & Annotation::ExternallyDrawn) )
@@ -1247,6 +1415,9 @@ void DocumentPrivate::slotTimedMemoryCheck()
     if ( SettingsCore::memoryLevel() != SettingsCore::EnumMemoryLevel::Low &&
          m_allocatedPixmapsTotalMemory > 1024*1024 )
         cleanupPixmapMemory();
+
+    updateTextPageMemory();
+    cleanupTextPageMemory();
 }
 
 void DocumentPrivate::sendGeneratorPixmapRequest()
@@ -1254,28 +1425,48 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
     /* If the pixmap cache will have to be cleaned in order to make room for the
      * next request, get the distance from the current viewport of the page
      * whose pixmap will be removed. We will ignore preload requests for pages
-     * that are at the same distance or farther */
+     * that are at the same distance or farther. The other policies do not
+     * evict by distance, so their victim says nothing about the preloads */
     const qulonglong memoryToFree = calculateMemoryToFree();
     const int currentViewportPage = (*m_viewportIterator).pageNumber;
     int maxDistance = INT_MAX; // Default: No maximum
     if ( memoryToFree )
     {
         AllocatedPixmap *pixmapToReplace = searchLowestPriorityPixmap( true );
-        if ( pixmapToReplace )
+        if ( pixmapToReplace && m_allocatedPixmaps.policy() == PixmapEvictionIndex::Distance )
             maxDistance = qAbs( pixmapToReplace->page - currentViewportPage );
     }
 
+    // pages switch to tiles above a size, and back below a smaller one
+    const long tilingStart = SettingsCore::tiledRenderingStart();
+    const long tilingStop = qMin( (long)SettingsCore::tiledRenderingStop(), tilingStart );
+
+    auto hasPixmapAsBig = []( const PixmapRequest *r ) {
+        const QPixmap *pixmap = r->page()->_o_nearestPixmap( r->observer(), r->width(), r->height() );
+        return pixmap && pixmap->width() >= r->width();
+    };
+
+    // with several render workers, never render the same page twice at
+    // once for the same observer
+    auto isPageBeingRendered = [this]( const PixmapRequest *r ) {
+        foreach ( PixmapRequest *executing, m_executingPixmapRequests )
+        {
+            if ( executing->observer() == r->observer() && executing->pageNumber() == r->pageNumber() )
+                return true;
+        }
+        return false;
+    };
+
     // find a request
     PixmapRequest * request = nullptr;
+    bool requestsBlocked = false;
     m_pixmapRequestsMutex.lock();
-    while ( !m_pixmapRequestsStack.isEmpty() && !request )
+    m_pixmapScheduler.setViewportPage( currentViewportPage );
+    while ( !m_pixmapScheduler.isEmpty() && !request )
     {
-        PixmapRequest * r = m_pixmapRequestsStack.last();
-        if (!r)
-        {
-            m_pixmapRequestsStack.pop_back();
-            continue;
-        }
+        PixmapRequest * r = m_pixmapScheduler.top();
+        if ( !r )
+            break;
 
         QRect requestRect = r->isTile() ? r->normalizedRect().geometry( r->width(), r->height() ) : QRect( 0, 0, r->width(), r->height() );
         TilesManager *tilesManager = r->d->tilesManager();
@@ -1283,30 +1474,37 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
         // If it's a preload but the generator is not threaded no point in trying to preload
         if ( r->preload() && !m_generator->hasFeature( Generator::Threaded ) )
         {
-            m_pixmapRequestsStack.pop_back();
-            delete r;
+            m_pixmapScheduler.drop( r );
         }
         // request only if page isn't already present and request has valid id
         // request only if page isn't already present and request has valid id
-        else if ( ( !r->d->mForce && r->page()->hasPixmap( r->observer(), r->width(), r->height(), r->normalizedRect() ) ) || !m_observers.contains(r->observer()) )
+        else if ( ( !r->d->mForce && r->page()->d->hasPixmap( r->observer(), r->width(), r->height(), r->normalizedRect() ) ) || !m_observers.contains(r->observer()) )
         {
-            m_pixmapRequestsStack.pop_back();
-            delete r;
+            m_pixmapScheduler.drop( r );
+        }
+        // a preview is of no use once a bigger pixmap is there
+        else if ( r->isPreview() && hasPixmapAsBig( r ) )
+        {
+            m_pixmapScheduler.drop( r );
         }
         else if ( !r->d->mForce && r->preload() && qAbs( r->pageNumber() - currentViewportPage ) >= maxDistance )
         {
-            m_pixmapRequestsStack.pop_back();
             //qCDebug(OkularCoreDebug) << "Ignoring request that doesn't fit in cache";
-            delete r;
+            m_pixmapScheduler.drop( r );
         }
         // Ignore requests for pixmaps that are already being generated
         else if ( tilesManager && tilesManager->isRequesting( r->normalizedRect(), r->width(), r->height() ) )
         {
-            m_pixmapRequestsStack.pop_back();
-            delete r;
+            m_pixmapScheduler.drop( r );
+        }
+        // wait for the page to be done, serving the other pages meanwhile
+        else if ( isPageBeingRendered( r ) )
+        {
+            m_pixmapScheduler.skip( r );
+            requestsBlocked = true;
         }
-        // If the requested area is above 8000000 pixels, switch on the tile manager
-        else if ( !tilesManager && m_generator->hasFeature( Generator::TiledRendering ) && (long)r->width() * (long)r->height() > 8000000L )
+        // If the requested area is above tilingStart pixels, switch on the tile manager
+        else if ( !tilesManager && m_generator->hasFeature( Generator::TiledRendering ) && (long)r->width() * (long)r->height() > tilingStart )
         {
             // if the image is too big. start using tiles
             qCDebug(OkularCoreDebug).nospace() << "Start using tiles on page " << r->pageNumber()
@@ -1325,6 +1523,7 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
                 // create new tiles manager
                 tilesManager = new TilesManager( r->pageNumber(), r->width(), r->height(), r->page()->rotation() );
             }
+            tilesManager->setViewportSize( r->normalizedRect().geometry( r->width(), r->height() ).size() );
             tilesManager->setRequest( r->normalizedRect(), r->width(), r->height() );
             r->page()->deletePixmap( r->observer() );
             r->page()->d->setTilesManager( r->observer(), tilesManager );
@@ -1357,12 +1556,11 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
                 // preload requests issued by PageView if the requested page is
                 // not visible and the user has just switched from a non-tiled
                 // zoom level to a tiled one
-                m_pixmapRequestsStack.pop_back();
-                delete r;
+                m_pixmapScheduler.drop( r );
             }
         }
-        // If the requested area is below 6000000 pixels, switch off the tile manager
-        else if ( tilesManager && (long)r->width() * (long)r->height() < 6000000L )
+        // If the requested area is below tilingStop pixels, switch off the tile manager
+        else if ( tilesManager && (long)r->width() * (long)r->height() < tilingStop )
         {
             qCDebug(OkularCoreDebug).nospace() << "Stop using tiles on page " << r->pageNumber()
                 << " (" << r->width() << "x" << r->height() << " px);";
@@ -1375,7 +1573,6 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
         }
         else if ( (long)requestRect.width() * (long)requestRect.height() > 200000000L && (SettingsCore::memoryLevel() != SettingsCore::EnumMemoryLevel::Greedy ) )
         {
-            m_pixmapRequestsStack.pop_back();
             if ( !m_warnedOutOfMemory )
             {
                 qCWarning(OkularCoreDebug).nospace() << "Running out of memory on page " << r->pageNumber()
@@ -1383,7 +1580,7 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
                 qCWarning(OkularCoreDebug) << "this message will be reported only once.";
                 m_warnedOutOfMemory = true;
             }
-            delete r;
+            m_pixmapScheduler.drop( r );
         }
         else
         {
@@ -1391,10 +1588,15 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
         }
     }
 
-    // if no request found (or already generated), return
+    m_pixmapScheduler.unskipAll();
+
+    // if no request found (or already generated), return; if all of them
+    // wait for their page, try again once it is done
     if ( !request )
     {
         m_pixmapRequestsMutex.unlock();
+        if ( requestsBlocked )
+            QTimer::singleShot( 30, m_parent, SLOT(sendGeneratorPixmapRequest()) );
         return;
     }
 
@@ -1409,12 +1611,40 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
     if ( pixmapBytes > (1024 * 1024) )
         cleanupPixmapMemory( memoryToFree /* previously calculated value */ );
 
+    // [MEM] decompressing an evicted pixmap is cheaper than rendering it
+    if ( !request->isTile() && !request->isPreview() && !request->d->mForce && request->asynchronous() &&
+         m_compressedPixmaps.retrieve( request, m_rotation ) )
+    {
+        QMap< DocumentObserver*, PagePrivate::PixmapObject >::const_iterator it = request->page()->d->m_pixmaps.constFind( request->observer() );
+        request->d->mPixmapKey = it != request->page()->d->m_pixmaps.constEnd() ? it.value().m_pixmap->cacheKey() : 0;
+        m_pixmapScheduler.remove( request );
+        m_executingPixmapRequests.push_back( request );
+        const bool hasPixmaps = !m_pixmapScheduler.isEmpty();
+        m_pixmapRequestsMutex.unlock();
+        if ( hasPixmaps )
+            sendGeneratorPixmapRequest();
+        return;
+    }
+
+    // [MEM] a render kept on disk by an earlier session only needs loading
+    if ( !request->isTile() && !request->isPreview() && !request->isThumbnail() && !request->d->mForce && request->asynchronous() &&
+         m_diskRenderCache.retrieve( request, diskRenderCacheHints(), m_rotation ) )
+    {
+        m_pixmapScheduler.remove( request );
+        m_executingPixmapRequests.push_back( request );
+        const bool hasPixmaps = !m_pixmapScheduler.isEmpty();
+        m_pixmapRequestsMutex.unlock();
+        if ( hasPixmaps )
+            sendGeneratorPixmapRequest();
+        return;
+    }
+
     // submit the request to the generator
-    if ( m_generator->canGeneratePixmap() )
+    if ( m_generator->canGeneratePixmap() && m_generator->d_func()->canStartPixmapGeneration( request ) )
     {
         QRect requestRect = !request->isTile() ? QRect(0, 0, request->width(), request->height() ) : request->normalizedRect().geometry( request->width(), request->height() );
         qCDebug(OkularCoreDebug).nospace() << "sending request observer=" << request->observer() << " " <<requestRect.width() << "x" << requestRect.height() << "@" << request->pageNumber() << " async == " << request->asynchronous() << " isTile == " << request->isTile();
-        m_pixmapRequestsStack.removeAll ( request );
+        m_pixmapScheduler.remove( request );
 
         if ( tm )
             tm->setRequest( request->normalizedRect(), request->width(), request->height() );
@@ -1431,7 +1661,19 @@ void DocumentPrivate::sendGeneratorPixmapRequest()
         // we can not really know if the generator can do async requests
         m_executingPixmapRequests.push_back( request );
         m_pixmapRequestsMutex.unlock();
+        const bool asynchronous = request->asynchronous();
+        request->d->mRenderTimer.start();
         m_generator->generatePixmap( request );
+
+        // keep feeding the render workers that are still idle
+        if ( asynchronous && m_generator->canGeneratePixmap() )
+        {
+            m_pixmapRequestsMutex.lock();
+            const bool hasPixmaps = !m_pixmapScheduler.isEmpty();
+            m_pixmapRequestsMutex.unlock();
+            if ( hasPixmaps )
+                sendGeneratorPixmapRequest();
+        }
     }
     else
     {
@@ -1500,9 +1742,11 @@ void DocumentPrivate::slotGeneratorConfigChanged( const QString& )
         }
 
         // [MEM] remove allocation descriptors
-        qDeleteAll( m_allocatedPixmaps );
         m_allocatedPixmaps.clear();
         m_allocatedPixmapsTotalMemory = 0;
+        m_compressedPixmaps.clear();
+        m_diskRenderCache.clear();
+        m_thumbnailPipeline.clear();
 
         // send reload signals to observers
         foreachObserverD( notifyContentsCleared( DocumentObserver::Pixmap ) );
@@ -1520,6 +1764,10 @@ void DocumentPrivate::refreshPixmaps( int pageNumber )
     if ( !page )
         return;
 
+    m_compressedPixmaps.removePage( pageNumber );
+    m_diskRenderCache.removePage( pageNumber );
+    m_thumbnailPipeline.removePage( pageNumber );
+
     QLinkedList< Okular::PixmapRequest * > requestedPixmaps;
     QMap< DocumentObserver*, PagePrivate::PixmapObject >::ConstIterator it = page->d->m_pixmaps.constBegin(), itEnd = page->d->m_pixmaps.constEnd();
     for ( ; it != itEnd; ++it )
@@ -1575,11 +1823,8 @@ void DocumentPrivate::_o_configChanged()
 {
     // free text pages if needed
     calculateMaxTextPages();
-    while (m_allocatedTextPagesFifo.count() > m_maxAllocatedTextPages)
-    {
-        int pageToKick = m_allocatedTextPagesFifo.takeFirst();
-        m_pagesVector.at(pageToKick)->setTextPage( nullptr ); // deletes the textpage
-    }
+    updateTextPageMemory();
+    cleanupTextPageMemory();
 }
 
 void DocumentPrivate::doContinueDirectionMatchSearch(void *doContinueDirectionMatchSearchStruct)
@@ -1626,12 +1871,20 @@ void DocumentPrivate::doContinueDirectionMatchSearch(void *doContinueDirectionMa
     {
         // get page
         Page * page = m_pagesVector[ searchStruct->currentPage ];
-        // request search page if needed
-        if ( !page->hasTextPage() )
-            m_parent->requestTextPage( page->number() );
+        // skip the page without its text if the text index rules it out
+        if ( !search->candidatePages.isEmpty() && !search->candidatePages.at( page->number() ) )
+        {
+            searchStruct->match = nullptr;
+        }
+        else
+        {
+            // request search page if needed
+            if ( !page->hasTextPage() )
+                m_parent->requestTextPage( page->number() );
 
-        // if found a match on the current page, end the loop
-        searchStruct->match = page->findText( searchStruct->searchID, search->cachedString, forward ? FromTop : FromBottom, search->cachedCaseSensitivity );
+            // if found a match on the current page, end the loop
+            searchStruct->match = page->d->findText( searchStruct->searchID, search->pattern, forward ? FromTop : FromBottom );
+        }
         if ( !searchStruct->match )
         {
             if (forward) searchStruct->currentPage++;
@@ -1653,6 +1906,71 @@ void DocumentPrivate::doContinueDirectionMatchSearch(void *doContinueDirectionMa
     }
 }
 
+void DocumentPrivate::loadPageData( Page *page )
+{
+    PageDataInterface *iface = qobject_cast< PageDataInterface * >( m_generator );
+    if ( !iface )
+        return;
+
+    m_loadingPageData = true;
+    iface->loadPageData( page );
+
+    // as when opening the document, with annotations in the file
+    if ( !m_archiveData && !page->m_annotations.isEmpty() && canAddAnnotationsNatively() )
+        m_annotationsNeedSaveAs = true;
+
+    // restore the local annotations and forms kept meanwhile, quietly
+    if ( !page->d->m_pendingLocalContents.isNull() )
+    {
+        const QDomDocument contents = page->d->m_pendingLocalContents;
+        page->d->m_pendingLocalContents = QDomDocument();
+        const bool showWarning = m_showWarningLimitedAnnotSupport;
+        m_showWarningLimitedAnnotSupport = false;
+        page->d->restoreLocalContents( contents.documentElement() );
+        m_showWarningLimitedAnnotSupport = showWarning;
+    }
+    m_loadingPageData = false;
+
+    // the data may be asked for by an observer going through the pages,
+    // tell them all once it is done
+    if ( m_pagesWithLoadedData.isEmpty() )
+        QMetaObject::invokeMethod( m_parent, "notifyPageDataLoaded", Qt::QueuedConnection );
+    m_pagesWithLoadedData.append( page->number() );
+}
+
+void DocumentPrivate::loadAllPageData()
+{
+    foreach ( Page *page, m_pagesVector )
+        page->d->loadPendingData();
+}
+
+void DocumentPrivate::doContinuePageDataLoading( int run )
+{
+    // closed or opened again meanwhile
+    if ( run != m_pageDataRun || !m_generator )
+        return;
+
+    // load for a few milliseconds at a time, not to hold up the user
+    QElapsedTimer timer;
+    timer.start();
+    const int count = m_pagesVector.count();
+    while ( m_nextPendingPageData < count && timer.elapsed() < 10 )
+        m_pagesVector.at( m_nextPendingPageData++ )->d->loadPendingData();
+
+    if ( m_nextPendingPageData < count )
+        QMetaObject::invokeMethod( m_parent, "doContinuePageDataLoading", Qt::QueuedConnection, Q_ARG(int, run) );
+    else
+        qCDebug(OkularCoreDebug) << "Data of all the pages loaded";
+}
+
+void DocumentPrivate::notifyPageDataLoaded()
+{
+    const QVector< int > pages = m_pagesWithLoadedData;
+    m_pagesWithLoadedData.clear();
+    foreach ( int page, pages )
+        notifyAnnotationChanges( page );
+}
+
 void DocumentPrivate::doProcessSearchMatch( RegularAreaRect *match, RunningSearch *search, QSet< int > *pagesToNotify, int currentPage, int searchID, bool moveViewport, const QColor & color )
 {
     // reset cursor to previous shape
@@ -1707,212 +2025,139 @@ void DocumentPrivate::doProcessSearchMatch( RegularAreaRect *match, RunningSearc
     delete pagesToNotify;
 }
 
-void DocumentPrivate::doContinueAllDocumentSearch(void *pagesToNotifySet, void *pageMatchesMap, int currentPage, int searchID)
+void DocumentPrivate::startDocumentSearch( int searchID, const QVector< SearchTerm > &terms, bool matchAll )
 {
-    QMap< Page *, QVector<RegularAreaRect *> > *pageMatches = static_cast< QMap< Page *, QVector<RegularAreaRect *> > * >(pageMatchesMap);
-    QSet< int > *pagesToNotify = static_cast< QSet< int > * >( pagesToNotifySet );
-    RunningSearch *search = m_searches.value(searchID);
+    RunningSearch *search = m_searches.value( searchID );
+    search->terms = terms;
+    search->matchAll = matchAll;
+    search->matchFound = false;
+    search->pagesToSearch.clear();
+    ++search->documentSearchRun;
 
-    if (m_searchCancelled || !search)
+    // only look at the pages the text index did not rule out
+    const QVector< bool > candidates = textIndexCandidates( terms, matchAll );
+    QVector< Page * > pages;
+    foreach ( Page *page, m_pagesVector )
     {
-        typedef QVector<RegularAreaRect *> MatchesVector;
-
-        QApplication::restoreOverrideCursor();
-
-        if (search) search->isCurrentlySearching = false;
-
-        emit m_parent->searchFinished( searchID, Document::SearchCancelled );
-        foreach(const MatchesVector &mv, *pageMatches) qDeleteAll(mv);
-        delete pageMatches;
-        delete pagesToNotify;
-        return;
+        if ( candidates.isEmpty() || candidates.at( page->number() ) )
+            pages.append( page );
     }
-
-    if (currentPage < m_pagesVector.count())
+    search->pagesPending = pages.count();
+    if ( pages.isEmpty() )
     {
-        // get page (from the first to the last)
-        Page *page = m_pagesVector.at(currentPage);
-        int pageNumber = page->number(); // redundant? is it == currentPage ?
-
-        // request search page if needed
-        if ( !page->hasTextPage() )
-            m_parent->requestTextPage( pageNumber );
-
-        // loop on a page adding highlights for all found items
-        RegularAreaRect * lastMatch = nullptr;
-        while ( 1 )
-        {
-            if ( lastMatch )
-                lastMatch = page->findText( searchID, search->cachedString, NextResult, search->cachedCaseSensitivity, lastMatch );
-            else
-                lastMatch = page->findText( searchID, search->cachedString, FromTop, search->cachedCaseSensitivity );
-
-            if ( !lastMatch )
-                break;
-
-            // add highligh rect to the matches map
-            (*pageMatches)[page].append(lastMatch);
-        }
-        delete lastMatch;
-
-        QMetaObject::invokeMethod(m_parent, "doContinueAllDocumentSearch", Qt::QueuedConnection, Q_ARG(void *, pagesToNotifySet), Q_ARG(void *, pageMatches), Q_ARG(int, currentPage + 1), Q_ARG(int, searchID));
+        finishDocumentSearch( searchID, Document::NoMatchFound );
+        return;
     }
-    else
-    {
-        // reset cursor to previous shape
-        QApplication::restoreOverrideCursor();
-
-        search->isCurrentlySearching = false;
-        bool foundAMatch = pageMatches->count() != 0;
-        QMap< Page *, QVector<RegularAreaRect *> >::const_iterator it, itEnd;
-        it = pageMatches->constBegin();
-        itEnd = pageMatches->constEnd();
-        for ( ; it != itEnd; ++it)
-        {
-            foreach(RegularAreaRect *match, it.value())
-            {
-                it.key()->d->setHighlight( searchID, match, search->cachedColor );
-                delete match;
-            }
-            search->highlightedPages.insert( it.key()->number() );
-            pagesToNotify->insert( it.key()->number() );
-        }
-
-        foreach(DocumentObserver *observer, m_observers)
-            observer->notifySetup( m_pagesVector, 0 );
-
-        // notify observers about highlights changes
-        foreach(int pageNumber, *pagesToNotify)
-            foreach(DocumentObserver *observer, m_observers)
-                observer->notifyPageChanged( pageNumber, DocumentObserver::Highlights );
 
-        if (foundAMatch) emit m_parent->searchFinished(searchID, Document::MatchFound );
-        else emit m_parent->searchFinished( searchID, Document::NoMatchFound );
+    // search the pages around the current one first, so that the matches
+    // the user is most likely to look at show up first
+    const int currentPage = qMax( (*m_viewportIterator).pageNumber, 0 );
+    std::stable_sort( pages.begin(), pages.end(), [currentPage]( const Page *p1, const Page *p2 ) {
+        return qAbs( p1->number() - currentPage ) < qAbs( p2->number() - currentPage );
+    } );
 
-        delete pageMatches;
-        delete pagesToNotify;
+    // the pages with no text yet are extracted and searched in background
+    // threads, the others are searched here one at a time
+    const bool background = m_generator->hasFeature( Generator::Threaded );
+    if ( background )
+        m_documentSearch.start( searchID, m_generator, terms, matchAll );
+    foreach ( Page *page, pages )
+    {
+        if ( background && !page->hasTextPage() )
+            m_documentSearch.searchPage( searchID, page );
+        else
+            search->pagesToSearch.append( page );
     }
+
+    if ( !search->pagesToSearch.isEmpty() )
+        QMetaObject::invokeMethod( m_parent, "doContinueDocumentSearch", Qt::QueuedConnection, Q_ARG(int, searchID), Q_ARG(int, search->documentSearchRun) );
 }
 
-void DocumentPrivate::doContinueGooglesDocumentSearch(void *pagesToNotifySet, void *pageMatchesMap, int currentPage, int searchID, const QStringList & words)
+void DocumentPrivate::doContinueDocumentSearch( int searchID, int run )
 {
-    typedef QPair<RegularAreaRect *, QColor> MatchColor;
-    QMap< Page *, QVector<MatchColor> > *pageMatches = static_cast< QMap< Page *, QVector<MatchColor> > * >(pageMatchesMap);
-    QSet< int > *pagesToNotify = static_cast< QSet< int > * >( pagesToNotifySet );
-    RunningSearch *search = m_searches.value(searchID);
+    RunningSearch *search = m_searches.value( searchID );
+    // finished, cancelled or started again meanwhile
+    if ( !search || search->documentSearchRun != run || search->pagesToSearch.isEmpty() )
+        return;
 
-    if (m_searchCancelled || !search)
-    {
-        typedef QVector<MatchColor> MatchesVector;
+    Page *page = search->pagesToSearch.takeFirst();
 
-        QApplication::restoreOverrideCursor();
+    // request search page if needed
+    if ( !page->hasTextPage() )
+        m_parent->requestTextPage( page->number() );
 
-        if (search) search->isCurrentlySearching = false;
+    QVector< SearchMatch > matches;
+    if ( page->d->m_text )
+        matches = DocumentSearch::matchTextPage( page->d->m_text, searchID, search->terms, search->matchAll );
+    documentSearchPageDone( searchID, page, matches );
 
-        emit m_parent->searchFinished( searchID, Document::SearchCancelled );
+    // the search may be over, or even gone, now
+    search = m_searches.value( searchID );
+    if ( search && search->documentSearchRun == run && !search->pagesToSearch.isEmpty() )
+        QMetaObject::invokeMethod( m_parent, "doContinueDocumentSearch", Qt::QueuedConnection, Q_ARG(int, searchID), Q_ARG(int, run) );
+}
 
-        foreach(const MatchesVector &mv, *pageMatches)
+void DocumentPrivate::documentSearchPageSearched( int searchID, Page *page, TextPage *textPage, const QVector< SearchMatch > &matches )
+{
+    if ( textPage )
+    {
+        // keep the extracted text, unless the page got its own meanwhile
+        if ( page->hasTextPage() )
         {
-            foreach(const MatchColor &mc, mv) delete mc.first;
+            delete textPage;
+        }
+        else
+        {
+            page->setTextPage( textPage );
+            textGenerationDone( page );
         }
-        delete pageMatches;
-        delete pagesToNotify;
-        return;
     }
 
-    const int wordCount = words.count();
-    const int hueStep = (wordCount > 1) ? (60 / (wordCount - 1)) : 60;
-    int baseHue, baseSat, baseVal;
-    search->cachedColor.getHsv( &baseHue, &baseSat, &baseVal );
+    documentSearchPageDone( searchID, page, matches );
+}
 
-    if (currentPage < m_pagesVector.count())
+void DocumentPrivate::documentSearchPageDone( int searchID, Page *page, const QVector< SearchMatch > &matches )
+{
+    RunningSearch *search = m_searches.value( searchID );
+    if ( !search || search->pagesPending <= 0 )
     {
-        // get page (from the first to the last)
-        Page *page = m_pagesVector.at(currentPage);
-        int pageNumber = page->number(); // redundant? is it == currentPage ?
-
-        // request search page if needed
-        if ( !page->hasTextPage() )
-            m_parent->requestTextPage( pageNumber );
-
-        // loop on a page adding highlights for all found items
-        bool allMatched = wordCount > 0,
-             anyMatched = false;
-        for ( int w = 0; w < wordCount; w++ )
-        {
-            const QString &word = words[ w ];
-            int newHue = baseHue - w * hueStep;
-            if ( newHue < 0 )
-                newHue += 360;
-            QColor wordColor = QColor::fromHsv( newHue, baseSat, baseVal );
-            RegularAreaRect * lastMatch = nullptr;
-            // add all highlights for current word
-            bool wordMatched = false;
-            while ( 1 )
-            {
-                if ( lastMatch )
-                    lastMatch = page->findText( searchID, word, NextResult, search->cachedCaseSensitivity, lastMatch );
-                else
-                    lastMatch = page->findText( searchID, word, FromTop, search->cachedCaseSensitivity);
-
-                if ( !lastMatch )
-                    break;
-
-                // add highligh rect to the matches map
-                (*pageMatches)[page].append(MatchColor(lastMatch, wordColor));
-                wordMatched = true;
-            }
-            allMatched = allMatched && wordMatched;
-            anyMatched = anyMatched || wordMatched;
-        }
-
-        // if not all words are present in page, remove partial highlights
-        const bool matchAll = search->cachedType == Document::GoogleAll;
-        if ( !allMatched && matchAll )
-        {
-            QVector<MatchColor> &matches = (*pageMatches)[page];
-            foreach(const MatchColor &mc, matches) delete mc.first;
-            pageMatches->remove(page);
-        }
+        foreach ( const SearchMatch &match, matches )
+            delete match.first;
+        return;
+    }
 
-        QMetaObject::invokeMethod(m_parent, "doContinueGooglesDocumentSearch", Qt::QueuedConnection, Q_ARG(void *, pagesToNotifySet), Q_ARG(void *, pageMatches), Q_ARG(int, currentPage + 1), Q_ARG(int, searchID), Q_ARG(QStringList, words));
+    // highlight the matches of the page right away
+    foreach ( const SearchMatch &match, matches )
+    {
+        page->d->setHighlight( searchID, match.first, match.second );
+        delete match.first;
     }
-    else
+    if ( !matches.isEmpty() )
     {
-        // reset cursor to previous shape
-        QApplication::restoreOverrideCursor();
+        search->matchFound = true;
+        search->highlightedPages.insert( page->number() );
+        foreachObserverD( notifyPageChanged( page->number(), DocumentObserver::Highlights ) );
+    }
 
-        search->isCurrentlySearching = false;
-        bool foundAMatch = pageMatches->count() != 0;
-        QMap< Page *, QVector<MatchColor> >::const_iterator it, itEnd;
-        it = pageMatches->constBegin();
-        itEnd = pageMatches->constEnd();
-        for ( ; it != itEnd; ++it)
-        {
-            foreach(const MatchColor &mc, it.value())
-            {
-                it.key()->d->setHighlight( searchID, mc.first, mc.second );
-                delete mc.first;
-            }
-            search->highlightedPages.insert( it.key()->number() );
-            pagesToNotify->insert( it.key()->number() );
-        }
+    if ( --search->pagesPending == 0 )
+        finishDocumentSearch( searchID, search->matchFound ? Document::MatchFound : Document::NoMatchFound );
+}
 
-        // send page lists to update observers (since some filter on bookmarks)
-        foreach(DocumentObserver *observer, m_observers)
-            observer->notifySetup( m_pagesVector, 0 );
+void DocumentPrivate::finishDocumentSearch( int searchID, Document::SearchStatus status )
+{
+    RunningSearch *search = m_searches.value( searchID );
+    m_documentSearch.cancel( searchID );
+    search->pagesToSearch.clear();
+    search->pagesPending = 0;
+    search->isCurrentlySearching = false;
 
-        // notify observers about highlights changes
-        foreach(int pageNumber, *pagesToNotify)
-            foreach(DocumentObserver *observer, m_observers)
-                observer->notifyPageChanged( pageNumber, DocumentObserver::Highlights );
+    // reset cursor to previous shape
+    QApplication::restoreOverrideCursor();
 
-        if (foundAMatch) emit m_parent->searchFinished( searchID, Document::MatchFound );
-        else emit m_parent->searchFinished( searchID, Document::NoMatchFound );
+    // send page lists to update observers (since some filter on matches)
+    foreachObserverD( notifySetup( m_pagesVector, 0 ) );
 
-        delete pageMatches;
-        delete pagesToNotify;
-    }
+    emit m_parent->searchFinished( searchID, status );
 }
 
 QVariant DocumentPrivate::documentMetaData( const Generator::DocumentMetaDataKey key, const QVariant &option ) const
@@ -2135,6 +2380,14 @@ Document::Document( QWidget *widget )
     d->m_undoStack = new QUndoStack(this);
 
     connect( SettingsCore::self(), SIGNAL(configChanged()), this, SLOT(_o_configChanged()) );
+    connect( &d->m_compressedPixmaps, &CompressedPixmapCache::retrieved, this,
+             [this]( PixmapRequest *request, const QImage &image, Rotation rotation ) { d->compressedPixmapRetrieved( request, image, rotation ); } );
+    connect( &d->m_diskRenderCache, &DiskRenderCache::retrieved, this,
+             [this]( PixmapRequest *request, const QImage &image, Rotation rotation ) { d->diskRenderRetrieved( request, image, rotation ); } );
+    connect( &d->m_thumbnailPipeline, &ThumbnailPipeline::fetched, this,
+             [this]( PixmapRequest *request, const QImage &image ) { d->thumbnailFetched( request, image ); } );
+    connect( &d->m_documentSearch, &DocumentSearch::pageSearched, this,
+             [this]( int searchID, Page *page, TextPage *textPage, const QVector< SearchMatch > &matches ) { d->documentSearchPageSearched( searchID, page, textPage, matches ); } );
     connect(d->m_undoStack, &QUndoStack::canUndoChanged, this, &Document::canUndoChanged);
     connect(d->m_undoStack, &QUndoStack::canRedoChanged, this, &Document::canRedoChanged);
 
@@ -2419,15 +2672,21 @@ Document::OpenResult Document::openDocument(const QString & docFile, const QUrl
     }
 
     d->m_generatorName = offer.pluginId();
+    d->openRenderCaches();
+    d->openTextIndex();
     d->m_pageController = new PageController();
     connect( d->m_pageController, SIGNAL(rotationFinished(int,Okular::Page*)),
              this, SLOT(rotationFinished(int,Okular::Page*)) );
 
+    // the generator may leave the annotations, forms, ... of the pages to
+    // be loaded later
+    const bool pageDataPending = qobject_cast< PageDataInterface * >( d->m_generator ) != nullptr;
     bool containsExternalAnnotations = false;
     foreach ( Page * p, d->m_pagesVector )
     {
         p->d->m_doc = d;
-        if ( !p->annotations().empty() )
+        p->d->m_dataPending = pageDataPending;
+        if ( !pageDataPending && !p->annotations().empty() )
             containsExternalAnnotations = true;
     }
 
@@ -2453,6 +2712,13 @@ Document::OpenResult Document::openDocument(const QString & docFile, const QUrl
     // 3. setup observers inernal lists and data
     foreachObserver( notifySetup( d->m_pagesVector, DocumentObserver::DocumentChanged ) );
 
+    // the visible pages get their data first, the others meanwhile
+    if ( pageDataPending )
+    {
+        d->m_nextPendingPageData = 0;
+        QMetaObject::invokeMethod( this, "doContinuePageDataLoading", Qt::QueuedConnection, Q_ARG(int, d->m_pageDataRun) );
+    }
+
     // 4. set initial page (restoring the page saved in xml if loaded)
     DocumentViewport loadedViewport = (*d->m_viewportIterator);
     if ( loadedViewport.isValid() )
@@ -2492,17 +2758,22 @@ Document::OpenResult Document::openDocument(const QString & docFile, const QUrl
     AudioPlayer::instance()->d->m_currentDocument = isstdin ? QUrl() : d->m_url;
     d->m_docSize = document_size;
 
-    const QStringList docScripts = d->m_generator->metaData( QStringLiteral("DocumentScripts"), QStringLiteral ( "JavaScript" ) ).toStringList();
+    d->runDocumentScripts();
+
+    return OpenSuccess;
+}
+
+void DocumentPrivate::runDocumentScripts()
+{
+    const QStringList docScripts = m_generator->metaData( QStringLiteral("DocumentScripts"), QStringLiteral ( "JavaScript" ) ).toStringList();
     if ( !docScripts.isEmpty() )
     {
-        d->m_scripter = new Scripter( d );
+        m_scripter = new Scripter( this );
         Q_FOREACH ( const QString &docscript, docScripts )
         {
-            d->m_scripter->execute( JavaScript, docscript );
+            m_scripter->execute( JavaScript, docscript );
         }
     }
-
-    return OpenSuccess;
 }
 
 
@@ -2523,44 +2794,17 @@ void Document::closeDocument()
     if ( !d->m_generator )
         return;
 
-    delete d->m_pageController;
-    d->m_pageController = nullptr;
+    d->stopPageWork();
 
     delete d->m_scripter;
     d->m_scripter = nullptr;
 
-     // remove requests left in queue
-    d->m_pixmapRequestsMutex.lock();
-    QLinkedList< PixmapRequest * >::const_iterator sIt = d->m_pixmapRequestsStack.constBegin();
-    QLinkedList< PixmapRequest * >::const_iterator sEnd = d->m_pixmapRequestsStack.constEnd();
-    for ( ; sIt != sEnd; ++sIt )
-        delete *sIt;
-    d->m_pixmapRequestsStack.clear();
-    d->m_pixmapRequestsMutex.unlock();
-
-    QEventLoop loop;
-    bool startEventLoop = false;
-    do
-    {
-        d->m_pixmapRequestsMutex.lock();
-        startEventLoop = !d->m_executingPixmapRequests.isEmpty();
-        d->m_pixmapRequestsMutex.unlock();
-        if ( startEventLoop )
-        {
-            d->m_closingLoop = &loop;
-            loop.exec();
-            d->m_closingLoop = nullptr;
-        }
-    }
-    while ( startEventLoop );
-
-    if ( d->m_fontThread )
-    {
-        disconnect( d->m_fontThread, nullptr, this, nullptr );
-        d->m_fontThread->stopExtraction();
-        d->m_fontThread->wait();
-        d->m_fontThread = nullptr;
-    }
+    const qulonglong pixmapCacheLookups = d->m_pixmapCacheHits + d->m_pixmapCacheMisses;
+    if ( pixmapCacheLookups > 0 )
+        qCDebug(OkularCoreDebug).nospace() << "Pixmap cache: " << d->m_pixmapCacheHits << " hits, " << d->m_pixmapCacheMisses << " misses, "
+            << ( 100 * d->m_pixmapCacheHits / pixmapCacheLookups ) << "% hit rate";
+    d->m_pixmapCacheHits = 0;
+    d->m_pixmapCacheMisses = 0;
 
     // stop any audio playback
     AudioPlayer::instance()->stopPlaybacks();
@@ -2623,8 +2867,17 @@ void Document::closeDocument()
     d->m_pagesVector.clear();
 
     // clear 'memory allocation' descriptors
-    qDeleteAll( d->m_allocatedPixmaps );
     d->m_allocatedPixmaps.clear();
+    d->m_compressedPixmaps.clear();
+    // the renders of the edited pages were dropped, but the edits may have
+    // moved things around other pages too
+    if ( d->hasUnsavedEdits() )
+    {
+        d->m_diskRenderCache.clear();
+        d->m_thumbnailPipeline.clear();
+    }
+    d->m_diskRenderCache.close();
+    d->m_thumbnailPipeline.close();
 
     // clear 'running searches' descriptors
     QMap< int, RunningSearch * >::const_iterator rIt = d->m_searches.constBegin();
@@ -2647,7 +2900,8 @@ void Document::closeDocument()
     d->m_viewportHistory.append( DocumentViewport() );
     d->m_viewportIterator = d->m_viewportHistory.begin();
     d->m_allocatedPixmapsTotalMemory = 0;
-    d->m_allocatedTextPagesFifo.clear();
+    d->m_allocatedTextPages.clear();
+    d->m_allocatedTextPagesTotalMemory = 0;
     d->m_pageSize = PageSize();
     d->m_pageSizes.clear();
 
@@ -2659,6 +2913,257 @@ void Document::closeDocument()
     d->m_undoStack->clear();
 }
 
+void Document::setReloadable( bool reloadable )
+{
+    d->m_reloadable = reloadable;
+}
+
+bool Document::reloadDocumentFile()
+{
+    ReloadInterface *iface = qobject_cast< ReloadInterface * >( d->m_generator );
+    if ( !iface || d->m_docFileName.isEmpty() || d->m_archiveData || d->m_pagesVector.isEmpty() )
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    d->stopPageWork();
+
+    // only the pages with something to keep are worth a fingerprint, taken
+    // before the generator lets the old document go
+    QVector< QByteArray > oldFingerprints( d->m_pagesVector.count() );
+    for ( int i = 0; i < d->m_pagesVector.count(); ++i )
+    {
+        const PagePrivate *oldPage = d->m_pagesVector.at( i )->d;
+        if ( !oldPage->m_pixmaps.isEmpty() || !oldPage->m_tilesManagers.isEmpty() || oldPage->m_text )
+            oldFingerprints[ i ] = iface->pageFingerprint( i );
+    }
+
+    delete d->m_scripter;
+    d->m_scripter = nullptr;
+    AudioPlayer::instance()->stopPlaybacks();
+
+    // the local contents of the pages go to the new ones, as a close and
+    // open would restore them; the bounding boxes of the pages that did not
+    // change are kept with their pixmaps
+    d->saveDocumentInfo();
+    QDomDocument localContents( QStringLiteral("documentInfo") );
+    QDomElement pageList = localContents.createElement( QStringLiteral("pageList") );
+    localContents.appendChild( pageList );
+    PageItems saveWhat = AllPageItems;
+    saveWhat &= ~BoundingBoxPageItems;
+    if ( d->m_annotationsNeedSaveAs )
+        saveWhat |= OriginalAnnotationPageItems;
+    foreach ( Page *page, d->m_pagesVector )
+        page->d->saveLocalContents( pageList, localContents, saveWhat );
+
+    QVector< Page * > pagesVector;
+    if ( !iface->reloadDocument( d->m_docFileName, pagesVector ) || pagesVector.isEmpty() )
+    {
+        qCDebug(OkularCoreDebug) << "Could not reload" << d->m_docFileName << "in place";
+        qDeleteAll( pagesVector );
+        closeDocument();
+        return false;
+    }
+
+    if ( d->m_url.isLocalFile() )
+    {
+        d->m_docSize = QFileInfo( d->m_docFileName ).size();
+        d->m_xmlFileName = DocumentPrivate::docDataFileName( d->m_url, d->m_docSize );
+    }
+    d->m_pageController = new PageController();
+    connect( d->m_pageController, SIGNAL(rotationFinished(int,Okular::Page*)),
+             this, SLOT(rotationFinished(int,Okular::Page*)) );
+
+    // the pages of the same size keep their pixmaps, shown until the new
+    // ones arrive; the unchanged ones keep them for good, and their text
+    const QVector< Page * > oldPages = d->m_pagesVector;
+    const bool pageDataPending = qobject_cast< PageDataInterface * >( d->m_generator ) != nullptr;
+    QVector< int > changedPages;
+    QBitArray unchangedPages( oldPages.count() );
+    for ( int i = 0; i < pagesVector.count(); ++i )
+    {
+        Page *page = pagesVector.at( i );
+        page->d->m_doc = d;
+        page->d->m_dataPending = pageDataPending;
+        page->d->rotateAt( d->m_rotation );
+
+        Page *oldPage = oldPages.value( i );
+        if ( !oldPage || ( oldPage->d->m_pixmaps.isEmpty() && oldPage->d->m_tilesManagers.isEmpty() && !oldPage->d->m_text ) )
+            continue;
+        if ( oldPage->orientation() != page->orientation() || oldPage->width() != page->width() || oldPage->height() != page->height() )
+            continue;
+
+        const QByteArray fingerprint = oldFingerprints.value( i );
+        const bool unchanged = !fingerprint.isEmpty() && iface->pageFingerprint( i ) == fingerprint;
+        page->d->adoptRenderData( oldPage->d, unchanged );
+        if ( unchanged )
+            unchangedPages.setBit( i );
+        else
+            changedPages.append( i );
+    }
+
+    // [MEM] forget what went away with the old pages
+    for ( int i = 0; i < oldPages.count(); ++i )
+    {
+        const PagePrivate *oldPage = oldPages.at( i )->d;
+        QSet< const DocumentObserver * > observers;
+        foreach ( DocumentObserver *observer, oldPage->m_pixmaps.keys() )
+            observers.insert( observer );
+        foreach ( const DocumentObserver *observer, oldPage->m_tilesManagers.keys() )
+            observers.insert( observer );
+        foreach ( const DocumentObserver *observer, observers )
+        {
+            AllocatedPixmap *pixmap = d->m_allocatedPixmaps.take( const_cast< DocumentObserver * >( observer ), i );
+            if ( pixmap )
+            {
+                d->m_allocatedPixmapsTotalMemory -= pixmap->memory;
+                delete pixmap;
+            }
+        }
+        if ( !unchangedPages.testBit( i ) )
+            d->m_compressedPixmaps.removePage( i );
+
+        if ( oldPage->m_text && d->m_allocatedTextPages.contains( i ) )
+            d->m_allocatedTextPagesTotalMemory -= d->m_allocatedTextPages.take( i );
+    }
+
+    d->m_pagesVector = pagesVector;
+    const int pageCount = pagesVector.count();
+
+    if ( d->m_synctex_scanner )
+    {
+        synctex_scanner_free( d->m_synctex_scanner );
+        d->m_synctex_scanner = nullptr;
+    }
+    d->m_synctex_scanner = synctex_scanner_new_with_output_file( QFile::encodeName( d->m_docFileName ).constData(), nullptr, 1 );
+    if ( !d->m_synctex_scanner && QFile::exists( d->m_docFileName + QLatin1String( "sync" ) ) )
+        d->loadSyncFile( d->m_docFileName );
+
+    bool containsExternalAnnotations = false;
+    foreach ( Page * p, d->m_pagesVector )
+    {
+        if ( !pageDataPending && !p->annotations().empty() )
+            containsExternalAnnotations = true;
+    }
+
+    d->m_showWarningLimitedAnnotSupport = false;
+    d->m_annotationsNeedSaveAs = d->canAddAnnotationsNatively() && containsExternalAnnotations;
+    for ( QDomElement pageElement = pageList.firstChildElement(); !pageElement.isNull(); pageElement = pageElement.nextSiblingElement() )
+    {
+        bool ok;
+        const int pageNumber = pageElement.attribute( QStringLiteral("number") ).toInt( &ok );
+        if ( ok && pageNumber >= 0 && pageNumber < pageCount )
+            d->m_pagesVector[ pageNumber ]->d->restoreLocalContents( pageElement );
+    }
+    d->m_showWarningLimitedAnnotSupport = true;
+
+    d->openRenderCaches();
+    d->openTextIndex();
+
+    // reset what was cached about the old document
+    QMap< int, RunningSearch * >::const_iterator rIt = d->m_searches.constBegin();
+    QMap< int, RunningSearch * >::const_iterator rEnd = d->m_searches.constEnd();
+    for ( ; rIt != rEnd; ++rIt )
+        delete *rIt;
+    d->m_searches.clear();
+    d->m_fontsCached = false;
+    d->m_fontsCache.clear();
+    d->m_documentInfo = DocumentInfo();
+    d->m_documentInfoAskedKeys.clear();
+    d->m_undoStack->clear();
+
+    QVector< VisiblePageRect * > pageRects;
+    foreach ( VisiblePageRect *rect, d->m_pageRects )
+    {
+        if ( rect->pageNumber < pageCount )
+            pageRects.append( rect );
+        else
+            delete rect;
+    }
+    d->m_pageRects = pageRects;
+
+    QLinkedList< DocumentViewport >::iterator vIt = d->m_viewportHistory.begin(), vEnd = d->m_viewportHistory.end();
+    for ( ; vIt != vEnd; ++vIt )
+    {
+        if ( (*vIt).pageNumber >= pageCount )
+            (*vIt).pageNumber = pageCount - 1;
+    }
+
+    // switch the observers to the new pages at once, they still used the
+    // old ones until now
+    foreachObserver( notifySetup( d->m_pagesVector, DocumentObserver::DocumentChanged | DocumentObserver::DocumentReloaded ) );
+    qDeleteAll( oldPages );
+
+    foreach ( int page, changedPages )
+        d->refreshPixmaps( page );
+
+    if ( pageDataPending )
+    {
+        d->m_nextPendingPageData = 0;
+        QMetaObject::invokeMethod( this, "doContinuePageDataLoading", Qt::QueuedConnection, Q_ARG(int, d->m_pageDataRun) );
+    }
+
+    const DocumentViewport viewport = *d->m_viewportIterator;
+    if ( viewport.isValid() )
+        setViewport( viewport );
+
+    d->runDocumentScripts();
+
+    qCDebug(OkularCoreDebug).nospace() << "Reloaded " << d->m_docFileName << " in " << timer.elapsed() << " ms, "
+        << changedPages.count() << " changed pages rendered again";
+    return true;
+}
+
+void DocumentPrivate::stopPageWork()
+{
+    // stop the searches and the indexing still extracting text from the pages
+    m_documentSearch.stop();
+    m_textIndex.close();
+    ++m_pageDataRun;
+    m_pagesWithLoadedData.clear();
+    foreach ( int searchID, m_searches.keys() )
+    {
+        if ( m_searches.value( searchID )->pagesPending > 0 )
+            finishDocumentSearch( searchID, Document::SearchCancelled );
+    }
+
+    delete m_pageController;
+    m_pageController = nullptr;
+
+     // remove requests left in queue
+    m_pixmapRequestsMutex.lock();
+    m_pixmapScheduler.clear();
+    qCDebug(OkularCoreDebug).nospace() << "Pixmap requests: " << m_pixmapScheduler.queuedCount() << " queued, "
+        << m_pixmapScheduler.coalescedCount() << " coalesced, " << m_pixmapScheduler.droppedCount() << " dropped";
+    m_pixmapScheduler.resetCounters();
+    m_pixmapRequestsMutex.unlock();
+
+    QEventLoop loop;
+    bool startEventLoop = false;
+    do
+    {
+        m_pixmapRequestsMutex.lock();
+        startEventLoop = !m_executingPixmapRequests.isEmpty();
+        m_pixmapRequestsMutex.unlock();
+        if ( startEventLoop )
+        {
+            m_closingLoop = &loop;
+            loop.exec();
+            m_closingLoop = nullptr;
+        }
+    }
+    while ( startEventLoop );
+
+    if ( m_fontThread )
+    {
+        QObject::disconnect( m_fontThread, nullptr, m_parent, nullptr );
+        m_fontThread->stopExtraction();
+        m_fontThread->wait();
+        m_fontThread = nullptr;
+    }
+}
+
 void Document::addObserver( DocumentObserver * pObserver )
 {
     Q_ASSERT( !d->m_observers.contains( pObserver ) );
@@ -2683,19 +3188,8 @@ void Document::removeObserver( DocumentObserver * pObserver )
             (*it)->deletePixmap( pObserver );
 
         // [MEM] free observer's allocation descriptors
-        QLinkedList< AllocatedPixmap * >::iterator aIt = d->m_allocatedPixmaps.begin();
-        QLinkedList< AllocatedPixmap * >::iterator aEnd = d->m_allocatedPixmaps.end();
-        while ( aIt != aEnd )
-        {
-            AllocatedPixmap * p = *aIt;
-            if ( p->observer == pObserver )
-            {
-                aIt = d->m_allocatedPixmaps.erase( aIt );
-                delete p;
-            }
-            else
-                ++aIt;
-        }
+        d->m_allocatedPixmapsTotalMemory -= d->m_allocatedPixmaps.removeObserver( pObserver );
+        d->m_compressedPixmaps.removeObserver( pObserver );
 
         // delete observer entry from the map
         d->m_observers.remove( pObserver );
@@ -2721,14 +3215,23 @@ void Document::reparseConfig()
         }
 
         // [MEM] remove allocation descriptors
-        qDeleteAll( d->m_allocatedPixmaps );
         d->m_allocatedPixmaps.clear();
         d->m_allocatedPixmapsTotalMemory = 0;
+        d->m_compressedPixmaps.clear();
+        d->m_diskRenderCache.clear();
+        d->m_thumbnailPipeline.clear();
 
         // send reload signals to observers
         foreachObserver( notifyContentsCleared( DocumentObserver::Pixmap ) );
     }
 
+    // the disk cache and the text index may have been switched on or off
+    if ( d->m_generator )
+    {
+        d->openRenderCaches();
+        d->openTextIndex();
+    }
+
     // free memory if in 'low' profile
     if ( SettingsCore::memoryLevel() == SettingsCore::EnumMemoryLevel::Low &&
          !d->m_allocatedPixmaps.isEmpty() && !d->m_pagesVector.isEmpty() )
@@ -2881,6 +3384,15 @@ void Document::setVisiblePageRects( const QVector< VisiblePageRect * > & visible
     for ( ; vIt != vEnd; ++vIt )
         delete *vIt;
     d->m_pageRects = visiblePageRects;
+
+    // the pages coming into view need their annotations, forms, ... now
+    foreach ( const VisiblePageRect *visibleRect, visiblePageRects )
+    {
+        Page *page = d->m_pagesVector.value( visibleRect->pageNumber );
+        if ( page )
+            page->d->loadPendingData();
+    }
+
     // notify change to all other (different from id) observers
     foreach(DocumentObserver *o, d->m_observers)
         if ( o != excludeObserver )
@@ -3109,7 +3621,6 @@ void Document::requestPixmaps( const QLinkedList< PixmapRequest * > & requests,
         return;
     }
 
-    // 1. [CLEAN STACK] remove previous requests of requesterID
     // FIXME This assumes all requests come from the same observer, that is true atm but not enforced anywhere
     DocumentObserver *requesterObserver = requests.first()->observer();
     QSet< int > requestedPages;
@@ -3120,21 +3631,27 @@ void Document::requestPixmaps( const QLinkedList< PixmapRequest * > & requests,
     }
     const bool removeAllPrevious = reqOptions & RemoveAllPrevious;
     d->m_pixmapRequestsMutex.lock();
-    QLinkedList< PixmapRequest * >::iterator sIt = d->m_pixmapRequestsStack.begin(), sEnd = d->m_pixmapRequestsStack.end();
-    while ( sIt != sEnd )
+    d->m_pixmapScheduler.setViewportPage( (*d->m_viewportIterator).pageNumber );
+
+    // 1. [CANCEL] tell the generator to stop rendering pages the requester
+    // doesn't want anymore; thumbnails still being looked for can always
+    // be given up
+    if ( removeAllPrevious && d->m_generator )
     {
-        if ( (*sIt)->observer() == requesterObserver
-             && ( removeAllPrevious || requestedPages.contains( (*sIt)->pageNumber() ) ) )
+        const bool canCancel = d->m_generator->hasFeature( Generator::SupportsCancelling );
+        foreach ( PixmapRequest *executing, d->m_executingPixmapRequests )
         {
-            // delete request and remove it from stack
-            delete *sIt;
-            sIt = d->m_pixmapRequestsStack.erase( sIt );
+            if ( ( canCancel || executing->d->mThumbnailLookup )
+                 && executing->observer() == requesterObserver && !requestedPages.contains( executing->pageNumber() ) )
+                executing->d->mShouldAbortRender.store( 1 );
         }
-        else
-            ++sIt;
     }
 
+    const bool lookForThumbnails = d->m_thumbnailPipeline.isOpen() && d->m_rotation == Rotation0;
+    const QString renderHints = lookForThumbnails ? d->diskRenderCacheHints() : QString();
+
     // 2. [ADD TO STACK] add requests to stack
+    QSet< PixmapRequest * > queuedRequests;
     QLinkedList< PixmapRequest * >::const_iterator rIt = requests.constBegin(), rEnd = requests.constEnd();
     for ( ; rIt != rEnd; ++rIt )
     {
@@ -3150,11 +3667,22 @@ void Document::requestPixmaps( const QLinkedList< PixmapRequest * > & requests,
 
         request->d->mPage = d->m_pagesVector.value( request->pageNumber() );
 
+        // [THUMBNAIL] thumbnails kept from an earlier session or embedded
+        // in the document are looked for before rendering them
+        if ( lookForThumbnails && request->isThumbnail() && request->asynchronous() && !request->isTile() && !request->d->mForce )
+        {
+            request->d->mThumbnailLookup = true;
+            d->m_executingPixmapRequests.push_back( request );
+            d->m_thumbnailPipeline.fetch( request, renderHints );
+            continue;
+        }
+
         if ( request->isTile() )
         {
             // Change the current request rect so that only invalid tiles are
             // requested. Also make sure the rect is tile-aligned.
             NormalizedRect tilesRect;
+            request->d->tilesManager()->setViewportSize( request->normalizedRect().geometry( request->width(), request->height() ).size() );
             const QList<Tile> tiles = request->d->tilesManager()->tilesAt( request->normalizedRect(), TilesManager::TerminalTile );
             QList<Tile>::const_iterator tIt = tiles.constBegin(), tEnd = tiles.constEnd();
             while ( tIt != tEnd )
@@ -3173,22 +3701,42 @@ void Document::requestPixmaps( const QLinkedList< PixmapRequest * > & requests,
 
             request->setNormalizedRect( tilesRect );
         }
+        else if ( ( request->d->mFeatures & PixmapRequest::Progressive ) && request->asynchronous() && d->m_generator->hasFeature( Generator::Threaded ) )
+        {
+            // [PROGRESSIVE] unless something close enough can be shown
+            // meanwhile, a cheap preview goes first
+            const int previewWidth = qMax( request->width() / 4, 1 );
+            const int previewHeight = qMax( request->height() / 4, 1 );
+            const QPixmap *nearest = request->page()->_o_nearestPixmap( request->observer(), previewWidth, previewHeight );
+            if ( !request->d->tilesManager() && ( !nearest || nearest->width() < previewWidth ) )
+            {
+                PixmapRequest * preview = new PixmapRequest( request->observer(), request->pageNumber(), 0, 0, request->priority(), PixmapRequest::Asynchronous );
+                preview->d->mWidth = previewWidth;
+                preview->d->mHeight = previewHeight;
+                preview->d->mPage = request->page();
+                preview->d->mPreview = true;
+                d->m_pixmapScheduler.enqueue( preview );
+                queuedRequests.insert( preview );
+            }
+        }
 
         if ( !request->asynchronous() )
             request->d->mPriority = 0;
 
-        // add request to the 'stack' at the right place
-        if ( !request->priority() )
-            // add priority zero requests to the top of the stack
-            d->m_pixmapRequestsStack.append( request );
-        else
+        // add request to the queue, merging it with an identical one
+        d->m_pixmapScheduler.enqueue( request );
+        queuedRequests.insert( request );
+    }
+
+    // 2b. [CLEAN STACK] remove previous requests of requesterID; those
+    // asked for again were merged with the new ones above
+    foreach ( PixmapRequest *queued, d->m_pixmapScheduler.requests() )
+    {
+        if ( queued->observer() == requesterObserver && !queuedRequests.contains( queued )
+             && ( removeAllPrevious || requestedPages.contains( queued->pageNumber() ) ) )
         {
-            // insert in stack sorted by priority
-            sIt = d->m_pixmapRequestsStack.begin();
-            sEnd = d->m_pixmapRequestsStack.end();
-            while ( sIt != sEnd && (*sIt)->priority() > request->priority() )
-                ++sIt;
-            d->m_pixmapRequestsStack.insert( sIt, request );
+            // delete request and remove it from the queue
+            d->m_pixmapScheduler.drop( queued );
         }
     }
     d->m_pixmapRequestsMutex.unlock();
@@ -3201,19 +3749,34 @@ void Document::requestPixmaps( const QLinkedList< PixmapRequest * > & requests,
         d->sendGeneratorPixmapRequest();
 }
 
+QVariantMap Document::pixmapRequestStatistics() const
+{
+    QVariantMap statistics;
+    d->m_pixmapRequestsMutex.lock();
+    statistics.insert( QStringLiteral( "queued" ), d->m_pixmapScheduler.queuedCount() );
+    statistics.insert( QStringLiteral( "coalesced" ), d->m_pixmapScheduler.coalescedCount() );
+    statistics.insert( QStringLiteral( "dropped" ), d->m_pixmapScheduler.droppedCount() );
+    d->m_pixmapRequestsMutex.unlock();
+    return statistics;
+}
+
 void Document::requestTextPage( uint page )
 {
     Page * kp = d->m_pagesVector[ page ];
     if ( !d->m_generator || !kp )
         return;
 
-    // Memory management for TextPages
-
+    // Memory management for TextPages: the new text page is accounted for
+    // in textGenerationDone(), which evicts others if needed
     d->m_generator->generateTextPage( kp );
 }
 
 void DocumentPrivate::notifyAnnotationChanges( int page )
 {
+    // told once all the data of the page is loaded
+    if ( m_loadingPageData )
+        return;
+
     int flags = DocumentObserver::Annotations;
 
     if ( m_annotationsNeedSaveAs )
@@ -3482,6 +4045,8 @@ void Document::setViewport( const DocumentViewport & viewport, DocumentObserver
     const int currentViewportPage = (*d->m_viewportIterator).pageNumber;
 
     const bool currentPageChanged = (oldPageNumber != currentViewportPage);
+    if ( currentPageChanged )
+        ++d->m_pixmapLookupRound;
 
     // notify change to all other (different from id) observers
     foreach(DocumentObserver *o, d->m_observers)
@@ -3511,6 +4076,7 @@ void Document::setPrevViewport()
 
         // restore previous viewport and notify it to observers
         --d->m_viewportIterator;
+        ++d->m_pixmapLookupRound;
         foreachObserver( notifyViewportChanged( true ) );
 
         const int currentViewportPage = (*d->m_viewportIterator).pageNumber;
@@ -3530,6 +4096,7 @@ void Document::setNextViewport()
 
         // restore next viewport and notify it to observers
         ++d->m_viewportIterator;
+        ++d->m_pixmapLookupRound;
         foreachObserver( notifyViewportChanged( true ) );
 
         const int currentViewportPage = (*d->m_viewportIterator).pageNumber;
@@ -3550,11 +4117,22 @@ void Document::setNextDocumentDestination( const QString &namedDestination )
 
 void Document::searchText( int searchID, const QString & text, bool fromStart, Qt::CaseSensitivity caseSensitivity,
                                SearchType type, bool moveViewport, const QColor & color )
+{
+    searchText( searchID, text, fromStart, caseSensitivity, type, moveViewport, color, NoSearchOption );
+}
+
+void Document::searchText( int searchID, const QString & text, bool fromStart, Qt::CaseSensitivity caseSensitivity,
+                               SearchType type, bool moveViewport, const QColor & color, SearchOptions options )
 {
     d->m_searchCancelled = false;
 
-    // safety checks: don't perform searches on empty or unsearchable docs
-    if ( !d->m_generator || !d->m_generator->hasFeature( Generator::TextExtraction ) || d->m_pagesVector.isEmpty() )
+    // compiled once, not for every page
+    const SearchPattern pattern( text, caseSensitivity, options );
+
+    // safety checks: don't perform searches on empty or unsearchable docs,
+    // nor with a broken regular expression
+    if ( !d->m_generator || !d->m_generator->hasFeature( Generator::TextExtraction ) || d->m_pagesVector.isEmpty()
+         || ( ( options & RegularExpressionSearchOption ) && !pattern.isValid() ) )
     {
         emit searchFinished( searchID, NoMatchFound );
         return;
@@ -3566,15 +4144,29 @@ void Document::searchText( int searchID, const QString & text, bool fromStart, Q
     {
         RunningSearch * search = new RunningSearch();
         search->continueOnPage = -1;
+        search->pagesPending = 0;
+        search->documentSearchRun = 0;
+        search->cachedOptions = NoSearchOption;
         searchIt = d->m_searches.insert( searchID, search );
     }
     RunningSearch * s = *searchIt;
 
+    // a whole document search still running is superseded by this one
+    if ( s->pagesPending > 0 )
+    {
+        d->m_documentSearch.cancel( searchID );
+        s->pagesToSearch.clear();
+        s->pagesPending = 0;
+        QApplication::restoreOverrideCursor();
+    }
+
     // update search structure
-    bool newText = text != s->cachedString;
+    bool newText = text != s->cachedString || caseSensitivity != s->cachedCaseSensitivity || options != s->cachedOptions;
     s->cachedString = text;
     s->cachedType = type;
     s->cachedCaseSensitivity = caseSensitivity;
+    s->cachedOptions = options;
+    s->pattern = pattern;
     s->cachedViewportMove = moveViewport;
     s->cachedColor = color;
     s->isCurrentlySearching = true;
@@ -3594,10 +4186,17 @@ void Document::searchText( int searchID, const QString & text, bool fromStart, Q
     // 1. ALLDOC - proces all document marking pages
     if ( type == AllDocument )
     {
-        QMap< Page *, QVector<RegularAreaRect *> > *pageMatches = new QMap< Page *, QVector<RegularAreaRect *> >;
+        // the pages lost their highlights, the new ones come page by page
+        foreach ( int pageNumber, *pagesToNotify )
+            foreachObserver( notifyPageChanged( pageNumber, DocumentObserver::Highlights ) );
+        delete pagesToNotify;
 
         // search and highlight 'text' (as a solid phrase) on all pages
-        QMetaObject::invokeMethod(this, "doContinueAllDocumentSearch", Qt::QueuedConnection, Q_ARG(void *, pagesToNotify), Q_ARG(void *, pageMatches), Q_ARG(int, 0), Q_ARG(int, searchID));
+        SearchTerm term;
+        term.text = text;
+        term.color = color;
+        term.pattern = pattern;
+        d->startDocumentSearch( searchID, QVector< SearchTerm >() << term, false );
     }
     // 2. NEXTMATCH - find next matching item (or start from top)
     // 3. PREVMATCH - find previous matching item (or start from bottom)
@@ -3616,9 +4215,9 @@ void Document::searchText( int searchID, const QString & text, bool fromStart, Q
         if ( lastPage && lastPage->number() == s->continueOnPage )
         {
             if ( newText )
-                match = lastPage->findText( searchID, text, forward ? FromTop : FromBottom, caseSensitivity );
+                match = lastPage->d->findText( searchID, s->pattern, forward ? FromTop : FromBottom );
             else
-                match = lastPage->findText( searchID, text, forward ? NextResult : PreviousResult, caseSensitivity, &s->continueOnMatch );
+                match = lastPage->d->findText( searchID, s->pattern, forward ? NextResult : PreviousResult );
             if ( !match )
             {
                 if (forward) currentPage++;
@@ -3629,6 +4228,11 @@ void Document::searchText( int searchID, const QString & text, bool fromStart, Q
 
         s->pagesDone = pagesDone;
 
+        SearchTerm term;
+        term.text = text;
+        term.pattern = s->pattern;
+        s->candidatePages = d->textIndexCandidates( QVector< SearchTerm >() << term, false );
+
         DoContinueDirectionMatchSearchStruct *searchStruct = new DoContinueDirectionMatchSearchStruct();
         searchStruct->pagesToNotify = pagesToNotify;
         searchStruct->match = match;
@@ -3640,11 +4244,32 @@ void Document::searchText( int searchID, const QString & text, bool fromStart, Q
     // 4. GOOGLE* - process all document marking pages
     else if ( type == GoogleAll || type == GoogleAny )
     {
-        QMap< Page *, QVector< QPair<RegularAreaRect *, QColor> > > *pageMatches = new QMap< Page *, QVector<QPair<RegularAreaRect *, QColor> > >;
-        const QStringList words = text.split( QLatin1Char ( ' ' ), QString::SkipEmptyParts );
+        // the pages lost their highlights, the new ones come page by page
+        foreach ( int pageNumber, *pagesToNotify )
+            foreachObserver( notifyPageChanged( pageNumber, DocumentObserver::Highlights ) );
+        delete pagesToNotify;
 
-        // search and highlight every word in 'text' on all pages
-        QMetaObject::invokeMethod(this, "doContinueGooglesDocumentSearch", Qt::QueuedConnection, Q_ARG(void *, pagesToNotify), Q_ARG(void *, pageMatches), Q_ARG(int, 0), Q_ARG(int, searchID), Q_ARG(QStringList, words));
+        const QStringList words = text.split( QLatin1Char ( ' ' ), QString::SkipEmptyParts );
+        const int wordCount = words.count();
+        const int hueStep = (wordCount > 1) ? (60 / (wordCount - 1)) : 60;
+        int baseHue, baseSat, baseVal;
+        color.getHsv( &baseHue, &baseSat, &baseVal );
+
+        // search and highlight every word in 'text' on all pages, each
+        // word with its own color
+        QVector< SearchTerm > terms;
+        for ( int w = 0; w < wordCount; w++ )
+        {
+            int newHue = baseHue - w * hueStep;
+            if ( newHue < 0 )
+                newHue += 360;
+            SearchTerm term;
+            term.text = words[ w ];
+            term.color = QColor::fromHsv( newHue, baseSat, baseVal );
+            term.pattern = SearchPattern( words[ w ], caseSensitivity, options );
+            terms.append( term );
+        }
+        d->startDocumentSearch( searchID, terms, type == GoogleAll );
     }
 }
 
@@ -3662,7 +4287,7 @@ void Document::continueSearch( int searchID )
     RunningSearch * p = *it;
     if ( !p->isCurrentlySearching )
         searchText( searchID, p->cachedString, false, p->cachedCaseSensitivity,
-                    p->cachedType, p->cachedViewportMove, p->cachedColor );
+                    p->cachedType, p->cachedViewportMove, p->cachedColor, p->cachedOptions );
 }
 
 void Document::continueSearch( int searchID, SearchType type )
@@ -3679,7 +4304,7 @@ void Document::continueSearch( int searchID, SearchType type )
     RunningSearch * p = *it;
     if ( !p->isCurrentlySearching )
         searchText( searchID, p->cachedString, false, p->cachedCaseSensitivity,
-                    type, p->cachedViewportMove, p->cachedColor );
+                    type, p->cachedViewportMove, p->cachedColor, p->cachedOptions );
 }
 
 void Document::resetSearch( int searchID )
@@ -3696,6 +4321,9 @@ void Document::resetSearch( int searchID )
     // get previous parameters for search
     RunningSearch * s = *searchIt;
 
+    if ( s->pagesPending > 0 )
+        d->finishDocumentSearch( searchID, SearchCancelled );
+
     // unhighlight pages and inform observers about that
     foreach(int pageNumber, s->highlightedPages)
     {
@@ -3714,6 +4342,13 @@ void Document::resetSearch( int searchID )
 void Document::cancelSearch()
 {
     d->m_searchCancelled = true;
+
+    // whole document searches may have nothing left to run here, end them now
+    foreach ( int searchID, d->m_searches.keys() )
+    {
+        if ( d->m_searches.value( searchID )->pagesPending > 0 )
+            d->finishDocumentSearch( searchID, SearchCancelled );
+    }
 }
 
 void Document::undo()
@@ -4178,6 +4813,8 @@ bool Document::supportsPrintToFile() const
 
 bool Document::print( QPrinter &printer )
 {
+    // the annotations of all the pages get printed
+    d->loadAllPageData();
     return d->m_generator ? d->m_generator->print( printer ) : false;
 }
 
@@ -4371,6 +5008,8 @@ bool Document::saveChanges( const QString &fileName, QString *errorText )
     if ( !saveIface || !saveIface->supportsOption( SaveInterface::SaveChanges ) )
         return false;
 
+    // the local annotations and forms of all the pages get saved
+    d->loadAllPageData();
     return saveIface->save( fileName, SaveInterface::SaveChanges, errorText );
 }
 
@@ -4641,6 +5280,193 @@ QAbstractItemModel * Document::layersModel() const
     return d->m_generator ? d->m_generator->layersModel() : nullptr;
 }
 
+void DocumentPrivate::openRenderCaches()
+{
+    m_diskRenderCache.close();
+    m_thumbnailPipeline.close();
+
+    // the docdata name covers the path and size of the file, the time and
+    // generator cover the rest of what makes a render stale
+    QString identity;
+    if ( !m_xmlFileName.isEmpty() )
+    {
+        const QFileInfo docInfo( m_docFileName );
+        QCryptographicHash hash( QCryptographicHash::Sha1 );
+        hash.addData( QFileInfo( m_xmlFileName ).fileName().toUtf8() );
+        hash.addData( QByteArray::number( docInfo.lastModified().toMSecsSinceEpoch() ) );
+        hash.addData( m_generatorName.toUtf8() );
+        identity = QString::fromLatin1( hash.result().toHex() );
+    }
+
+    if ( SettingsCore::diskRenderCache() && !identity.isEmpty() )
+        m_diskRenderCache.open( identity, (qulonglong)SettingsCore::diskRenderCacheSize() * 1024 * 1024 );
+
+    // the thumbnails are looked for in the background, so the generator has
+    // to be able to work from another thread to give the embedded ones
+    ThumbnailInterface *thumbnailInterface = nullptr;
+    if ( m_generator->hasFeature( Generator::Threaded ) )
+        thumbnailInterface = qobject_cast< ThumbnailInterface * >( m_generator );
+    m_thumbnailPipeline.open( SettingsCore::thumbnailCache() ? identity : QString(),
+                              (qulonglong)SettingsCore::thumbnailCacheSize() * 1024 * 1024, thumbnailInterface );
+}
+
+void DocumentPrivate::openTextIndex()
+{
+    // the index is built with background text extraction
+    if ( !SettingsCore::textIndex() || m_xmlFileName.isEmpty() || !m_generator->hasFeature( Generator::TextExtraction )
+         || !m_generator->hasFeature( Generator::Threaded ) )
+    {
+        m_textIndex.close();
+        return;
+    }
+
+    const QString fileName = TextIndex::fileName( m_xmlFileName );
+    if ( m_textIndex.fileName() == fileName )
+        return;
+
+    m_textIndex.open( fileName, QFileInfo( m_docFileName ).lastModified().toMSecsSinceEpoch(), m_generator, m_pagesVector );
+}
+
+QVector< bool > DocumentPrivate::textIndexCandidates( const QVector< SearchTerm > &terms, bool matchAll ) const
+{
+    if ( !m_textIndex.isReady() )
+        return QVector< bool >();
+
+    QVector< bool > candidates;
+    foreach ( const SearchTerm &term, terms )
+    {
+        // the index only knows the words as they are written
+        const bool indexable = !( term.pattern.options() & ( RegularExpressionSearchOption | IgnoreAccentsSearchOption ) );
+        const QVector< bool > termPages = indexable ? m_textIndex.candidatePages( term.text ) : QVector< bool >();
+        if ( termPages.isEmpty() )
+        {
+            // the index cannot tell where this term is
+            if ( matchAll )
+                continue;
+            return QVector< bool >();
+        }
+
+        if ( candidates.isEmpty() )
+        {
+            candidates = termPages;
+            continue;
+        }
+        for ( int i = 0; i < candidates.count(); ++i )
+            candidates[ i ] = matchAll ? candidates.at( i ) && termPages.at( i ) : candidates.at( i ) || termPages.at( i );
+    }
+    return candidates;
+}
+
+bool DocumentPrivate::hasUnsavedEdits() const
+{
+    return !m_undoStack->isClean();
+}
+
+QString DocumentPrivate::diskRenderCacheHints() const
+{
+    return documentMetaData( Generator::PaperColorMetaData, true ).value< QColor >().name() + QLatin1Char( ';' ) +
+           QString::number( documentMetaData( Generator::TextAntialiasMetaData, QVariant() ).toBool() ) +
+           QString::number( documentMetaData( Generator::GraphicsAntialiasMetaData, QVariant() ).toBool() ) +
+           QString::number( documentMetaData( Generator::TextHintingMetaData, QVariant() ).toBool() );
+}
+
+void DocumentPrivate::compressedPixmapRetrieved( PixmapRequest * req, const QImage &image, Rotation rotation )
+{
+    if ( m_generator && !m_closingLoop && ( image.isNull() || rotation != m_rotation ) )
+    {
+        // the compressed copy is of no use, render the page instead
+        m_pixmapRequestsMutex.lock();
+        m_executingPixmapRequests.removeAll( req );
+        m_pixmapScheduler.enqueue( req );
+        m_pixmapRequestsMutex.unlock();
+        sendGeneratorPixmapRequest();
+        return;
+    }
+
+    if ( m_generator && !m_closingLoop && !req->shouldAbortRender() )
+    {
+        // the image is already rotated, do not go through Page::setPixmap()
+        PagePrivate *pagePrivate = req->page()->d;
+        QMap< DocumentObserver*, PagePrivate::PixmapObject >::iterator it = pagePrivate->m_pixmaps.find( req->observer() );
+        const qint64 pixmapKey = it != pagePrivate->m_pixmaps.end() ? it.value().m_pixmap->cacheKey() : 0;
+        if ( pixmapKey != req->d->mPixmapKey )
+        {
+            // a newer pixmap arrived while decompressing, keep it and
+            // drop the request as a cancelled one
+            req->d->mShouldAbortRender.store( 1 );
+            requestDone( req );
+            return;
+        }
+
+        if ( it != pagePrivate->m_pixmaps.end() )
+            delete it.value().m_pixmap;
+        else
+            it = pagePrivate->m_pixmaps.insert( req->observer(), PagePrivate::PixmapObject() );
+        it.value().m_pixmap = new QPixmap( QPixmap::fromImage( image ) );
+        it.value().m_rotation = rotation;
+    }
+
+    requestDone( req );
+}
+
+void DocumentPrivate::diskRenderRetrieved( PixmapRequest * req, const QImage &image, Rotation rotation )
+{
+    if ( m_generator && !m_closingLoop && ( image.isNull() || rotation != m_rotation ) )
+    {
+        // the render on disk is of no use, render the page instead
+        m_pixmapRequestsMutex.lock();
+        m_executingPixmapRequests.removeAll( req );
+        m_pixmapScheduler.enqueue( req );
+        m_pixmapRequestsMutex.unlock();
+        sendGeneratorPixmapRequest();
+        return;
+    }
+
+    if ( m_generator && !m_closingLoop && !req->shouldAbortRender() )
+    {
+        // the image is already rotated, it does not go through Page::setPixmap()
+        PagePrivate *pagePrivate = req->page()->d;
+        QMap< DocumentObserver*, PagePrivate::PixmapObject >::iterator it = pagePrivate->m_pixmaps.find( req->observer() );
+        if ( it != pagePrivate->m_pixmaps.end() )
+            delete it.value().m_pixmap;
+        else
+            it = pagePrivate->m_pixmaps.insert( req->observer(), PagePrivate::PixmapObject() );
+        it.value().m_pixmap = new QPixmap( QPixmap::fromImage( image ) );
+        it.value().m_rotation = rotation;
+    }
+
+    requestDone( req );
+}
+
+void DocumentPrivate::thumbnailFetched( PixmapRequest * req, const QImage &image )
+{
+    if ( m_generator && !m_closingLoop && !req->shouldAbortRender() && ( image.isNull() || m_rotation != Rotation0 ) )
+    {
+        // neither kept nor embedded, render the thumbnail instead
+        req->d->mThumbnailLookup = false;
+        m_pixmapRequestsMutex.lock();
+        m_executingPixmapRequests.removeAll( req );
+        m_pixmapScheduler.enqueue( req );
+        m_pixmapRequestsMutex.unlock();
+        sendGeneratorPixmapRequest();
+        return;
+    }
+
+    if ( m_generator && !m_closingLoop && !req->shouldAbortRender() )
+    {
+        PagePrivate *pagePrivate = req->page()->d;
+        QMap< DocumentObserver*, PagePrivate::PixmapObject >::iterator it = pagePrivate->m_pixmaps.find( req->observer() );
+        if ( it != pagePrivate->m_pixmaps.end() )
+            delete it.value().m_pixmap;
+        else
+            it = pagePrivate->m_pixmaps.insert( req->observer(), PagePrivate::PixmapObject() );
+        it.value().m_pixmap = new QPixmap( QPixmap::fromImage( image ) );
+        it.value().m_rotation = Rotation0;
+    }
+
+    requestDone( req );
+}
+
 void DocumentPrivate::requestDone( PixmapRequest * req )
 {
     if ( !req )
@@ -4662,18 +5488,55 @@ void DocumentPrivate::requestDone( PixmapRequest * req )
         qCDebug(OkularCoreDebug) << "requestDone with generator not in READY state.";
 #endif
 
+    if ( req->shouldAbortRender() )
+    {
+        // the render was cancelled, nothing was stored in the page
+        TilesManager *tm = req->d->tilesManager();
+        if ( tm )
+            tm->setRequest( NormalizedRect(), 0, 0 );
+
+        m_pixmapRequestsMutex.lock();
+        m_executingPixmapRequests.removeAll( req );
+        const bool hasPixmaps = !m_pixmapScheduler.isEmpty();
+        m_pixmapRequestsMutex.unlock();
+        delete req;
+
+        if ( hasPixmaps )
+            sendGeneratorPixmapRequest();
+        return;
+    }
+
+    int renderTime = req->d->mRenderTimer.isValid() ? req->d->mRenderTimer.elapsed() : 0;
+
+    // keep whole unrotated pages for the next sessions, unless they show
+    // edits that may never be saved; rotated views turn them once loaded
+    if ( m_diskRenderCache.isOpen() && !req->isTile() && !req->isPreview() && !req->isThumbnail() && m_rotation == Rotation0 && !hasUnsavedEdits() )
+    {
+        const PagePrivate *pagePrivate = req->page()->d;
+        QMap< DocumentObserver*, PagePrivate::PixmapObject >::const_iterator it = pagePrivate->m_pixmaps.constFind( req->observer() );
+        if ( it != pagePrivate->m_pixmaps.constEnd() && it.value().m_pixmap->width() == req->width() && it.value().m_pixmap->height() == req->height() )
+            m_diskRenderCache.store( req->pageNumber(), *it.value().m_pixmap, diskRenderCacheHints() );
+    }
+
+    // and the thumbnails that were not found before rendering them
+    if ( req->isThumbnail() && !req->d->mThumbnailLookup && !req->isTile() && m_rotation == Rotation0 && !hasUnsavedEdits() )
+    {
+        const PagePrivate *pagePrivate = req->page()->d;
+        QMap< DocumentObserver*, PagePrivate::PixmapObject >::const_iterator it = pagePrivate->m_pixmaps.constFind( req->observer() );
+        if ( it != pagePrivate->m_pixmaps.constEnd() && it.value().m_pixmap->width() == req->width() && it.value().m_pixmap->height() == req->height() )
+            m_thumbnailPipeline.store( req->pageNumber(), *it.value().m_pixmap, diskRenderCacheHints() );
+    }
+
     // [MEM] 1.1 find and remove a previous entry for the same page and id
-    QLinkedList< AllocatedPixmap * >::iterator aIt = m_allocatedPixmaps.begin();
-    QLinkedList< AllocatedPixmap * >::iterator aEnd = m_allocatedPixmaps.end();
-    for ( ; aIt != aEnd; ++aIt )
-        if ( (*aIt)->page == req->pageNumber() && (*aIt)->observer == req->observer() )
-        {
-            AllocatedPixmap * p = *aIt;
-            m_allocatedPixmaps.erase( aIt );
-            m_allocatedPixmapsTotalMemory -= p->memory;
-            delete p;
-            break;
-        }
+    AllocatedPixmap * previousPixmap = m_allocatedPixmaps.take( req->observer(), req->pageNumber() );
+    if ( previousPixmap )
+    {
+        // a tiled page costs the time of all its tiles
+        if ( req->isTile() )
+            renderTime += previousPixmap->renderTime;
+        m_allocatedPixmapsTotalMemory -= previousPixmap->memory;
+        delete previousPixmap;
+    }
 
     DocumentObserver *observer = req->observer();
     if ( m_observers.contains(observer) )
@@ -4686,8 +5549,8 @@ void DocumentPrivate::requestDone( PixmapRequest * req )
         else
             memoryBytes = 4 * req->width() * req->height();
 
-        AllocatedPixmap * memoryPage = new AllocatedPixmap( req->observer(), req->pageNumber(), memoryBytes );
-        m_allocatedPixmaps.append( memoryPage );
+        AllocatedPixmap * memoryPage = new AllocatedPixmap( req->observer(), req->pageNumber(), memoryBytes, renderTime );
+        m_allocatedPixmaps.insert( memoryPage );
         m_allocatedPixmapsTotalMemory += memoryBytes;
 
         // 2. notify an observer that its pixmap changed
@@ -4706,7 +5569,7 @@ void DocumentPrivate::requestDone( PixmapRequest * req )
 
     // 4. start a new generation if some is pending
     m_pixmapRequestsMutex.lock();
-    bool hasPixmaps = !m_pixmapRequestsStack.isEmpty();
+    bool hasPixmaps = !m_pixmapScheduler.isEmpty();
     m_pixmapRequestsMutex.unlock();
     if ( hasPixmaps )
         sendGeneratorPixmapRequest();
@@ -4759,18 +5622,14 @@ void DocumentPrivate::textGenerationDone( Page *page )
 {
     if ( !m_pageController ) return;
 
-    // 1. If we reached the cache limit, delete the first text page from the fifo
-    if (m_allocatedTextPagesFifo.size() == m_maxAllocatedTextPages)
-    {
-        int pageToKick = m_allocatedTextPagesFifo.takeFirst();
-        if (pageToKick != page->number()) // this should never happen but better be safe than sorry
-        {
-            m_pagesVector.at(pageToKick)->setTextPage( nullptr ); // deletes the textpage
-        }
-    }
+    // 1. Account for the new text page
+    const qulonglong memory = page->d->textPageMemory();
+    m_allocatedTextPagesTotalMemory -= m_allocatedTextPages.value( page->number() );
+    m_allocatedTextPagesTotalMemory += memory;
+    m_allocatedTextPages.insert( page->number(), memory );
 
-    // 2. Add the page to the fifo of generated text pages
-    m_allocatedTextPagesFifo.append( page->number() );
+    // 2. If we are over the cache limits, evict the farthest text pages
+    cleanupTextPageMemory( page->number() );
 }
 
 void Document::setRotation( int r )
@@ -4784,6 +5643,8 @@ void DocumentPrivate::setRotationInternal( int r, bool notify )
     if ( !m_generator || ( m_rotation == rotation ) )
 	return;
 
+    m_compressedPixmaps.clear();
+
     // tell the pages to rotate
     QVector< Okular::Page * >::const_iterator pIt = m_pagesVector.constBegin();
     QVector< Okular::Page * >::const_iterator pEnd = m_pagesVector.constEnd();
@@ -4822,9 +5683,11 @@ void Document::setPageSize( const PageSize &size )
     for ( ; pIt != pEnd; ++pIt )
         (*pIt)->d->changeSize( size );
     // clear 'memory allocation' descriptors
-    qDeleteAll( d->m_allocatedPixmaps );
     d->m_allocatedPixmaps.clear();
     d->m_allocatedPixmapsTotalMemory = 0;
+    d->m_compressedPixmaps.clear();
+    d->m_diskRenderCache.clear();
+    d->m_thumbnailPipeline.clear();
     // notify the generator that the current page size has changed
     d->m_generator->pageSizeChanged( size, d->m_pageSize );
     // set the new page size
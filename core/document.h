@@ -18,6 +18,7 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QStringList>
+#include <QtCore/QVariant>
 #include <QtCore/QVector>
 #include <QtPrintSupport/QPrinter>
 #include <QtXml/QDomDocument>
@@ -223,6 +224,30 @@ class OKULARCORE_EXPORT Document : public QObject
          */
         void closeDocument();
 
+        /**
+         * Loads the document again from its file, which changed on disk,
+         * keeping the pixmaps and text of the pages that look the same as
+         * before. The observers are set up with the new pages in one go,
+         * with the DocumentChanged and DocumentReloaded flags, without
+         * going through an empty document.
+         *
+         * Returns false if the generator cannot reload this way, or if the
+         * reload failed; in the latter case the document is closed.
+         *
+         * @since 1.3
+         */
+        bool reloadDocumentFile();
+
+        /**
+         * Sets whether the document may be reloaded with
+         * reloadDocumentFile() when its file changes, e.g. because the file
+         * is watched. The generator may keep what a reload needs only then;
+         * it applies to the documents opened from now on.
+         *
+         * @since 1.3
+         */
+        void setReloadable( bool reloadable );
+
         /**
          * Registers a new @p observer for the document.
          */
@@ -484,6 +509,16 @@ class OKULARCORE_EXPORT Document : public QObject
          */
         void requestPixmaps( const QLinkedList<PixmapRequest*> &requests, PixmapRequestFlags reqOptions );
 
+        /**
+         * Returns how many pixmap requests, since the document was opened,
+         * entered the queue ("queued"), replaced an identical request
+         * waiting in it ("coalesced") and left it without being rendered
+         * ("dropped").
+         *
+         * @since 1.3
+         */
+        QVariantMap pixmapRequestStatistics() const;
+
         /**
          * Sends a request for text page generation for the given page @p number.
          */
@@ -630,6 +665,16 @@ class OKULARCORE_EXPORT Document : public QObject
         void searchText( int searchID, const QString & text, bool fromStart, Qt::CaseSensitivity caseSensitivity,
                          SearchType type, bool moveViewport, const QColor & color );
 
+        /**
+         * Searches the given @p text in the document, as the other
+         * searchText() does, with the given search @p options: whole words
+         * only, ignoring the accents, or @p text being a regular expression.
+         *
+         * @since 1.3
+         */
+        void searchText( int searchID, const QString & text, bool fromStart, Qt::CaseSensitivity caseSensitivity,
+                         SearchType type, bool moveViewport, const QColor & color, SearchOptions options );
+
         /**
          * Continues the search for the given @p searchID.
          */
@@ -1139,8 +1184,11 @@ class OKULARCORE_EXPORT Document : public QObject
 
         // search thread simulators
         Q_PRIVATE_SLOT( d, void doContinueDirectionMatchSearch(void *doContinueDirectionMatchSearchStruct) )
-        Q_PRIVATE_SLOT( d, void doContinueAllDocumentSearch(void *pagesToNotifySet, void *pageMatchesMap, int currentPage, int searchID) )
-        Q_PRIVATE_SLOT( d, void doContinueGooglesDocumentSearch(void *pagesToNotifySet, void *pageMatchesMap, int currentPage, int searchID, const QStringList & words) )
+        Q_PRIVATE_SLOT( d, void doContinueDocumentSearch(int searchID, int run) )
+
+        // page data loading
+        Q_PRIVATE_SLOT( d, void doContinuePageDataLoading(int run) )
+        Q_PRIVATE_SLOT( d, void notifyPageDataLoaded() )
 };
 
 
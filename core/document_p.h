@@ -27,6 +27,14 @@
 // local includes
 #include "fontinfo.h"
 #include "generator.h"
+#include "compressedpixmapcache_p.h"
+#include "diskrendercache_p.h"
+#include "documentsearch_p.h"
+#include "memorybudget_p.h"
+#include "pixmapevictionindex_p.h"
+#include "pixmapscheduler_p.h"
+#include "textindex_p.h"
+#include "thumbnailpipeline_p.h"
 
 class QUndoStack;
 class QEventLoop;
@@ -35,7 +43,6 @@ class QTimer;
 class QTemporaryFile;
 class KPluginMetaData;
 
-struct AllocatedPixmap;
 struct ArchiveData;
 struct RunningSearch;
 
@@ -82,6 +89,10 @@ class DocumentPrivate
             m_tempFile( nullptr ),
             m_docSize( -1 ),
             m_allocatedPixmapsTotalMemory( 0 ),
+            m_pixmapCacheHits( 0 ),
+            m_pixmapCacheMisses( 0 ),
+            m_pixmapLookupRound( 1 ),
+            m_allocatedTextPagesTotalMemory( 0 ),
             m_maxAllocatedTextPages( 0 ),
             m_warnedOutOfMemory( false ),
             m_rotation( Rotation0 ),
@@ -99,6 +110,10 @@ class DocumentPrivate
             m_fontsCached( false ),
             m_annotationEditingEnabled ( true ),
             m_annotationBeingModified( false ),
+            m_reloadable( false ),
+            m_loadingPageData( false ),
+            m_pageDataRun( 0 ),
+            m_nextPendingPageData( 0 ),
             m_synctex_scanner( nullptr )
         {
             calculateMaxTextPages();
@@ -111,10 +126,25 @@ class DocumentPrivate
         qulonglong calculateMemoryToFree();
         void cleanupPixmapMemory();
         void cleanupPixmapMemory( qulonglong memoryToFree );
+        void updatePixmapCachePolicy();
+        void compressedPixmapRetrieved( PixmapRequest *request, const QImage &image, Rotation rotation );
+        void diskRenderRetrieved( PixmapRequest *request, const QImage &image, Rotation rotation );
+        void thumbnailFetched( PixmapRequest *request, const QImage &image );
+        void openRenderCaches();
+        QString diskRenderCacheHints() const;
+        bool hasUnsavedEdits() const;
+        void openTextIndex();
+        QVector< bool > textIndexCandidates( const QVector< SearchTerm > &terms, bool matchAll ) const;
+        void pixmapLookedUp( DocumentObserver *observer, int page, bool found );
         AllocatedPixmap * searchLowestPriorityPixmap( bool unloadableOnly = false, bool thenRemoveIt = false, DocumentObserver *observer = nullptr /* any */ );
         void calculateMaxTextPages();
+        qulonglong calculateTextPageMemoryToFree();
+        void updateTextPageMemory();
+        void cleanupTextPageMemory( int keepPage = -1 );
         qulonglong getTotalMemory();
         qulonglong getFreeMemory( qulonglong *freeSwap = nullptr );
+        qulonglong getPhysicalMemory();
+        qulonglong getSystemFreeMemory( qulonglong *freeSwap );
         void loadDocumentInfo();
         void loadDocumentInfo( QFile &infoFile );
         void loadViewsInfo( View *view, const QDomElement &e );
@@ -158,11 +188,26 @@ class DocumentPrivate
         void refreshPixmaps( int );
         void _o_configChanged();
         void doContinueDirectionMatchSearch(void *doContinueDirectionMatchSearchStruct);
-        void doContinueAllDocumentSearch(void *pagesToNotifySet, void *pageMatchesMap, int currentPage, int searchID);
-        void doContinueGooglesDocumentSearch(void *pagesToNotifySet, void *pageMatchesMap, int currentPage, int searchID, const QStringList & words);
+        void doContinueDocumentSearch( int searchID, int run );
+        void doContinuePageDataLoading( int run );
+        void notifyPageDataLoaded();
 
         void doProcessSearchMatch( RegularAreaRect *match, RunningSearch *search, QSet< int > *pagesToNotify, int currentPage, int searchID, bool moveViewport, const QColor & color );
 
+        // data of the pages loaded on demand, see PageDataInterface
+        void loadPageData( Page *page );
+        void loadAllPageData();
+
+        // stops what works on the pages in the background, before they go
+        void stopPageWork();
+        void runDocumentScripts();
+
+        // whole document searches
+        void startDocumentSearch( int searchID, const QVector< SearchTerm > &terms, bool matchAll );
+        void documentSearchPageSearched( int searchID, Page *page, TextPage *textPage, const QVector< SearchMatch > &matches );
+        void documentSearchPageDone( int searchID, Page *page, const QVector< SearchMatch > &matches );
+        void finishDocumentSearch( int searchID, Document::SearchStatus status );
+
         // generators stuff
         /**
          * This method is used by the generators to signal the finish of
@@ -197,6 +242,8 @@ class DocumentPrivate
         // find descriptors, mapped by ID (we handle multiple searches)
         QMap< int, RunningSearch * > m_searches;
         bool m_searchCancelled;
+        DocumentSearch m_documentSearch;
+        TextIndex m_textIndex;
 
         // needed because for remote documents docFileName is a local file and
         // we want the remote url when the document refers to relativeNames
@@ -216,12 +263,23 @@ class DocumentPrivate
 
         // observers / requests / allocator stuff
         QSet< DocumentObserver * > m_observers;
-        QLinkedList< PixmapRequest * > m_pixmapRequestsStack;
+        PixmapScheduler m_pixmapScheduler;
         QLinkedList< PixmapRequest * > m_executingPixmapRequests;
         QMutex m_pixmapRequestsMutex;
-        QLinkedList< AllocatedPixmap * > m_allocatedPixmaps;
+        PixmapEvictionIndex m_allocatedPixmaps;
         qulonglong m_allocatedPixmapsTotalMemory;
-        QList< int > m_allocatedTextPagesFifo;
+        qulonglong m_pixmapCacheHits;
+        qulonglong m_pixmapCacheMisses;
+        // bumped when the viewport moves to another page, see
+        // PagePrivate::pixmapLookedUp()
+        quint64 m_pixmapLookupRound;
+        MemoryBudget m_memoryBudget;
+        CompressedPixmapCache m_compressedPixmaps;
+        DiskRenderCache m_diskRenderCache;
+        ThumbnailPipeline m_thumbnailPipeline;
+        // the estimated memory of the text pages, by page number
+        QHash< int, qulonglong > m_allocatedTextPages;
+        qulonglong m_allocatedTextPagesTotalMemory;
         int m_maxAllocatedTextPages;
         bool m_warnedOutOfMemory;
 
@@ -276,6 +334,16 @@ class DocumentPrivate
         bool m_annotationsNeedSaveAs;
         bool m_annotationBeingModified; // is an annotation currently being moved or resized?
         bool m_showWarningLimitedAnnotSupport;
+        // whether the file is watched for changes, see setReloadable()
+        bool m_reloadable;
+
+        // the data of a page is being loaded, its observers are told after
+        bool m_loadingPageData;
+        // pages whose data is loaded in background, the next one to load
+        // and the pages whose observers are still to be told
+        int m_pageDataRun;
+        int m_nextPendingPageData;
+        QVector< int > m_pagesWithLoadedData;
 
         QUndoStack *m_undoStack;
         QDomNode m_prevPropsOfAnnotBeingModified;
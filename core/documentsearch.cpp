@@ -0,0 +1,211 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "documentsearch_p.h"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QThread>
+
+#include <threadweaver/job.h>
+#include <threadweaver/qobjectdecorator.h>
+#include <threadweaver/queueing.h>
+
+#include "area.h"
+#include "generator.h"
+#include "page.h"
+#include "page_p.h"
+#include "textpage.h"
+
+using namespace Okular;
+
+struct DocumentSearch::Run
+{
+    Run( Generator *generator, QMutex *textPageMutex, const QVector< SearchTerm > &terms, bool matchAll )
+        : generator( generator ), textPageMutex( textPageMutex ), terms( terms ), matchAll( matchAll )
+    {
+    }
+
+    // read by the jobs, never changed once the run is started
+    Generator * const generator;
+    QMutex * const textPageMutex;
+    const QVector< SearchTerm > terms;
+    const bool matchAll;
+
+    QAtomicInt cancelled;
+    // only touched in the GUI thread
+    QList< ThreadWeaver::JobPointer > jobs;
+};
+
+namespace Okular {
+
+class DocumentSearchJobInternal : public ThreadWeaver::Job
+{
+    public:
+        DocumentSearchJobInternal( int searchID, const QSharedPointer< DocumentSearch::Run > &run, Page *page )
+            : mSearchID( searchID ), mRun( run ), mPage( page ), mTextPage( nullptr )
+        {
+        }
+
+        ~DocumentSearchJobInternal()
+        {
+            // results nobody took
+            delete mTextPage;
+            foreach ( const SearchMatch &match, mMatches )
+                delete match.first;
+        }
+
+        const int mSearchID;
+        const QSharedPointer< DocumentSearch::Run > mRun;
+        Page * const mPage;
+        TextPage *mTextPage;
+        QVector< SearchMatch > mMatches;
+
+    protected:
+        void run( ThreadWeaver::JobPointer, ThreadWeaver::Thread * ) override
+        {
+            if ( mRun->cancelled.load() )
+                return;
+
+            mRun->textPageMutex->lock();
+            mTextPage = mRun->generator->textPage( mPage );
+            mRun->textPageMutex->unlock();
+            if ( !mTextPage || mRun->cancelled.load() )
+                return;
+
+            PagePrivate::get( mPage )->prepareTextPage( mTextPage );
+            mMatches = DocumentSearch::matchTextPage( mTextPage, mSearchID, mRun->terms, mRun->matchAll );
+        }
+};
+
+class DocumentSearchJob : public ThreadWeaver::QObjectDecorator
+{
+    public:
+        DocumentSearchJob( DocumentSearchJobInternal *job )
+            : ThreadWeaver::QObjectDecorator( job )
+        {
+        }
+
+        DocumentSearchJobInternal *internal() { return static_cast< DocumentSearchJobInternal * >( job() ); }
+};
+
+}
+
+DocumentSearch::DocumentSearch()
+    : QObject()
+{
+    m_weaver.setMaximumNumberOfThreads( qMax( QThread::idealThreadCount(), 1 ) );
+}
+
+DocumentSearch::~DocumentSearch()
+{
+    stop();
+}
+
+void DocumentSearch::start( int searchID, Generator *generator, const QVector< SearchTerm > &terms, bool matchAll )
+{
+    cancel( searchID );
+
+    m_runs.insert( searchID, QSharedPointer< Run >( new Run( generator, &m_textPageMutex, terms, matchAll ) ) );
+}
+
+void DocumentSearch::searchPage( int searchID, Page *page )
+{
+    const QSharedPointer< Run > run = m_runs.value( searchID );
+    if ( !run )
+        return;
+
+    DocumentSearchJob *job = new DocumentSearchJob( new DocumentSearchJobInternal( searchID, run, page ) );
+    connect( job, SIGNAL(done(ThreadWeaver::JobPointer)),
+             this, SLOT(jobDone(ThreadWeaver::JobPointer)) );
+    const ThreadWeaver::JobPointer pointer( job );
+    run->jobs.append( pointer );
+    m_weaver.enqueue( pointer );
+}
+
+void DocumentSearch::cancel( int searchID )
+{
+    const QSharedPointer< Run > run = m_runs.take( searchID );
+    if ( !run )
+        return;
+
+    run->cancelled.store( 1 );
+    foreach ( const ThreadWeaver::JobPointer &job, run->jobs )
+        m_weaver.dequeue( job );
+    run->jobs.clear();
+}
+
+void DocumentSearch::cancelAll()
+{
+    foreach ( int searchID, m_runs.keys() )
+        cancel( searchID );
+}
+
+void DocumentSearch::stop()
+{
+    cancelAll();
+    m_weaver.dequeue();
+    m_weaver.finish();
+}
+
+QVector< SearchMatch > DocumentSearch::matchTextPage( TextPage *textPage, int searchID, const QVector< SearchTerm > &terms, bool matchAll )
+{
+    TextPagePrivate *textPagePrivate = TextPagePrivate::get( textPage );
+    QVector< SearchMatch > matches;
+    bool allMatched = !terms.isEmpty();
+    foreach ( const SearchTerm &term, terms )
+    {
+        if ( !term.pattern.isValid() )
+        {
+            allMatched = false;
+            continue;
+        }
+
+        bool termMatched = false;
+        RegularAreaRect *lastMatch = nullptr;
+        while ( true )
+        {
+            lastMatch = textPagePrivate->findText( searchID, term.pattern, lastMatch ? NextResult : FromTop );
+
+            if ( !lastMatch )
+                break;
+
+            matches.append( SearchMatch( lastMatch, term.color ) );
+            termMatched = true;
+        }
+        allMatched = allMatched && termMatched;
+    }
+
+    // if not all the terms are on the page, drop the partial matches
+    if ( matchAll && !allMatched )
+    {
+        foreach ( const SearchMatch &match, matches )
+            delete match.first;
+        matches.clear();
+    }
+
+    return matches;
+}
+
+void DocumentSearch::jobDone( const ThreadWeaver::JobPointer &j )
+{
+    DocumentSearchJob *job = static_cast< DocumentSearchJob * >( j.data() );
+    DocumentSearchJobInternal *internal = job->internal();
+
+    internal->mRun->jobs.removeOne( j );
+    if ( internal->mRun->cancelled.load() || m_runs.value( internal->mSearchID ) != internal->mRun )
+        return;
+
+    TextPage *textPage = internal->mTextPage;
+    const QVector< SearchMatch > matches = internal->mMatches;
+    internal->mTextPage = nullptr;
+    internal->mMatches.clear();
+    emit pageSearched( internal->mSearchID, internal->mPage, textPage, matches );
+}
+
+#include "moc_documentsearch_p.cpp"
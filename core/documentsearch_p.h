@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_DOCUMENTSEARCH_P_H_
+#define _OKULAR_DOCUMENTSEARCH_P_H_
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QPair>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtGui/QColor>
+
+#include <threadweaver/queue.h>
+
+#include "textpage_p.h"
+
+namespace Okular {
+
+class DocumentSearchJobInternal;
+class Generator;
+class Page;
+class RegularAreaRect;
+class TextPage;
+
+struct SearchTerm
+{
+    QString text;
+    QColor color;
+    // compiled once for the whole search
+    SearchPattern pattern;
+};
+
+typedef QPair< RegularAreaRect *, QColor > SearchMatch;
+
+/**
+ * @short The background part of the whole document searches.
+ *
+ * For each page without a text page, a job extracts the text with the
+ * generator, puts it in reading order and looks for the search terms in
+ * it, all in a thread of a pool. Generators are not required to extract
+ * text for several pages at once, so the jobs take turns for that and only
+ * the rest runs in parallel. The text page never gets shared with anyone
+ * until it is handed out with the matches by pageSearched(), in the GUI
+ * thread.
+ *
+ * Jobs are run in the order they are queued. Cancelling a search drops its
+ * queued jobs, and the ones already running throw their results away as
+ * soon as their page is done.
+ */
+class DocumentSearch : public QObject
+{
+    Q_OBJECT
+
+    friend class DocumentSearchJobInternal;
+
+    public:
+        DocumentSearch();
+        ~DocumentSearch();
+
+        /**
+         * Starts a new run of the search @p searchID for @p terms,
+         * cancelling the previous one.
+         */
+        void start( int searchID, Generator *generator, const QVector< SearchTerm > &terms, bool matchAll );
+
+        /**
+         * Queues @p page for the current run of @p searchID.
+         */
+        void searchPage( int searchID, Page *page );
+
+        /**
+         * Cancels the current run of @p searchID, or of all the searches.
+         */
+        void cancel( int searchID );
+        void cancelAll();
+
+        /**
+         * Cancels all the searches and waits for the running jobs, which
+         * are still using their page and generator.
+         */
+        void stop();
+
+        /**
+         * Looks for all the occurrences of the patterns of @p terms in
+         * @p textPage. If
+         * @p matchAll is set and some term is missing, there are no matches.
+         * The caller owns the returned areas.
+         */
+        static QVector< SearchMatch > matchTextPage( TextPage *textPage, int searchID, const QVector< SearchTerm > &terms, bool matchAll );
+
+    Q_SIGNALS:
+        /**
+         * @p page was searched for @p searchID. The receiver owns the
+         * extracted @p textPage, which may be null, and the @p matches.
+         */
+        void pageSearched( int searchID, Okular::Page *page, Okular::TextPage *textPage, const QVector< Okular::SearchMatch > &matches );
+
+    private Q_SLOTS:
+        void jobDone( const ThreadWeaver::JobPointer &job );
+
+    private:
+        struct Run;
+
+        ThreadWeaver::Queue m_weaver;
+        // held by the jobs while the generator extracts text
+        QMutex m_textPageMutex;
+        QHash< int, QSharedPointer< Run > > m_runs;
+};
+
+}
+
+#endif
@@ -26,6 +26,7 @@
 #include "document_p.h"
 #include "page.h"
 #include "page_p.h"
+#include "settings_core.h"
 #include "textpage.h"
 #include "utils.h"
 
@@ -33,7 +34,7 @@ using namespace Okular;
 
 GeneratorPrivate::GeneratorPrivate()
     : m_document( nullptr ),
-      mPixmapGenerationThread( nullptr ), mTextPageGenerationThread( nullptr ),
+      mRunningPixmapWorkers( 0 ), mTextPageGenerationThread( nullptr ),
       m_mutex( nullptr ), m_threadsMutex( nullptr ), mPixmapReady( true ), mTextPageReady( true ),
       m_closing( false ), m_closingLoop( nullptr ),
       m_dpi(72.0, 72.0)
@@ -43,10 +44,11 @@ GeneratorPrivate::GeneratorPrivate()
 
 GeneratorPrivate::~GeneratorPrivate()
 {
-    if ( mPixmapGenerationThread )
-        mPixmapGenerationThread->wait();
-
-    delete mPixmapGenerationThread;
+    foreach ( PixmapGenerationThread *thread, mPixmapGenerationThreads )
+    {
+        thread->wait();
+        delete thread;
+    }
 
     if ( mTextPageGenerationThread )
         mTextPageGenerationThread->wait();
@@ -59,15 +61,23 @@ GeneratorPrivate::~GeneratorPrivate()
 
 PixmapGenerationThread* GeneratorPrivate::pixmapGenerationThread()
 {
-    if ( mPixmapGenerationThread )
-        return mPixmapGenerationThread;
+    // reuse an idle worker if there is one
+    foreach ( PixmapGenerationThread *thread, mPixmapGenerationThreads )
+    {
+        if ( !thread->request() )
+            return thread;
+    }
+
+    if ( mPixmapGenerationThreads.count() >= pixmapWorkerCount() )
+        return nullptr;
 
     Q_Q( Generator );
-    mPixmapGenerationThread = new PixmapGenerationThread( q );
-    QObject::connect( mPixmapGenerationThread, SIGNAL(finished()), q, SLOT(pixmapGenerationFinished()),
+    PixmapGenerationThread *thread = new PixmapGenerationThread( q, mPixmapGenerationThreads.count() );
+    QObject::connect( thread, &QThread::finished, q, [this, thread] { pixmapGenerationFinished( thread ); },
                       Qt::QueuedConnection );
+    mPixmapGenerationThreads.append( thread );
 
-    return mPixmapGenerationThread;
+    return thread;
 }
 
 TextPageGenerationThread* GeneratorPrivate::textPageGenerationThread()
@@ -83,19 +93,50 @@ TextPageGenerationThread* GeneratorPrivate::textPageGenerationThread()
     return mTextPageGenerationThread;
 }
 
-void GeneratorPrivate::pixmapGenerationFinished()
+int GeneratorPrivate::pixmapWorkerCount() const
+{
+    Q_Q( const Generator );
+    if ( !q->hasFeature( Generator::Threaded ) || !q->hasFeature( Generator::ParallelRendering ) )
+        return 1;
+
+    // 0 means automatic: leave a core to the GUI thread, but don't go
+    // overboard as every worker needs its own backend state
+    int workers = SettingsCore::renderWorkers();
+    if ( workers <= 0 )
+        workers = qBound( 1, QThread::idealThreadCount() - 1, 4 );
+    return workers;
+}
+
+bool GeneratorPrivate::canStartPixmapGeneration( const PixmapRequest *request ) const
+{
+    // nothing is being rendered, anything goes
+    if ( mRunningPixmapWorkers == 0 )
+        return true;
+
+    // only asynchronous requests can run next to the ones in flight
+    if ( !request->asynchronous() )
+        return false;
+
+    // preloads and thumbnails never take the last idle worker, so that a
+    // newly visible page does not have to wait for them
+    const int idleWorkers = pixmapWorkerCount() - mRunningPixmapWorkers;
+    return request->preload() || request->isThumbnail() ? idleWorkers > 1 : idleWorkers > 0;
+}
+
+void GeneratorPrivate::pixmapGenerationFinished( PixmapGenerationThread *thread )
 {
     Q_Q( Generator );
-    PixmapRequest *request = mPixmapGenerationThread->request();
-    mPixmapGenerationThread->endGeneration();
+    PixmapRequest *request = thread->request();
+    thread->endGeneration();
 
     QMutexLocker locker( threadsLock() );
-    mPixmapReady = true;
+    --mRunningPixmapWorkers;
+    mPixmapReady = mRunningPixmapWorkers == 0;
 
     if ( m_closing )
     {
         delete request;
-        if ( mTextPageReady )
+        if ( mPixmapReady && mTextPageReady )
         {
             locker.unlock();
             m_closingLoop->quit();
@@ -103,12 +144,16 @@ void GeneratorPrivate::pixmapGenerationFinished()
         return;
     }
 
-    const QImage& img = mPixmapGenerationThread->image();
-    request->page()->setPixmap( request->observer(), new QPixmap( QPixmap::fromImage( img ) ), request->normalizedRect() );
-    const int pageNumber = request->page()->number();
+    // a cancelled render leaves an incomplete image, don't use it
+    if ( !request->shouldAbortRender() )
+    {
+        const QImage& img = thread->image();
+        request->page()->setPixmap( request->observer(), new QPixmap( QPixmap::fromImage( img ) ), request->normalizedRect() );
+        const int pageNumber = request->page()->number();
 
-    if ( mPixmapGenerationThread->calcBoundingBox() )
-        q->updatePageBoundingBox( pageNumber, mPixmapGenerationThread->boundingBox() );
+        if ( thread->calcBoundingBox() )
+            q->updatePageBoundingBox( pageNumber, thread->boundingBox() );
+    }
     q->signalPixmapRequestDone( request );
 }
 
@@ -233,7 +278,7 @@ bool Generator::closeDocument()
 bool Generator::canGeneratePixmap() const
 {
     Q_D( const Generator );
-    return d->mPixmapReady;
+    return d->mPixmapReady || ( d->mRunningPixmapWorkers > 0 && d->mRunningPixmapWorkers < d->pixmapWorkerCount() );
 }
 
 void Generator::generatePixmap( PixmapRequest *request )
@@ -241,17 +286,24 @@ void Generator::generatePixmap( PixmapRequest *request )
     Q_D( Generator );
     d->mPixmapReady = false;
 
-    const bool calcBoundingBox = !request->isTile() && !request->page()->isBoundingBoxKnown();
+    // previews and thumbnails are too coarse for a useful bounding box
+    const bool calcBoundingBox = !request->isTile() && !request->isPreview() && !request->isThumbnail() && !request->page()->isBoundingBoxKnown();
 
+    PixmapGenerationThread *thread = nullptr;
     if ( request->asynchronous() && hasFeature( Threaded ) )
+        thread = d->pixmapGenerationThread();
+
+    if ( thread )
     {
-        d->pixmapGenerationThread()->startGeneration( request, calcBoundingBox );
+        ++d->mRunningPixmapWorkers;
+        thread->startGeneration( request, calcBoundingBox );
 
         /**
          * We create the text page for every page that is visible to the
          * user, so he can use the text extraction tools without a delay.
+         * The pages of thumbnails are not visible in that sense.
          */
-        if ( hasFeature( TextExtraction ) && !request->page()->hasTextPage() && canGenerateTextPage() && !d->m_closing ) {
+        if ( hasFeature( TextExtraction ) && !request->isThumbnail() && !request->page()->hasTextPage() && canGenerateTextPage() && !d->m_closing ) {
             d->mTextPageReady = false;
             // Queue the text generation request so that pixmap generation gets a chance to start before the text generation
             QMetaObject::invokeMethod(d->textPageGenerationThread(), "startGeneration", Qt::QueuedConnection, Q_ARG(Okular::Page*, request->page()));
@@ -264,7 +316,7 @@ void Generator::generatePixmap( PixmapRequest *request )
     request->page()->setPixmap( request->observer(), new QPixmap( QPixmap::fromImage( img ) ), request->normalizedRect() );
     const int pageNumber = request->page()->number();
 
-    d->mPixmapReady = true;
+    d->mPixmapReady = d->mRunningPixmapWorkers == 0;
 
     signalPixmapRequestDone( request );
     if ( calcBoundingBox )
@@ -483,6 +535,11 @@ QSizeF Generator::dpi() const
      return d->m_dpi;
 }
 
+int Generator::renderWorker( PixmapRequest *request ) const
+{
+    return request->d->mWorker;
+}
+
 QAbstractItemModel * Generator::layersModel() const
 {
     return nullptr;
@@ -497,8 +554,12 @@ PixmapRequest::PixmapRequest( DocumentObserver *observer, int pageNumber, int wi
     d->mHeight = ceil(height * qApp->devicePixelRatio());
     d->mPriority = priority;
     d->mFeatures = features;
+    d->mWorker = -1;
+    d->mPixmapKey = 0;
     d->mForce = false;
     d->mTile = false;
+    d->mPreview = false;
+    d->mThumbnailLookup = false;
     d->mNormalizedRect = NormalizedRect();
 }
 
@@ -570,6 +631,21 @@ const NormalizedRect& PixmapRequest::normalizedRect() const
     return d->mNormalizedRect;
 }
 
+bool PixmapRequest::shouldAbortRender() const
+{
+    return d->mShouldAbortRender.load() != 0;
+}
+
+bool PixmapRequest::isPreview() const
+{
+    return d->mPreview;
+}
+
+bool PixmapRequest::isThumbnail() const
+{
+    return d->mFeatures & Thumbnail;
+}
+
 Okular::TilesManager* PixmapRequestPrivate::tilesManager() const
 {
     return mPage->d->tilesManager(mObserver);
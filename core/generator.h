@@ -189,6 +189,8 @@ class OKULARCORE_EXPORT Generator : public QObject
     /// @cond PRIVATE
     friend class PixmapGenerationThread;
     friend class TextPageGenerationThread;
+    friend class DocumentSearchJobInternal;
+    friend class TextIndexJobInternal;
     /// @endcond
 
     Q_OBJECT
@@ -208,7 +210,9 @@ class OKULARCORE_EXPORT Generator : public QObject
             PrintNative,       ///< Whether the Generator supports native cross-platform printing (QPainter-based).
             PrintPostscript,   ///< Whether the Generator supports postscript-based file printing.
             PrintToFile,       ///< Whether the Generator supports export to PDF & PS through the Print Dialog
-            TiledRendering     ///< Whether the Generator can render tiles @since 0.16 (KDE 4.10)
+            TiledRendering,    ///< Whether the Generator can render tiles @since 0.16 (KDE 4.10)
+            ParallelRendering, ///< Whether image() can be called concurrently from several render workers, see renderWorker() @since 1.3
+            SupportsCancelling ///< Whether the Generator stops rendering when PixmapRequest::shouldAbortRender() becomes true @since 1.3
         };
 
         /**
@@ -562,6 +566,18 @@ class OKULARCORE_EXPORT Generator : public QObject
          */
         QSizeF dpi() const;
 
+        /**
+         * Returns the index of the render worker that is processing the
+         * given @p request, or -1 if the request is not being rendered by
+         * a worker (e.g. it is synchronous).
+         *
+         * Generators with the @ref ParallelRendering feature can use it to
+         * keep one backend handle per worker.
+         *
+         * @since 1.3
+         */
+        int renderWorker( PixmapRequest *request ) const;
+
     protected Q_SLOTS:
         /**
          * Gets the font data for the given font
@@ -589,7 +605,6 @@ class OKULARCORE_EXPORT Generator : public QObject
     private:
         Q_DISABLE_COPY( Generator )
 
-        Q_PRIVATE_SLOT( d_func(), void pixmapGenerationFinished() )
         Q_PRIVATE_SLOT( d_func(), void textpageGenerationFinished() )
 };
 
@@ -600,13 +615,18 @@ class OKULARCORE_EXPORT PixmapRequest
 {
     friend class Document;
     friend class DocumentPrivate;
+    friend class Generator;
+    friend class PixmapGenerationThread;
+    friend class PixmapScheduler;
 
     public:
         enum PixmapRequestFeature
         {
             NoFeature = 0,
             Asynchronous = 1,
-            Preload = 2
+            Preload = 2,
+            Progressive = 4, ///< A cheap preview of the page is rendered and shown first, if nothing close to the requested size is available. @since 1.3
+            Thumbnail = 8 ///< The pixmap is a thumbnail: it can come from the ones kept on disk or embedded in the document. @since 1.3
         };
         Q_DECLARE_FLAGS( PixmapRequestFeatures, PixmapRequestFeature )
 
@@ -703,6 +723,37 @@ class OKULARCORE_EXPORT PixmapRequest
          */
         const NormalizedRect& normalizedRect() const;
 
+        /**
+         * Returns whether the generator should stop rendering this request,
+         * because its result is not wanted anymore (e.g. the page left the
+         * viewport). Only set for generators with the
+         * @ref Generator::SupportsCancelling feature.
+         *
+         * It can be called from the render thread.
+         *
+         * @since 1.3
+         */
+        bool shouldAbortRender() const;
+
+        /**
+         * Returns whether this is the preview of a @ref Progressive request:
+         * a render at a reduced size that only needs to be shown until the
+         * full one arrives. Generators can trade quality for speed, e.g. by
+         * disabling antialiasing.
+         *
+         * @since 1.3
+         */
+        bool isPreview() const;
+
+        /**
+         * Returns whether the request is for a @ref Thumbnail of the page.
+         * Generators should not do more than rendering the page for those,
+         * e.g. no text extraction.
+         *
+         * @since 1.3
+         */
+        bool isThumbnail() const;
+
     private:
         Q_DISABLE_COPY( PixmapRequest )
 
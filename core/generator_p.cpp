@@ -13,18 +13,20 @@
 
 #include "fontinfo.h"
 #include "generator.h"
+#include "page_p.h"
 #include "utils.h"
 
 using namespace Okular;
 
-PixmapGenerationThread::PixmapGenerationThread( Generator *generator )
-    : mGenerator( generator ), mRequest( nullptr ), mCalcBoundingBox( false )
+PixmapGenerationThread::PixmapGenerationThread( Generator *generator, int worker )
+    : mGenerator( generator ), mRequest( nullptr ), mWorker( worker ), mCalcBoundingBox( false )
 {
 }
 
 void PixmapGenerationThread::startGeneration( PixmapRequest *request, bool calcBoundingBox )
 {
     mRequest = request;
+    mRequest->d->mWorker = mWorker;
     mCalcBoundingBox = calcBoundingBox;
 
     start( QThread::InheritPriority );
@@ -32,6 +34,8 @@ void PixmapGenerationThread::startGeneration( PixmapRequest *request, bool calcB
 
 void PixmapGenerationThread::endGeneration()
 {
+    if ( mRequest )
+        mRequest->d->mWorker = -1;
     mRequest = nullptr;
 }
 
@@ -40,6 +44,11 @@ PixmapRequest *PixmapGenerationThread::request() const
     return mRequest;
 }
 
+int PixmapGenerationThread::worker() const
+{
+    return mWorker;
+}
+
 QImage PixmapGenerationThread::image() const
 {
     return mImage;
@@ -101,6 +110,11 @@ void TextPageGenerationThread::run()
 
     if ( mPage )
         mTextPage = mGenerator->textPage( mPage );
+
+    // put the words in reading order here rather than when the text page
+    // is set on the page, in the GUI thread
+    if ( mTextPage )
+        PagePrivate::get( mPage )->prepareTextPage( mTextPage );
 }
 
 
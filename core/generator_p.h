@@ -12,8 +12,11 @@
 
 #include "area.h"
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QSet>
 #include <QtCore/QThread>
+#include <QtCore/QVector>
 #include <QtGui/QImage>
 
 class QEventLoop;
@@ -47,7 +50,19 @@ class GeneratorPrivate
         PixmapGenerationThread* pixmapGenerationThread();
         TextPageGenerationThread* textPageGenerationThread();
 
-        void pixmapGenerationFinished();
+        /**
+         * Returns the number of render workers the generator can use for
+         * asynchronous pixmap requests.
+         */
+        int pixmapWorkerCount() const;
+
+        /**
+         * Returns whether @p request can be started now, taking into account
+         * the render workers that are already busy.
+         */
+        bool canStartPixmapGeneration( const PixmapRequest *request ) const;
+
+        void pixmapGenerationFinished( PixmapGenerationThread *thread );
         void textpageGenerationFinished();
 
         QMutex* threadsLock();
@@ -59,7 +74,8 @@ class GeneratorPrivate
         // NOTE: the following should be a QSet< GeneratorFeature >,
         // but it is not to avoid #include'ing generator.h
         QSet< int > m_features;
-        PixmapGenerationThread *mPixmapGenerationThread;
+        QVector< PixmapGenerationThread * > mPixmapGenerationThreads;
+        int mRunningPixmapWorkers;
         TextPageGenerationThread *mTextPageGenerationThread;
         mutable QMutex *m_mutex;
         QMutex *m_threadsMutex;
@@ -83,10 +99,18 @@ class PixmapRequestPrivate
         int mHeight;
         int mPriority;
         int mFeatures;
+        int mWorker;
+        // the QPixmap::cacheKey() of the pixmap of the observer when an
+        // evicted copy started being decompressed, 0 if there was none
+        qint64 mPixmapKey;
         bool mForce : 1;
         bool mTile : 1;
+        bool mPreview : 1;
+        bool mThumbnailLookup : 1;
         Page *mPage;
         NormalizedRect mNormalizedRect;
+        QAtomicInt mShouldAbortRender;
+        QElapsedTimer mRenderTimer;
 };
 
 
@@ -95,13 +119,14 @@ class PixmapGenerationThread : public QThread
     Q_OBJECT
 
     public:
-        PixmapGenerationThread( Generator *generator );
+        PixmapGenerationThread( Generator *generator, int worker );
 
         void startGeneration( PixmapRequest *request, bool calcBoundingRect );
 
         void endGeneration();
 
         PixmapRequest *request() const;
+        int worker() const;
 
         QImage image() const;
         bool calcBoundingBox() const;
@@ -113,6 +138,7 @@ class PixmapGenerationThread : public QThread
     private:
         Generator *mGenerator;
         PixmapRequest *mRequest;
+        int mWorker;
         QImage mImage;
         NormalizedRect mBoundingBox;
         bool mCalcBoundingBox : 1;
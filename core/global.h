@@ -10,6 +10,7 @@
 #ifndef OKULAR_GLOBAL_H
 #define OKULAR_GLOBAL_H
 
+#include <QtCore/QFlags>
 #include <QtCore/QGlobalStatic>
 
 namespace Okular {
@@ -38,6 +39,20 @@ enum SearchDirection
     PreviousResult  ///< Searching for the previous result on the page, earlier result should be located so we search from the last result not from the beginning of the page.
 };
 
+/**
+ * Describes how the text of a search is matched.
+ *
+ * @since 1.3
+ */
+enum SearchOption
+{
+    NoSearchOption = 0,                ///< The text is matched literally
+    WholeWordsSearchOption = 1,        ///< Only matches starting and ending on word boundaries are found
+    IgnoreAccentsSearchOption = 2,     ///< Letters match whether they have accents or not
+    RegularExpressionSearchOption = 4  ///< The text is a Perl compatible regular expression
+};
+Q_DECLARE_FLAGS( SearchOptions, SearchOption )
+
 /**
  * A rotation.
  */
@@ -80,4 +95,6 @@ enum ScriptType
 
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS( Okular::SearchOptions )
+
 #endif
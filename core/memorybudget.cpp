@@ -0,0 +1,186 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "memorybudget_p.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+
+using namespace Okular;
+
+static qulonglong readCgroupValue( const QString &fileName, bool *ok )
+{
+    *ok = false;
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) )
+        return 0;
+
+    // "max" means no limit and fails the conversion
+    return file.readAll().trimmed().toULongLong( ok );
+}
+
+MemoryBudget::MemoryBudget( const QString &procPath, const QString &cgroupPath )
+    : m_procPath( procPath ), m_cgroupPath( cgroupPath ),
+      m_hasLimit( false ), m_limit( 0 ), m_usage( 0 ), m_pressure( -1 ),
+      m_pressureBudget( ~Q_UINT64_C( 0 ) )
+{
+}
+
+void MemoryBudget::update( qulonglong pixmapMemory, bool force )
+{
+    if ( !force && m_lastUpdate.isValid() && m_lastUpdate.elapsed() < 2000 )
+        return;
+
+    readCgroup();
+    readPressure();
+    m_lastUpdate.start();
+
+    // shrink by the share of stalled time, at most by half per update:
+    // the target is taken from what the pixmaps use now and kept until the
+    // next update, so that it does not shrink again on every request
+    if ( m_pressure > 10.0 )
+    {
+        const double keep = 1.0 - qMin( m_pressure, 50.0 ) / 100.0;
+        m_pressureBudget = (qulonglong)( qMin( m_pressureBudget, pixmapMemory ) * keep );
+    }
+    else
+        m_pressureBudget = ~Q_UINT64_C( 0 );
+}
+
+bool MemoryBudget::hasLimit() const
+{
+    return m_hasLimit;
+}
+
+qulonglong MemoryBudget::limit() const
+{
+    return m_limit;
+}
+
+qulonglong MemoryBudget::usage() const
+{
+    return m_usage;
+}
+
+qulonglong MemoryBudget::available() const
+{
+    return m_limit > m_usage ? m_limit - m_usage : 0;
+}
+
+double MemoryBudget::pressure() const
+{
+    return m_pressure;
+}
+
+qulonglong MemoryBudget::pixmapBudget( qulonglong pixmapMemory ) const
+{
+    qulonglong budget = ~Q_UINT64_C( 0 );
+
+    if ( m_hasLimit )
+    {
+        // leave the rest of the process and a tenth of the limit alone
+        const qulonglong otherMemory = m_usage > pixmapMemory ? m_usage - pixmapMemory : 0;
+        const qulonglong reserve = m_limit / 10;
+        budget = m_limit > otherMemory + reserve ? m_limit - otherMemory - reserve : 0;
+    }
+
+    return qMin( budget, m_pressureBudget );
+}
+
+void MemoryBudget::readCgroup()
+{
+    m_hasLimit = false;
+    m_limit = 0;
+    m_usage = 0;
+    m_limitDir.clear();
+
+    // the cgroup v2 entry is the one with hierarchy ID 0 and no controllers
+    QFile cgroupFile( m_procPath + QStringLiteral( "/self/cgroup" ) );
+    if ( !cgroupFile.open( QIODevice::ReadOnly ) )
+        return;
+
+    QString path;
+    QTextStream readStream( &cgroupFile );
+    while ( true )
+    {
+        const QString entry = readStream.readLine();
+        if ( entry.isNull() ) break;
+        if ( entry.startsWith( QLatin1String( "0::" ) ) )
+        {
+            path = entry.mid( 3 );
+            break;
+        }
+    }
+    if ( !path.startsWith( QLatin1Char( '/' ) ) )
+        return;
+
+    // the limits of the ancestors apply as well, keep the tightest one
+    qulonglong minHeadroom = 0;
+    while ( true )
+    {
+        const QString dir = m_cgroupPath + ( path == QLatin1String( "/" ) ? QString() : path );
+        bool hasMax, hasCurrent;
+        const qulonglong max = readCgroupValue( dir + QStringLiteral( "/memory.max" ), &hasMax );
+        const qulonglong current = readCgroupValue( dir + QStringLiteral( "/memory.current" ), &hasCurrent );
+        if ( hasMax && hasCurrent )
+        {
+            const qulonglong headroom = max > current ? max - current : 0;
+            if ( !m_hasLimit || headroom < minHeadroom )
+            {
+                m_hasLimit = true;
+                m_limit = max;
+                m_usage = current;
+                m_limitDir = dir;
+                minHeadroom = headroom;
+            }
+        }
+
+        if ( path == QLatin1String( "/" ) )
+            break;
+        const int slash = path.lastIndexOf( QLatin1Char( '/' ) );
+        path = slash <= 0 ? QStringLiteral( "/" ) : path.left( slash );
+    }
+}
+
+void MemoryBudget::readPressure()
+{
+    m_pressure = -1;
+
+    // the stalls within the limiting cgroup, rather than the whole system
+    QFile pressureFile( m_limitDir + QStringLiteral( "/memory.pressure" ) );
+    if ( m_limitDir.isEmpty() || !pressureFile.open( QIODevice::ReadOnly ) )
+    {
+        pressureFile.setFileName( m_procPath + QStringLiteral( "/pressure/memory" ) );
+        if ( !pressureFile.open( QIODevice::ReadOnly ) )
+            return;
+    }
+
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    QTextStream readStream( &pressureFile );
+    while ( true )
+    {
+        const QString entry = readStream.readLine();
+        if ( entry.isNull() ) break;
+        if ( !entry.startsWith( QLatin1String( "some " ) ) )
+            continue;
+
+        foreach ( const QString &field, entry.split( QLatin1Char( ' ' ), QString::SkipEmptyParts ) )
+        {
+            if ( field.startsWith( QLatin1String( "avg10=" ) ) )
+            {
+                bool ok;
+                const double value = field.mid( 6 ).toDouble( &ok );
+                if ( ok )
+                    m_pressure = value;
+            }
+        }
+        break;
+    }
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_MEMORYBUDGET_P_H_
+#define _OKULAR_MEMORYBUDGET_P_H_
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QString>
+
+namespace Okular {
+
+/**
+ * @short The memory the process is allowed to use, as seen by the kernel.
+ *
+ * /proc/meminfo describes the whole machine, but inside a container or a
+ * systemd slice the process is bound by the memory.max of its cgroup (or
+ * of an ancestor). When cgroup v2 is mounted, the limit leaving the least
+ * headroom along the hierarchy is used.
+ *
+ * The memory pressure stall information is read as well, from the
+ * memory.pressure of the limiting cgroup or else /proc/pressure/memory;
+ * while tasks are stalling on memory the budget shrinks below what the
+ * pixmaps used at the last read, so the cache is trimmed before the kernel
+ * has to reclaim or kill anything.
+ *
+ * Values are re-read at most every two seconds.
+ */
+class MemoryBudget
+{
+    public:
+        explicit MemoryBudget( const QString &procPath = QStringLiteral( "/proc" ), const QString &cgroupPath = QStringLiteral( "/sys/fs/cgroup" ) );
+
+        /**
+         * Re-reads the kernel values if the last read is older than two
+         * seconds, or unconditionally if @p force is set. Under memory
+         * pressure the budget then shrinks from @p pixmapMemory, what the
+         * pixmaps use at that time.
+         */
+        void update( qulonglong pixmapMemory, bool force = false );
+
+        /**
+         * Whether the process is bound by a cgroup memory limit.
+         */
+        bool hasLimit() const;
+
+        /**
+         * The cgroup memory limit and the memory currently charged to it.
+         */
+        qulonglong limit() const;
+        qulonglong usage() const;
+
+        /**
+         * The memory that can still be charged before hitting the limit.
+         */
+        qulonglong available() const;
+
+        /**
+         * The share of time, in percent over the last ten seconds, some
+         * task stalled waiting for memory, or -1 if unknown.
+         */
+        double pressure() const;
+
+        /**
+         * Returns the maximum number of bytes the pixmaps may use, given
+         * they currently use @p pixmapMemory, or ~0 if there is no budget.
+         */
+        qulonglong pixmapBudget( qulonglong pixmapMemory ) const;
+
+    private:
+        void readCgroup();
+        void readPressure();
+
+        QString m_procPath;
+        QString m_cgroupPath;
+        QElapsedTimer m_lastUpdate;
+        // the cgroup directory the limit comes from
+        QString m_limitDir;
+        bool m_hasLimit;
+        qulonglong m_limit;
+        qulonglong m_usage;
+        double m_pressure;
+        qulonglong m_pressureBudget;
+};
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "objectrectindex_p.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "annotations.h"
+
+using namespace Okular;
+
+// below this many rects of a type, walking them all is as fast
+static const int minimumIndexedRects = 32;
+// the grid of a page has at most this many cells per side
+static const int maximumGridSide = 64;
+
+static int cellOf( double coordinate, int cellCount )
+{
+    return qBound( 0, (int)std::floor( coordinate * cellCount ), cellCount - 1 );
+}
+
+static void unite( NormalizedRect &rect, const NormalizedPoint &point )
+{
+    rect |= NormalizedRect( point.x, point.y, point.x, point.y );
+}
+
+ObjectRectIndex::ObjectRectIndex()
+{
+}
+
+void ObjectRectIndex::invalidate()
+{
+    for ( int i = 0; i <= ObjectRect::SourceRef; ++i )
+        m_grids[ i ] = Grid();
+}
+
+QVector< ObjectRect * > ObjectRectIndex::candidates( const QLinkedList< ObjectRect * > &rects, ObjectRect::ObjectType type,
+                                                     double x, double y, double xScale, double yScale, double pageWidth, double distance )
+{
+    const Grid &g = grid( rects, type );
+
+    QVector< ObjectRect * > result;
+    if ( g.cells.isEmpty() || xScale <= 0 || yScale <= 0 || pageWidth <= 0 )
+    {
+        result.reserve( g.rects.count() );
+        for ( int i = g.rects.count() - 1; i >= 0; --i )
+            result.append( g.rects.at( i ) );
+        return result;
+    }
+
+    // the strokes of the annotations count as part of them, see
+    // strokeDistance() in annotations.cpp
+    const double reach = distance + g.maxStrokeWidth * xScale / pageWidth;
+    const double dx = reach / xScale;
+    const double dy = reach / yScale;
+    const int firstColumn = cellOf( x - dx, g.columns ), lastColumn = cellOf( x + dx, g.columns );
+    const int firstRow = cellOf( y - dy, g.rows ), lastRow = cellOf( y + dy, g.rows );
+
+    if ( firstColumn == lastColumn && firstRow == lastRow )
+    {
+        const QVector< int > &cell = g.cells.at( firstRow * g.columns + firstColumn );
+        result.reserve( cell.count() );
+        for ( int i = cell.count() - 1; i >= 0; --i )
+            result.append( g.rects.at( cell.at( i ) ) );
+        return result;
+    }
+
+    // a rect reaching several of the cells is listed in each of them
+    QVector< int > indexes;
+    for ( int row = firstRow; row <= lastRow; ++row )
+        for ( int column = firstColumn; column <= lastColumn; ++column )
+            indexes += g.cells.at( row * g.columns + column );
+    std::sort( indexes.begin(), indexes.end() );
+    indexes.erase( std::unique( indexes.begin(), indexes.end() ), indexes.end() );
+
+    result.reserve( indexes.count() );
+    for ( int i = indexes.count() - 1; i >= 0; --i )
+        result.append( g.rects.at( indexes.at( i ) ) );
+    return result;
+}
+
+const QVector< ObjectRect * > &ObjectRectIndex::rectsOfType( const QLinkedList< ObjectRect * > &rects, ObjectRect::ObjectType type )
+{
+    return grid( rects, type ).rects;
+}
+
+ObjectRectIndex::Grid &ObjectRectIndex::grid( const QLinkedList< ObjectRect * > &rects, ObjectRect::ObjectType type )
+{
+    Grid &g = m_grids[ type ];
+    if ( g.built )
+        return g;
+
+    g.built = true;
+    foreach ( ObjectRect *rect, rects )
+    {
+        if ( rect->objectType() != type )
+            continue;
+
+        g.rects.append( rect );
+        if ( type == ObjectRect::OAnnotation )
+        {
+            const Annotation *annotation = static_cast< AnnotationObjectRect * >( rect )->annotation();
+            g.maxStrokeWidth = qMax( g.maxStrokeWidth, annotation->style().width() );
+        }
+    }
+
+    if ( g.rects.count() < minimumIndexedRects )
+        return g;
+
+    // about two rects per cell when they are spread evenly
+    const int side = qBound( 1, (int)std::sqrt( g.rects.count() / 2.0 ), maximumGridSide );
+    g.columns = side;
+    g.rows = side;
+    g.cells.resize( side * side );
+    for ( int i = 0; i < g.rects.count(); ++i )
+    {
+        const NormalizedRect e = extent( g.rects.at( i ) );
+        const int firstColumn = cellOf( e.left, side ), lastColumn = cellOf( e.right, side );
+        const int firstRow = cellOf( e.top, side ), lastRow = cellOf( e.bottom, side );
+        for ( int row = firstRow; row <= lastRow; ++row )
+            for ( int column = firstColumn; column <= lastColumn; ++column )
+                g.cells[ row * side + column ].append( i );
+    }
+
+    return g;
+}
+
+NormalizedRect ObjectRectIndex::extent( const ObjectRect *rect )
+{
+    switch ( rect->objectType() )
+    {
+        case ObjectRect::Action:
+        case ObjectRect::Image:
+        {
+            const QRectF r = rect->region().boundingRect();
+            return NormalizedRect( r.left(), r.top(), r.right(), r.bottom() );
+        }
+        case ObjectRect::OAnnotation:
+        {
+            // the shape of some annotations is not bound to their boundary
+            Annotation *annotation = static_cast< const AnnotationObjectRect * >( rect )->annotation();
+            NormalizedRect r = annotation->transformedBoundingRectangle();
+            switch ( annotation->subType() )
+            {
+                case Annotation::ALine:
+                    foreach ( const NormalizedPoint &point, static_cast< LineAnnotation * >( annotation )->transformedLinePoints() )
+                        unite( r, point );
+                    break;
+                case Annotation::AInk:
+                    foreach ( const QLinkedList< NormalizedPoint > &path, static_cast< InkAnnotation * >( annotation )->transformedInkPaths() )
+                        foreach ( const NormalizedPoint &point, path )
+                            unite( r, point );
+                    break;
+                case Annotation::AHighlight:
+                    foreach ( const HighlightAnnotation::Quad &quad, static_cast< HighlightAnnotation * >( annotation )->highlightQuads() )
+                        for ( int i = 0; i < 4; ++i )
+                            unite( r, quad.transformedPoint( i ) );
+                    break;
+                default:
+                    break;
+            }
+            return r;
+        }
+        case ObjectRect::SourceRef:
+        {
+            // a coordinate of -1 stands for the whole width or height
+            const NormalizedPoint &point = static_cast< const SourceRefObjectRect * >( rect )->m_point;
+            const double left = point.x < 0 ? 0.0 : point.x, right = point.x < 0 ? 1.0 : point.x;
+            const double top = point.y < 0 ? 0.0 : point.y, bottom = point.y < 0 ? 1.0 : point.y;
+            return NormalizedRect( left, top, right, bottom );
+        }
+    }
+
+    return NormalizedRect( 0.0, 0.0, 1.0, 1.0 );
+}
@@ -0,0 +1,86 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_OBJECTRECTINDEX_P_H_
+#define _OKULAR_OBJECTRECTINDEX_P_H_
+
+#include <QtCore/QLinkedList>
+#include <QtCore/QVector>
+
+#include "area.h"
+
+namespace Okular {
+
+/**
+ * @short A spatial index of the object rects of a page, for hit testing.
+ *
+ * The object rects of each type are bucketed in a uniform grid over the
+ * normalized page, built the first time a point is looked up for that type.
+ * A lookup only visits the buckets around the point instead of the whole
+ * list of the page, which matters when a page has thousands of links or
+ * annotations and is hit tested on every mouse move.
+ *
+ * The index does not watch the rects: it must be invalidated whenever they
+ * are added, removed, moved or transformed.
+ */
+class ObjectRectIndex
+{
+    public:
+        ObjectRectIndex();
+
+        /**
+         * Forgets the index, to be built again from the rects of the page at
+         * the next lookup.
+         */
+        void invalidate();
+
+        /**
+         * Returns the rects of @p type in @p rects that may be within
+         * @p distance pixels of the point @p x, @p y for the scaling factor
+         * @p xScale and @p yScale, in reverse order of @p rects so that the
+         * ones in the foreground come first. @p pageWidth is the width of
+         * the page, which the strokes of the annotations are relative to.
+         *
+         * The caller still has to compute the exact distance of each of them.
+         */
+        QVector< ObjectRect * > candidates( const QLinkedList< ObjectRect * > &rects, ObjectRect::ObjectType type,
+                                            double x, double y, double xScale, double yScale, double pageWidth, double distance );
+
+        /**
+         * Returns the rects of @p type in @p rects, in their order.
+         */
+        const QVector< ObjectRect * > &rectsOfType( const QLinkedList< ObjectRect * > &rects, ObjectRect::ObjectType type );
+
+    private:
+        struct Grid
+        {
+            Grid() : built( false ), columns( 0 ), rows( 0 ), maxStrokeWidth( 0 ) {}
+
+            bool built;
+            // the rects of the type, in the order of the page
+            QVector< ObjectRect * > rects;
+            int columns;
+            int rows;
+            // the indexes in rects of the ones reaching each cell, row by
+            // row, in increasing order; empty when there are too few rects
+            // to be worth it
+            QVector< QVector< int > > cells;
+            // the widest stroke of the annotations, in page units
+            double maxStrokeWidth;
+        };
+
+        Grid &grid( const QLinkedList< ObjectRect * > &rects, ObjectRect::ObjectType type );
+        static NormalizedRect extent( const ObjectRect *rect );
+
+        Grid m_grids[ ObjectRect::SourceRef + 1 ];
+};
+
+}
+
+#endif
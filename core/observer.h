@@ -53,7 +53,8 @@ class OKULARCORE_EXPORT DocumentObserver
          */
         enum SetupFlags {
             DocumentChanged = 1,    ///< The document is a new document.
-            NewLayoutForPages = 2   ///< All the pages have
+            NewLayoutForPages = 2,  ///< All the pages have
+            DocumentReloaded = 4    ///< Set along with DocumentChanged when the document was loaded again from its changed file, see Document::reloadDocumentFile() @since 1.3
         };
 
         /**
@@ -36,6 +36,7 @@
 #include "pagesize.h"
 #include "pagetransition.h"
 #include "rotationjob_p.h"
+#include "settings_core.h"
 #include "textpage.h"
 #include "textpage_p.h"
 #include "tile.h"
@@ -50,7 +51,8 @@
 
 using namespace Okular;
 
-static const double distanceConsideredEqual = 25; // 5px
+static const double distanceConsideredEqualPixels = 5;
+static const double distanceConsideredEqual = distanceConsideredEqualPixels * distanceConsideredEqualPixels;
 
 static void deleteObjectRects( QLinkedList< ObjectRect * >& rects, const QSet<ObjectRect::ObjectType>& which )
 {
@@ -71,7 +73,7 @@ PagePrivate::PagePrivate( Page *page, uint n, double w, double h, Rotation o )
       m_rotation( Rotation0 ),
       m_text( nullptr ), m_transition( nullptr ), m_textSelections( nullptr ),
       m_openingAction( nullptr ), m_closingAction( nullptr ), m_duration( -1 ),
-      m_isBoundingBoxKnown( false )
+      m_isBoundingBoxKnown( false ), m_dataPending( false )
 {
     // avoid Division-By-Zero problems in the program
     if ( m_width <= 0 )
@@ -205,28 +207,13 @@ void Page::setBoundingBox( const NormalizedRect& bbox )
 
 bool Page::hasPixmap( DocumentObserver *observer, int width, int height, const NormalizedRect &rect ) const
 {
-    TilesManager *tm = d->tilesManager( observer );
-    if ( tm )
-    {
-        if ( width != tm->width() || height != tm->height() )
-        {
-            tm->setSize( width, height );
-            return false;
-        }
-
-        return tm->hasPixmap( rect );
-    }
+    const bool found = d->hasPixmap( observer, width, height, rect );
 
-    QMap< DocumentObserver*, PagePrivate::PixmapObject >::const_iterator it = d->m_pixmaps.constFind( observer );
-    if ( it == d->m_pixmaps.constEnd() )
-        return false;
+    // [MEM] a whole page looked up by an observer is a pixmap cache access
+    if ( d->m_doc && width != -1 && height != -1 && !d->tilesManager( observer ) )
+        d->pixmapLookedUp( observer, found );
 
-    if ( width == -1 || height == -1 )
-        return true;
-
-    const QPixmap *pixmap = it.value().m_pixmap;
-
-    return (pixmap->width() == width && pixmap->height() == height);
+    return found;
 }
 
 bool Page::hasTextPage() const
@@ -255,10 +242,13 @@ bool Page::hasObjectRect( double x, double y, double xScale, double yScale ) con
     if ( m_rects.isEmpty() )
         return false;
 
-    QLinkedList< ObjectRect * >::const_iterator it = m_rects.begin(), end = m_rects.end();
-    for ( ; it != end; ++it )
-        if ( (*it)->distanceSqr( x, y, xScale, yScale ) < distanceConsideredEqual )
-            return true;
+    for ( int type = ObjectRect::Action; type <= ObjectRect::SourceRef; ++type )
+    {
+        const QVector< ObjectRect * > candidates = d->m_objectRectIndex.candidates( m_rects, (ObjectRect::ObjectType)type, x, y, xScale, yScale, d->m_width, distanceConsideredEqualPixels );
+        foreach ( const ObjectRect *objrect, candidates )
+            if ( objrect->distanceSqr( x, y, xScale, yScale ) < distanceConsideredEqual )
+                return true;
+    }
 
     return false;
 }
@@ -281,11 +271,13 @@ bool Page::hasHighlights( int s_id ) const
 
 bool Page::hasTransition() const
 {
+    d->loadPendingData();
     return d->m_transition != nullptr;
 }
 
 bool Page::hasAnnotations() const
 {
+    d->loadPendingData();
     return !m_annotations.isEmpty();
 }
 
@@ -399,6 +391,7 @@ void PagePrivate::rotateAt( Rotation orientation )
     QLinkedList< ObjectRect * >::const_iterator objectIt = m_page->m_rects.begin(), end = m_page->m_rects.end();
     for ( ; objectIt != end; ++objectIt )
         (*objectIt)->transform( matrix );
+    m_objectRectIndex.invalidate();
 
     QLinkedList< HighlightAreaRect* >::const_iterator hlIt = m_page->m_highlights.begin(), hlItEnd = m_page->m_highlights.end();
     for ( ; hlIt != hlItEnd; ++hlIt )
@@ -424,13 +417,11 @@ void PagePrivate::changeSize( const PageSize &size )
 
 const ObjectRect * Page::objectRect( ObjectRect::ObjectType type, double x, double y, double xScale, double yScale ) const
 {
-    // Walk list in reverse order so that annotations in the foreground are preferred
-    QLinkedListIterator< ObjectRect * > it( m_rects );
-    it.toBack();
-    while ( it.hasPrevious() )
+    // The candidates come in reverse order so that annotations in the foreground are preferred
+    const QVector< ObjectRect * > candidates = d->m_objectRectIndex.candidates( m_rects, type, x, y, xScale, yScale, d->m_width, distanceConsideredEqualPixels );
+    foreach ( const ObjectRect *objrect, candidates )
     {
-        const ObjectRect *objrect = it.previous();
-        if ( ( objrect->objectType() == type ) && objrect->distanceSqr( x, y, xScale, yScale ) < distanceConsideredEqual )
+        if ( objrect->distanceSqr( x, y, xScale, yScale ) < distanceConsideredEqual )
             return objrect;
     }
 
@@ -441,12 +432,10 @@ QLinkedList< const ObjectRect * > Page::objectRects( ObjectRect::ObjectType type
 {
     QLinkedList< const ObjectRect * > result;
 
-    QLinkedListIterator< ObjectRect * > it( m_rects );
-    it.toBack();
-    while ( it.hasPrevious() )
+    const QVector< ObjectRect * > candidates = d->m_objectRectIndex.candidates( m_rects, type, x, y, xScale, yScale, d->m_width, distanceConsideredEqualPixels );
+    foreach ( const ObjectRect *objrect, candidates )
     {
-        const ObjectRect *objrect = it.previous();
-        if ( ( objrect->objectType() == type ) && objrect->distanceSqr( x, y, xScale, yScale ) < distanceConsideredEqual )
+        if ( objrect->distanceSqr( x, y, xScale, yScale ) < distanceConsideredEqual )
             result.append( objrect );
     }
 
@@ -459,17 +448,14 @@ const ObjectRect* Page::nearestObjectRect( ObjectRect::ObjectType type, double x
     ObjectRect * res = nullptr;
     double minDistance = std::numeric_limits<double>::max();
 
-    QLinkedList< ObjectRect * >::const_iterator it = m_rects.constBegin(), end = m_rects.constEnd();
-    for ( ; it != end; ++it )
+    const QVector< ObjectRect * > &rects = d->m_objectRectIndex.rectsOfType( m_rects, type );
+    foreach ( ObjectRect *objrect, rects )
     {
-        if ( (*it)->objectType() == type )
+        double d = objrect->distanceSqr( x, y, xScale, yScale );
+        if ( d < minDistance )
         {
-            double d = (*it)->distanceSqr( x, y, xScale, yScale );
-            if ( d < minDistance )
-            {
-                res = (*it);
-                minDistance = d;
-            }
+            res = objrect;
+            minDistance = d;
         }
     }
 
@@ -480,16 +466,19 @@ const ObjectRect* Page::nearestObjectRect( ObjectRect::ObjectType type, double x
 
 const PageTransition * Page::transition() const
 {
+    d->loadPendingData();
     return d->m_transition;
 }
 
 QLinkedList< Annotation* > Page::annotations() const
 {
+    d->loadPendingData();
     return m_annotations;
 }
 
 const Action * Page::pageAction( PageAction action ) const
 {
+    d->loadPendingData();
     switch ( action )
     {
         case Page::Opening:
@@ -505,6 +494,7 @@ const Action * Page::pageAction( PageAction action ) const
 
 QLinkedList< FormField * > Page::formFields() const
 {
+    d->loadPendingData();
     return d->formfields;
 }
 
@@ -545,13 +535,20 @@ void Page::setTextPage( TextPage * textPage )
     delete d->m_text;
 
     d->m_text = textPage;
-    if ( d->m_text )
+    // text pages coming from a search are already prepared
+    if ( d->m_text && d->m_text->d->m_page != d )
     {
-        d->m_text->d->m_page = d;
         /**
          * Correct text order for before text selection
          */
-        d->m_text->d->correctTextOrder();
+        d->prepareTextPage( d->m_text );
+    }
+
+    // the searches go on where they were before the eviction
+    if ( d->m_text && !d->m_evictedSearchPoints.isEmpty() )
+    {
+        d->m_text->d->restoreSearchPoints( d->m_evictedSearchPoints );
+        d->m_evictedSearchPoints.clear();
     }
 }
 
@@ -571,6 +568,7 @@ void Page::setObjectRects( const QLinkedList< ObjectRect * > & rects )
         (*objectIt)->transform( matrix );
 
     m_rects << rects;
+    d->m_objectRectIndex.invalidate();
 }
 
 void PagePrivate::setHighlight( int s_id, RegularAreaRect *rect, const QColor & color )
@@ -600,6 +598,7 @@ void Page::setSourceReferences( const QLinkedList< SourceRefObjectRect * > & ref
     deleteSourceReferences();
     foreach( SourceRefObjectRect * rect, refRects )
         m_rects << rect;
+    d->m_objectRectIndex.invalidate();
 }
 
 void Page::setDuration( double seconds )
@@ -634,6 +633,8 @@ QColor Page::textSelectionColor() const
 
 void Page::addAnnotation( Annotation * annotation )
 {
+    d->loadPendingData();
+
     // Generate uniqueName: okular-{UUID}
     if(annotation->uniqueName().isEmpty())
     {
@@ -650,6 +651,7 @@ void Page::addAnnotation( Annotation * annotation )
     annotation->d_ptr->annotationTransform( matrix );
 
     m_rects.append( rect );
+    d->m_objectRectIndex.invalidate();
 }
 
 bool Page::removeAnnotation( Annotation * annotation )
@@ -671,6 +673,7 @@ bool Page::removeAnnotation( Annotation * annotation )
                     it = m_rects.erase( it );
                     rectfound = true;
                 }
+            d->m_objectRectIndex.invalidate();
             qCDebug(OkularCoreDebug) << "removed annotation:" << annotation->uniqueName();
             annotation->d_ptr->m_page = nullptr;
             m_annotations.erase( aIt );
@@ -748,6 +751,7 @@ void Page::deleteRects()
     QSet<ObjectRect::ObjectType> which;
     which << ObjectRect::Action << ObjectRect::Image;
     deleteObjectRects( m_rects, which );
+    d->m_objectRectIndex.invalidate();
 }
 
 void PagePrivate::deleteHighlights( int s_id )
@@ -776,12 +780,14 @@ void PagePrivate::deleteTextSelections()
 void Page::deleteSourceReferences()
 {
     deleteObjectRects( m_rects, QSet<ObjectRect::ObjectType>() << ObjectRect::SourceRef );
+    d->m_objectRectIndex.invalidate();
 }
 
 void Page::deleteAnnotations()
 {
     // delete ObjectRects of type Annotation
     deleteObjectRects( m_rects, QSet<ObjectRect::ObjectType>() << ObjectRect::OAnnotation );
+    d->m_objectRectIndex.invalidate();
     // delete all stored annotations
     QLinkedList< Annotation * >::const_iterator aIt = m_annotations.begin(), aEnd = m_annotations.end();
     for ( ; aIt != aEnd; ++aIt )
@@ -791,6 +797,30 @@ void Page::deleteAnnotations()
 
 void PagePrivate::restoreLocalContents( const QDomNode & pageNode )
 {
+    // the bounding box found when the page was last rendered, unless the
+    // paper color changed since
+    const QDomElement bboxElement = pageNode.firstChildElement( QStringLiteral("boundingBox") );
+    if ( !bboxElement.isNull() && !m_isBoundingBoxKnown
+         && bboxElement.attribute( QStringLiteral("paperColor") ) == SettingsCore::paperColor().name() )
+    {
+        const NormalizedRect bbox( bboxElement.attribute( QStringLiteral("l") ).toDouble(),
+                                   bboxElement.attribute( QStringLiteral("t") ).toDouble(),
+                                   bboxElement.attribute( QStringLiteral("r") ).toDouble(),
+                                   bboxElement.attribute( QStringLiteral("b") ).toDouble() );
+        if ( bbox.left >= 0 && bbox.left <= bbox.right && bbox.right <= 1
+             && bbox.top >= 0 && bbox.top <= bbox.bottom && bbox.bottom <= 1 )
+            m_page->setBoundingBox( bbox );
+    }
+
+    // the annotations and forms to restore may not be there yet, keep the
+    // contents until they are
+    if ( m_dataPending )
+    {
+        m_pendingLocalContents = QDomDocument();
+        m_pendingLocalContents.appendChild( m_pendingLocalContents.importNode( pageNode, true ) );
+        return;
+    }
+
     // iterate over all chilren (annotationList, ...)
     QDomNode childNode = pageNode.firstChild();
     while ( childNode.isElement() )
@@ -879,6 +909,35 @@ void PagePrivate::saveLocalContents( QDomNode & parentNode, QDomDocument & docum
     QDomElement pageElement = document.createElement( QStringLiteral("page") );
     pageElement.setAttribute( QStringLiteral("number"), m_number );
 
+    // add the bounding box, so that it is not computed again
+    if ( ( what & BoundingBoxPageItems ) && m_isBoundingBoxKnown )
+    {
+        QDomElement bboxElement = document.createElement( QStringLiteral("boundingBox") );
+        bboxElement.setAttribute( QStringLiteral("l"), QString::number( m_boundingBox.left ) );
+        bboxElement.setAttribute( QStringLiteral("t"), QString::number( m_boundingBox.top ) );
+        bboxElement.setAttribute( QStringLiteral("r"), QString::number( m_boundingBox.right ) );
+        bboxElement.setAttribute( QStringLiteral("b"), QString::number( m_boundingBox.bottom ) );
+        bboxElement.setAttribute( QStringLiteral("paperColor"), SettingsCore::paperColor().name() );
+        pageElement.appendChild( bboxElement );
+    }
+
+    // nothing could change before the data is loaded: save back what was
+    // restored
+    if ( m_dataPending )
+    {
+        QDomNode childNode = m_pendingLocalContents.documentElement().firstChild();
+        for ( ; childNode.isElement(); childNode = childNode.nextSibling() )
+        {
+            const QString tagName = childNode.toElement().tagName();
+            if ( ( ( what & AnnotationPageItems ) && tagName == QLatin1String("annotationList") )
+                 || ( ( what & FormFieldPageItems ) && tagName == QLatin1String("forms") ) )
+                pageElement.appendChild( document.importNode( childNode, true ) );
+        }
+        if ( pageElement.hasChildNodes() )
+            parentNode.appendChild( pageElement );
+        return;
+    }
+
 #if 0
     // add bookmark info if is bookmarked
     if ( d->m_bookmarked )
@@ -1008,6 +1067,103 @@ QList<Tile> Page::tilesAt( const DocumentObserver *observer, const NormalizedRec
         return QList<Tile>();
 }
 
+void PagePrivate::prepareTextPage( TextPage *textPage )
+{
+    textPage->d->m_page = this;
+    textPage->d->correctTextOrder();
+}
+
+qulonglong PagePrivate::textPageMemory() const
+{
+    return m_text ? m_text->d->memory() : 0;
+}
+
+RegularAreaRect *PagePrivate::findText( int id, const SearchPattern &pattern, SearchDirection direction ) const
+{
+    if ( !m_text )
+        return nullptr;
+
+    return m_text->d->findText( id, pattern, direction );
+}
+
+void PagePrivate::loadPendingData()
+{
+    if ( !m_dataPending )
+        return;
+
+    // cleared first, the generator adds the data through the Page API
+    m_dataPending = false;
+    if ( m_doc )
+        m_doc->loadPageData( m_page );
+}
+
+void PagePrivate::adoptRenderData( PagePrivate *previous, bool unchanged )
+{
+    // the pixmaps stay shown until new ones replace them
+    m_pixmaps = previous->m_pixmaps;
+    previous->m_pixmaps.clear();
+    m_tilesManagers = previous->m_tilesManagers;
+    previous->m_tilesManagers.clear();
+
+    if ( !unchanged )
+        return;
+
+    m_text = previous->m_text;
+    previous->m_text = nullptr;
+    if ( m_text )
+        m_text->d->m_page = this;
+    if ( previous->m_isBoundingBoxKnown )
+        m_page->setBoundingBox( previous->m_boundingBox );
+}
+
+void PagePrivate::evictTextPage()
+{
+    if ( !m_text )
+        return;
+
+    m_evictedSearchPoints = m_text->d->searchPoints();
+    delete m_text;
+    m_text = nullptr;
+}
+
+bool PagePrivate::hasPixmap( DocumentObserver *observer, int width, int height, const NormalizedRect &rect ) const
+{
+    TilesManager *tm = tilesManager( observer );
+    if ( tm )
+    {
+        if ( width != tm->width() || height != tm->height() )
+        {
+            tm->setSize( width, height );
+            return false;
+        }
+
+        return tm->hasPixmap( rect );
+    }
+
+    QMap< DocumentObserver*, PagePrivate::PixmapObject >::const_iterator it = m_pixmaps.constFind( observer );
+    if ( it == m_pixmaps.constEnd() )
+        return false;
+
+    if ( width == -1 || height == -1 )
+        return true;
+
+    const QPixmap *pixmap = it.value().m_pixmap;
+
+    return (pixmap->width() == width && pixmap->height() == height);
+}
+
+void PagePrivate::pixmapLookedUp( DocumentObserver *observer, bool found )
+{
+    // observers look their pages up on every repaint, count the lookups
+    // of a page once per current page change
+    quint64 &round = m_pixmapLookupRounds[ observer ];
+    if ( round == m_doc->m_pixmapLookupRound )
+        return;
+
+    round = m_doc->m_pixmapLookupRound;
+    m_doc->pixmapLookedUp( observer, m_number, found );
+}
+
 TilesManager *PagePrivate::tilesManager( const DocumentObserver *observer ) const
 {
     return m_tilesManagers.value( observer );
@@ -12,8 +12,10 @@
 #define _OKULAR_PAGE_PRIVATE_H_
 
 // qt/kde includes
+#include <qhash.h>
 #include <qlinkedlist.h>
 #include <qmap.h>
+#include <qpair.h>
 #include <qtransform.h>
 #include <qstring.h>
 #include <qdom.h>
@@ -21,6 +23,7 @@
 // local includes
 #include "global.h"
 #include "area.h"
+#include "objectrectindex_p.h"
 
 class QColor;
 
@@ -36,6 +39,7 @@ class Page;
 class PageSize;
 class PageTransition;
 class RotationJob;
+class SearchPattern;
 class TextPage;
 class TilesManager;
 
@@ -44,6 +48,7 @@ enum PageItem
     None = 0,
     AnnotationPageItems = 0x01,
     FormFieldPageItems = 0x02,
+    BoundingBoxPageItems = 0x04,
     AllPageItems = 0xff,
 
     /* If set along with AnnotationPageItems, tells saveLocalContents to save
@@ -106,6 +111,55 @@ class PagePrivate
          */
         void deleteTextSelections();
 
+        /**
+         * Ties @p textPage, not attached to any page yet, to this page and
+         * puts its words in reading order. Can run in a worker thread, as
+         * long as nobody else uses @p textPage meanwhile.
+         */
+        void prepareTextPage( TextPage *textPage );
+
+        /**
+         * Returns an estimate of the memory used by the text page, in bytes.
+         */
+        qulonglong textPageMemory() const;
+
+        /**
+         * Looks for @p pattern in the text page, as Page::findText does.
+         */
+        RegularAreaRect *findText( int id, const SearchPattern &pattern, SearchDirection direction ) const;
+
+        /**
+         * Deletes the text page to save memory. Its search points are kept
+         * for the next text page set, which is extracted again from the
+         * same page and so has the same text.
+         */
+        void evictTextPage();
+
+        /**
+         * Takes the pixmaps of @p previous, the same page before the document
+         * was reloaded, and if the page is @p unchanged also its text page
+         * and bounding box. The page must have the same size and rotation.
+         */
+        void adoptRenderData( PagePrivate *previous, bool unchanged );
+
+        /**
+         * Has the generator add the data left out when the page was created
+         * (annotations, form fields, ...), if not done yet. The local
+         * contents restored meanwhile are applied right after.
+         */
+        void loadPendingData();
+
+        /**
+         * Returns whether @p observer has a pixmap of the page, like
+         * Page::hasPixmap() but without counting it as a cache access.
+         */
+        bool hasPixmap( DocumentObserver *observer, int width, int height, const NormalizedRect &rect ) const;
+
+        /**
+         * Reports a lookup of the pixmap of @p observer to the document.
+         */
+        void pixmapLookedUp( DocumentObserver *observer, bool found );
+
         /**
          * Get the tiles manager for the tiled @observer
          */
@@ -124,6 +178,8 @@ class PagePrivate
         };
         QMap< DocumentObserver*, PixmapObject > m_pixmaps;
         QMap< const DocumentObserver*, TilesManager *> m_tilesManagers;
+        // the viewport change each observer last looked its pixmap up at
+        QHash< const DocumentObserver*, quint64 > m_pixmapLookupRounds;
 
         Page *m_page;
         int m_number;
@@ -134,6 +190,9 @@ class PagePrivate
         Rotation m_rotation;
 
         TextPage * m_text;
+        QMap< int, QPair< int, int > > m_evictedSearchPoints;
+        // looked up instead of m_page->m_rects, invalidated along with them
+        ObjectRectIndex m_objectRectIndex;
         PageTransition * m_transition;
         HighlightAreaRect *m_textSelections;
         QLinkedList< FormField * > formfields;
@@ -143,7 +202,10 @@ class PagePrivate
         QString m_label;
 
         bool m_isBoundingBoxKnown : 1;
+        // the generator has not added the annotations, form fields, ... yet
+        bool m_dataPending : 1;
         QDomDocument restoredLocalAnnotationList; // <annotationList>...</annotationList>
+        QDomDocument m_pendingLocalContents; // <page>...</page> to restore once the data is loaded
 };
 
 }
@@ -0,0 +1,292 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "pixmapevictionindex_p.h"
+
+#include <QtCore/QVector>
+
+#include "observer.h"
+
+using namespace Okular;
+
+PixmapEvictionIndex::PixmapEvictionIndex()
+    : m_count( 0 ), m_policy( Distance ), m_clock( 0 ), m_inflation( 0 )
+{
+}
+
+PixmapEvictionIndex::~PixmapEvictionIndex()
+{
+    clear();
+}
+
+void PixmapEvictionIndex::setPolicy( Policy policy )
+{
+    if ( policy == m_policy )
+        return;
+
+    m_policy = policy;
+    m_order.clear();
+    if ( m_policy == Distance )
+        return;
+
+    foreach ( const PageMap &pages, m_pixmaps )
+        foreach ( AllocatedPixmap *pixmap, pages )
+            addToOrder( pixmap );
+}
+
+PixmapEvictionIndex::Policy PixmapEvictionIndex::policy() const
+{
+    return m_policy;
+}
+
+void PixmapEvictionIndex::insert( AllocatedPixmap *pixmap )
+{
+    PageMap &pages = m_pixmaps[ pixmap->observer ];
+    Q_ASSERT( !pages.contains( pixmap->page ) );
+    pages.insert( pixmap->page, pixmap );
+    ++m_count;
+
+    // a descriptor taken and inserted back keeps its position
+    if ( pixmap->lastAccess == 0 )
+        pixmap->lastAccess = ++m_clock;
+    if ( pixmap->credit < 0 )
+        pixmap->credit = creditFor( pixmap );
+    if ( m_policy != Distance )
+        addToOrder( pixmap );
+}
+
+AllocatedPixmap *PixmapEvictionIndex::take( DocumentObserver *observer, int page )
+{
+    QHash< DocumentObserver *, PageMap >::iterator it = m_pixmaps.find( observer );
+    if ( it == m_pixmaps.end() )
+        return nullptr;
+
+    AllocatedPixmap *pixmap = it.value().take( page );
+    if ( !pixmap )
+        return nullptr;
+
+    if ( it.value().isEmpty() )
+        m_pixmaps.erase( it );
+    --m_count;
+    if ( m_policy != Distance )
+        removeFromOrder( pixmap );
+    return pixmap;
+}
+
+bool PixmapEvictionIndex::touch( DocumentObserver *observer, int page )
+{
+    AllocatedPixmap *pixmap = m_pixmaps.value( observer ).value( page, nullptr );
+    if ( !pixmap )
+        return false;
+
+    if ( m_policy != Distance )
+        removeFromOrder( pixmap );
+    pixmap->lastAccess = ++m_clock;
+    pixmap->credit = creditFor( pixmap );
+    if ( m_policy != Distance )
+        addToOrder( pixmap );
+    return true;
+}
+
+AllocatedPixmap *PixmapEvictionIndex::farthest( int viewportPage, bool unloadableOnly, bool thenRemoveIt, DocumentObserver *observer )
+{
+    const QList< AllocatedPixmap * > found = collect( viewportPage, unloadableOnly, observer, 0, 1 );
+    if ( found.isEmpty() )
+        return nullptr;
+
+    AllocatedPixmap *pixmap = found.first();
+    if ( thenRemoveIt )
+        take( pixmap->observer, pixmap->page );
+    return pixmap;
+}
+
+QList< AllocatedPixmap * > PixmapEvictionIndex::takeFarthest( int viewportPage, qulonglong bytes )
+{
+    if ( bytes == 0 )
+        return QList< AllocatedPixmap * >();
+
+    const QList< AllocatedPixmap * > found = collect( viewportPage, true, nullptr, bytes, 0 );
+    foreach ( AllocatedPixmap *pixmap, found )
+    {
+        take( pixmap->observer, pixmap->page );
+        evicted( pixmap );
+    }
+    return found;
+}
+
+qulonglong PixmapEvictionIndex::removeObserver( DocumentObserver *observer )
+{
+    const PageMap pages = m_pixmaps.take( observer );
+    qulonglong memory = 0;
+    foreach ( AllocatedPixmap *pixmap, pages )
+    {
+        memory += pixmap->memory;
+        if ( m_policy != Distance )
+            removeFromOrder( pixmap );
+    }
+    m_count -= pages.count();
+    qDeleteAll( pages );
+    return memory;
+}
+
+void PixmapEvictionIndex::clear()
+{
+    foreach ( const PageMap &pages, m_pixmaps )
+        qDeleteAll( pages );
+    m_pixmaps.clear();
+    m_order.clear();
+    m_count = 0;
+    m_clock = 0;
+    m_inflation = 0;
+}
+
+bool PixmapEvictionIndex::isEmpty() const
+{
+    return m_count == 0;
+}
+
+int PixmapEvictionIndex::count() const
+{
+    return m_count;
+}
+
+double PixmapEvictionIndex::evictionKey( const AllocatedPixmap *pixmap ) const
+{
+    if ( m_policy == LeastRecentlyUsed )
+        return pixmap->lastAccess;
+    return pixmap->credit;
+}
+
+/* GreedyDual-Size: the cost of bringing the pixmap back, per byte it uses */
+double PixmapEvictionIndex::creditFor( const AllocatedPixmap *pixmap ) const
+{
+    const double cost = qMax( pixmap->renderTime, 1 );
+    const double size = qMax( pixmap->memory, qulonglong( 1 ) );
+    return m_inflation + cost * 1024 * 1024 / size;
+}
+
+/* GreedyDual aging: the pixmaps left behind lose value relative to the
+ * ones accessed from now on
+ */
+void PixmapEvictionIndex::evicted( const AllocatedPixmap *pixmap )
+{
+    m_inflation = qMax( m_inflation, pixmap->credit );
+}
+
+void PixmapEvictionIndex::addToOrder( AllocatedPixmap *pixmap )
+{
+    m_order.insert( evictionKey( pixmap ), pixmap );
+}
+
+void PixmapEvictionIndex::removeFromOrder( AllocatedPixmap *pixmap )
+{
+    m_order.remove( evictionKey( pixmap ), pixmap );
+}
+
+/* Walks the pixmaps in eviction order. Stops once maxCount pixmaps were
+ * found or once their memory adds up to bytes (a zero value means no
+ * limit).
+ */
+QList< AllocatedPixmap * > PixmapEvictionIndex::collect( int viewportPage, bool unloadableOnly, DocumentObserver *observer, qulonglong bytes, int maxCount ) const
+{
+    if ( m_policy == Distance )
+        return collectByDistance( viewportPage, unloadableOnly, observer, bytes, maxCount );
+
+    QList< AllocatedPixmap * > found;
+    qulonglong foundMemory = 0;
+    QMultiMap< double, AllocatedPixmap * >::const_iterator it = m_order.constBegin(), itEnd = m_order.constEnd();
+    for ( ; it != itEnd; ++it )
+    {
+        AllocatedPixmap *pixmap = it.value();
+        if ( observer && pixmap->observer != observer )
+            continue;
+        if ( unloadableOnly && !pixmap->observer->canUnloadPixmap( pixmap->page ) )
+            continue;
+
+        found.append( pixmap );
+        foundMemory += pixmap->memory;
+        if ( maxCount > 0 && found.count() >= maxCount )
+            break;
+        if ( bytes > 0 && foundMemory >= bytes )
+            break;
+    }
+    return found;
+}
+
+/* Walks the pixmaps by decreasing distance from viewportPage, merging the
+ * two ends of the page order of every observer.
+ */
+QList< AllocatedPixmap * > PixmapEvictionIndex::collectByDistance( int viewportPage, bool unloadableOnly, DocumentObserver *observer, qulonglong bytes, int maxCount ) const
+{
+    struct Cursor
+    {
+        PageMap::const_iterator low;
+        PageMap::const_iterator high; // one past the last candidate
+    };
+
+    QVector< Cursor > cursors;
+    QHash< DocumentObserver *, PageMap >::const_iterator it = m_pixmaps.constBegin(), itEnd = m_pixmaps.constEnd();
+    for ( ; it != itEnd; ++it )
+    {
+        if ( observer && it.key() != observer )
+            continue;
+        Cursor cursor;
+        cursor.low = it.value().constBegin();
+        cursor.high = it.value().constEnd();
+        cursors.append( cursor );
+    }
+
+    QList< AllocatedPixmap * > found;
+    qulonglong foundMemory = 0;
+    while ( true )
+    {
+        int bestCursor = -1;
+        bool bestIsLow = true;
+        int maxDistance = -1;
+        for ( int i = 0; i < cursors.count(); ++i )
+        {
+            const Cursor &cursor = cursors.at( i );
+            if ( cursor.low == cursor.high )
+                continue;
+
+            const int lowDistance = qAbs( cursor.low.key() - viewportPage );
+            const int highDistance = qAbs( ( cursor.high - 1 ).key() - viewportPage );
+            const bool isLow = lowDistance >= highDistance;
+            const int distance = isLow ? lowDistance : highDistance;
+            if ( distance > maxDistance )
+            {
+                maxDistance = distance;
+                bestCursor = i;
+                bestIsLow = isLow;
+            }
+        }
+
+        /* No pixmap left */
+        if ( bestCursor == -1 )
+            break;
+
+        Cursor &cursor = cursors[ bestCursor ];
+        AllocatedPixmap *pixmap;
+        if ( bestIsLow )
+            pixmap = *( cursor.low++ );
+        else
+            pixmap = *( --cursor.high );
+
+        if ( unloadableOnly && !pixmap->observer->canUnloadPixmap( pixmap->page ) )
+            continue;
+
+        found.append( pixmap );
+        foundMemory += pixmap->memory;
+        if ( maxCount > 0 && found.count() >= maxCount )
+            break;
+        if ( bytes > 0 && foundMemory >= bytes )
+            break;
+    }
+    return found;
+}
@@ -0,0 +1,155 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_PIXMAPEVICTIONINDEX_P_H_
+#define _OKULAR_PIXMAPEVICTIONINDEX_P_H_
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QMultiMap>
+
+namespace Okular {
+class DocumentObserver;
+}
+
+struct AllocatedPixmap
+{
+    // owner of the page
+    Okular::DocumentObserver *observer;
+    int page;
+    qulonglong memory;
+    // time it took to render, in milliseconds
+    int renderTime;
+    // bookkeeping of the PixmapEvictionIndex
+    quint64 lastAccess;
+    double credit;
+    // public constructor: initialize data
+    AllocatedPixmap( Okular::DocumentObserver *o, int p, qulonglong m, int t = 0 )
+        : observer( o ), page( p ), memory( m ), renderTime( t ), lastAccess( 0 ), credit( -1 ) {}
+};
+
+namespace Okular {
+
+/**
+ * @short The allocation descriptors of the pixmaps held by the pages.
+ *
+ * Descriptors are kept per observer, ordered by page number. As the
+ * distance from the viewport page grows towards both ends of that order,
+ * the farthest pixmaps are found by walking inwards from the ends, so
+ * moving the viewport does not require any update of the index.
+ *
+ * With the LeastRecentlyUsed and CostWeighted policies the descriptors are
+ * also kept in eviction order: by last access for the former, and by the
+ * GreedyDual-Size credit (render time per byte, plus an inflation value
+ * raised to the credit of every evicted pixmap) for the latter. The
+ * victims are then taken from the front of that order instead.
+ *
+ * Whether a pixmap can be unloaded is asked to its observer while walking;
+ * pixmaps that cannot be unloaded are the visible ones, which are close
+ * to the viewport page and thus the last ones to be visited.
+ *
+ * The index owns the descriptors it contains.
+ */
+class PixmapEvictionIndex
+{
+    public:
+        enum Policy
+        {
+            Distance,           ///< Evict the pixmaps farthest from the viewport first
+            LeastRecentlyUsed,  ///< Evict the pixmaps accessed least recently first
+            CostWeighted        ///< Evict the pixmaps cheapest to render again first
+        };
+
+        PixmapEvictionIndex();
+        ~PixmapEvictionIndex();
+
+        /**
+         * Sets the eviction policy, reordering the index if needed.
+         */
+        void setPolicy( Policy policy );
+        Policy policy() const;
+
+        /**
+         * Adds @p pixmap to the index. There must not be another descriptor
+         * for the same observer and page.
+         */
+        void insert( AllocatedPixmap *pixmap );
+
+        /**
+         * Removes and returns the descriptor for @p observer and @p page,
+         * or 0 if there is none.
+         */
+        AllocatedPixmap *take( DocumentObserver *observer, int page );
+
+        /**
+         * Marks the pixmap of @p observer for @p page as just accessed.
+         * Returns false if there is no such pixmap.
+         */
+        bool touch( DocumentObserver *observer, int page );
+
+        /**
+         * Returns the next pixmap to evict according to the policy (the
+         * pixmap farthest from @p viewportPage for Distance), optionally
+         * restricted to unloadable pixmaps and to the pixmaps of
+         * @p observer. If @p thenRemoveIt is set the descriptor is removed
+         * from the index and owned by the caller, who calls evicted() if
+         * the pixmap is freed rather than inserted back.
+         */
+        AllocatedPixmap *farthest( int viewportPage, bool unloadableOnly, bool thenRemoveIt, DocumentObserver *observer = nullptr );
+
+        /**
+         * Removes, in a single pass, the next unloadable pixmaps to evict
+         * until their memory adds up to @p bytes or no pixmap is left. The
+         * descriptors are owned by the caller.
+         */
+        QList< AllocatedPixmap * > takeFarthest( int viewportPage, qulonglong bytes );
+
+        /**
+         * Notes that the pixmap of @p pixmap, no longer in the index, was
+         * freed; this ages the pixmaps left for the CostWeighted policy.
+         * takeFarthest() does it for the pixmaps it returns.
+         */
+        void evicted( const AllocatedPixmap *pixmap );
+
+        /**
+         * Deletes the descriptors of @p observer and returns their memory.
+         */
+        qulonglong removeObserver( DocumentObserver *observer );
+
+        /**
+         * Deletes all the descriptors.
+         */
+        void clear();
+
+        bool isEmpty() const;
+        int count() const;
+
+    private:
+        typedef QMap< int, AllocatedPixmap * > PageMap;
+
+        QList< AllocatedPixmap * > collect( int viewportPage, bool unloadableOnly, DocumentObserver *observer, qulonglong bytes, int maxCount ) const;
+        QList< AllocatedPixmap * > collectByDistance( int viewportPage, bool unloadableOnly, DocumentObserver *observer, qulonglong bytes, int maxCount ) const;
+        double evictionKey( const AllocatedPixmap *pixmap ) const;
+        double creditFor( const AllocatedPixmap *pixmap ) const;
+        void addToOrder( AllocatedPixmap *pixmap );
+        void removeFromOrder( AllocatedPixmap *pixmap );
+
+        QHash< DocumentObserver *, PageMap > m_pixmaps;
+        // eviction order, unused for the Distance policy
+        QMultiMap< double, AllocatedPixmap * > m_order;
+        int m_count;
+        Policy m_policy;
+        quint64 m_clock;
+        double m_inflation;
+};
+
+}
+
+#endif
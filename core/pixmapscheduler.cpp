@@ -0,0 +1,262 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "pixmapscheduler_p.h"
+
+#include <algorithm>
+
+#include "generator.h"
+#include "generator_p.h"
+
+using namespace Okular;
+
+namespace Okular {
+
+uint qHash( const PixmapScheduler::RequestKey &key, uint seed )
+{
+    uint h = ::qHash( key.observer, seed );
+    h = h * 31 + ::qHash( key.page, seed );
+    h = h * 31 + ::qHash( key.width, seed );
+    h = h * 31 + ::qHash( key.height, seed );
+    if ( key.tile )
+    {
+        h = h * 31 + ::qHash( key.left, seed );
+        h = h * 31 + ::qHash( key.top, seed );
+        h = h * 31 + ::qHash( key.right, seed );
+        h = h * 31 + ::qHash( key.bottom, seed );
+    }
+    return h;
+}
+
+}
+
+bool PixmapScheduler::RequestKey::operator==( const RequestKey &other ) const
+{
+    return observer == other.observer && page == other.page
+        && width == other.width && height == other.height
+        && tile == other.tile
+        && left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+}
+
+PixmapScheduler::PixmapScheduler()
+    : m_nextSequence( 1 ), m_viewportPage( 0 ), m_queued( 0 ), m_coalesced( 0 ), m_dropped( 0 )
+{
+}
+
+PixmapScheduler::~PixmapScheduler()
+{
+    clear();
+}
+
+PixmapScheduler::RequestKey PixmapScheduler::keyFor( const PixmapRequest *request )
+{
+    RequestKey key;
+    key.observer = request->observer();
+    key.page = request->pageNumber();
+    key.width = request->width();
+    key.height = request->height();
+    key.tile = request->isTile();
+    const NormalizedRect &rect = request->normalizedRect();
+    key.left = rect.left;
+    key.top = rect.top;
+    key.right = rect.right;
+    key.bottom = rect.bottom;
+    return key;
+}
+
+/* std heaps keep the "largest" element on top, so an entry is "less" than
+ * another one when it should be served after it.
+ */
+bool PixmapScheduler::lessUrgent( const Entry &e1, const Entry &e2 )
+{
+    if ( e1.priority != e2.priority )
+        return e1.priority > e2.priority;
+    if ( e1.preview != e2.preview )
+        return !e1.preview;
+    if ( e1.preload != e2.preload )
+        return e1.preload;
+    if ( e1.distance != e2.distance )
+        return e1.distance > e2.distance;
+    return e1.sequence > e2.sequence;
+}
+
+PixmapScheduler::Entry PixmapScheduler::makeEntry( PixmapRequest *request, quint64 sequence ) const
+{
+    Entry entry;
+    entry.request = request;
+    entry.sequence = sequence;
+    entry.priority = request->priority();
+    entry.distance = qAbs( request->pageNumber() - m_viewportPage );
+    entry.preview = request->isPreview();
+    entry.preload = request->preload();
+    return entry;
+}
+
+bool PixmapScheduler::isLive( const Entry &entry ) const
+{
+    QHash< PixmapRequest *, LiveRequest >::const_iterator it = m_live.constFind( entry.request );
+    return it != m_live.constEnd() && it.value().sequence == entry.sequence;
+}
+
+void PixmapScheduler::setViewportPage( int page )
+{
+    if ( page == m_viewportPage )
+        return;
+
+    m_viewportPage = page;
+    rebuild();
+}
+
+void PixmapScheduler::enqueue( PixmapRequest *request )
+{
+    ++m_queued;
+
+    const RequestKey key = keyFor( request );
+    PixmapRequest *queued = m_byKey.value( key, nullptr );
+    if ( queued )
+    {
+        // coalesce: the new request replaces the queued one
+        ++m_coalesced;
+        request->d->mForce = request->d->mForce || queued->d->mForce;
+        m_live.remove( queued );
+        delete queued;
+    }
+
+    LiveRequest live;
+    live.sequence = m_nextSequence++;
+    live.key = key;
+    m_live.insert( request, live );
+    m_byKey.insert( key, request );
+    m_heap.append( makeEntry( request, live.sequence ) );
+    std::push_heap( m_heap.begin(), m_heap.end(), lessUrgent );
+
+    if ( m_heap.count() > 2 * m_live.count() + 32 )
+        rebuild();
+}
+
+void PixmapScheduler::removeStaleTop()
+{
+    while ( !m_heap.isEmpty() && !isLive( m_heap.first() ) )
+    {
+        std::pop_heap( m_heap.begin(), m_heap.end(), lessUrgent );
+        m_heap.removeLast();
+    }
+}
+
+PixmapRequest *PixmapScheduler::top()
+{
+    removeStaleTop();
+    return m_heap.isEmpty() ? nullptr : m_heap.first().request;
+}
+
+void PixmapScheduler::skip( PixmapRequest *request )
+{
+    if ( top() != request )
+        return;
+
+    std::pop_heap( m_heap.begin(), m_heap.end(), lessUrgent );
+    m_skipped.append( m_heap.takeLast() );
+}
+
+void PixmapScheduler::unskipAll()
+{
+    foreach ( const Entry &entry, m_skipped )
+    {
+        if ( !isLive( entry ) )
+            continue;
+        m_heap.append( entry );
+        std::push_heap( m_heap.begin(), m_heap.end(), lessUrgent );
+    }
+    m_skipped.clear();
+}
+
+bool PixmapScheduler::remove( PixmapRequest *request )
+{
+    QHash< PixmapRequest *, LiveRequest >::iterator it = m_live.find( request );
+    if ( it == m_live.end() )
+        return false;
+
+    const RequestKey key = it.value().key;
+    m_live.erase( it );
+    if ( m_byKey.value( key, nullptr ) == request )
+        m_byKey.remove( key );
+
+    // cheap path: the request is usually the one on top
+    removeStaleTop();
+    return true;
+}
+
+void PixmapScheduler::drop( PixmapRequest *request )
+{
+    if ( remove( request ) )
+    {
+        ++m_dropped;
+        delete request;
+    }
+}
+
+void PixmapScheduler::clear()
+{
+    qDeleteAll( m_live.keys() );
+    m_live.clear();
+    m_byKey.clear();
+    m_heap.clear();
+    m_skipped.clear();
+}
+
+QList< PixmapRequest * > PixmapScheduler::requests() const
+{
+    return m_live.keys();
+}
+
+bool PixmapScheduler::isEmpty() const
+{
+    return m_live.isEmpty();
+}
+
+int PixmapScheduler::count() const
+{
+    return m_live.count();
+}
+
+qulonglong PixmapScheduler::queuedCount() const
+{
+    return m_queued;
+}
+
+qulonglong PixmapScheduler::coalescedCount() const
+{
+    return m_coalesced;
+}
+
+qulonglong PixmapScheduler::droppedCount() const
+{
+    return m_dropped;
+}
+
+void PixmapScheduler::resetCounters()
+{
+    m_queued = 0;
+    m_coalesced = 0;
+    m_dropped = 0;
+}
+
+void PixmapScheduler::rebuild()
+{
+    QVector< Entry > heap;
+    heap.reserve( m_live.count() );
+    QHash< PixmapRequest *, LiveRequest >::const_iterator it = m_live.constBegin(), itEnd = m_live.constEnd();
+    for ( ; it != itEnd; ++it )
+        heap.append( makeEntry( it.key(), it.value().sequence ) );
+
+    std::make_heap( heap.begin(), heap.end(), lessUrgent );
+    m_heap = heap;
+    // the skipped entries are back in the heap
+    m_skipped.clear();
+}
@@ -0,0 +1,160 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_PIXMAPSCHEDULER_P_H_
+#define _OKULAR_PIXMAPSCHEDULER_P_H_
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QVector>
+
+namespace Okular {
+
+class DocumentObserver;
+class PixmapRequest;
+
+/**
+ * @short The queue of the pixmap requests waiting for the generator.
+ *
+ * Requests are kept in a binary heap ordered by the priority given by their
+ * observer, then previews before full renders, then visible pages before
+ * preloads, then by distance from the current viewport page, and finally by
+ * arrival order.
+ *
+ * Requests for the same observer, page, size and area are coalesced: the
+ * newest one replaces the one already queued.
+ *
+ * Removal is lazy: a removed request leaves a stale entry in the heap that
+ * is skipped when it reaches the top, and the heap is compacted when stale
+ * entries outnumber the live ones.
+ *
+ * The scheduler owns the queued requests. It is not thread safe, callers
+ * must hold DocumentPrivate::m_pixmapRequestsMutex.
+ */
+class PixmapScheduler
+{
+    public:
+        PixmapScheduler();
+        ~PixmapScheduler();
+
+        /**
+         * Sets the page the distances are computed from. Queued requests
+         * are reordered if the page changed.
+         */
+        void setViewportPage( int page );
+
+        /**
+         * Adds @p request to the queue, replacing (and deleting) a queued
+         * request for the same observer, page, size and area.
+         */
+        void enqueue( PixmapRequest *request );
+
+        /**
+         * Returns the request that should be served next, or 0 if the queue
+         * is empty. The request stays in the queue.
+         */
+        PixmapRequest *top();
+
+        /**
+         * Sets aside @p request, which must be the one on top, so that
+         * top() returns the next one. The request stays queued, and is put
+         * back in its place by unskipAll().
+         */
+        void skip( PixmapRequest *request );
+        void unskipAll();
+
+        /**
+         * Removes @p request from the queue without deleting it.
+         */
+        bool remove( PixmapRequest *request );
+
+        /**
+         * Removes @p request from the queue and deletes it, counting it as
+         * a request that was dropped without being rendered.
+         */
+        void drop( PixmapRequest *request );
+
+        /**
+         * Deletes all the queued requests.
+         */
+        void clear();
+
+        /**
+         * Returns the queued requests, in no particular order.
+         */
+        QList< PixmapRequest * > requests() const;
+
+        bool isEmpty() const;
+        int count() const;
+
+        /**
+         * Statistics since the last resetCounters(): requests that entered
+         * the queue, requests merged with a queued one and requests dropped
+         * without being rendered.
+         */
+        qulonglong queuedCount() const;
+        qulonglong coalescedCount() const;
+        qulonglong droppedCount() const;
+        void resetCounters();
+
+    private:
+        struct Entry
+        {
+            PixmapRequest *request;
+            quint64 sequence;
+            int priority;
+            int distance;
+            bool preview;
+            bool preload;
+        };
+
+        struct RequestKey
+        {
+            DocumentObserver *observer;
+            int page;
+            int width;
+            int height;
+            bool tile;
+            double left, top, right, bottom;
+
+            bool operator==( const RequestKey &other ) const;
+        };
+        friend uint qHash( const RequestKey &key, uint seed );
+
+        // the key is remembered as the request may be modified while queued
+        struct LiveRequest
+        {
+            quint64 sequence;
+            RequestKey key;
+        };
+
+        static RequestKey keyFor( const PixmapRequest *request );
+        static bool lessUrgent( const Entry &e1, const Entry &e2 );
+        Entry makeEntry( PixmapRequest *request, quint64 sequence ) const;
+        bool isLive( const Entry &entry ) const;
+        void removeStaleTop();
+        void rebuild();
+
+        QVector< Entry > m_heap;
+        // entries taken off the heap by skip()
+        QVector< Entry > m_skipped;
+        // live requests, mapped to the sequence number of their heap entry
+        QHash< PixmapRequest *, LiveRequest > m_live;
+        QHash< RequestKey, PixmapRequest * > m_byKey;
+        quint64 m_nextSequence;
+        int m_viewportPage;
+
+        qulonglong m_queued;
+        qulonglong m_coalesced;
+        qulonglong m_dropped;
+};
+
+}
+
+#endif
@@ -0,0 +1,333 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "textindex_p.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+
+#include <algorithm>
+
+#include <threadweaver/job.h>
+#include <threadweaver/qobjectdecorator.h>
+#include <threadweaver/queueing.h>
+
+#include "debug_p.h"
+#include "generator.h"
+#include "page.h"
+#include "textpage.h"
+
+using namespace Okular;
+
+namespace {
+
+typedef QHash< QString, QVector< qint32 > > Postings;
+
+static const quint32 indexFileMagic = 0x4f4b5449; // "OKTI"
+static const quint32 indexFileVersion = 2;
+static const int trigramLength = 3;
+
+// the pages are added in order, each word keeps them sorted
+void addPage( Postings &postings, int page, const QString &text )
+{
+    foreach ( const QString &word, TextIndex::words( text, true ) )
+    {
+        QVector< qint32 > &pages = postings[ word ];
+        if ( pages.isEmpty() || pages.last() != page )
+            pages.append( page );
+    }
+}
+
+}
+
+void TextIndexVocabulary::build( const Postings &postings )
+{
+    clear();
+
+    words = postings.keys();
+    std::sort( words.begin(), words.end() );
+    pages.reserve( words.count() );
+    for ( int i = 0; i < words.count(); ++i )
+    {
+        const QString &word = words.at( i );
+        pages.append( postings.value( word ) );
+        for ( int j = 0; j + trigramLength <= word.length(); ++j )
+        {
+            QVector< qint32 > &trigramWords = trigrams[ word.mid( j, trigramLength ) ];
+            if ( trigramWords.isEmpty() || trigramWords.last() != i )
+                trigramWords.append( i );
+        }
+    }
+}
+
+void TextIndexVocabulary::clear()
+{
+    words.clear();
+    pages.clear();
+    trigrams.clear();
+}
+
+namespace Okular {
+
+class TextIndexJobInternal : public ThreadWeaver::Job
+{
+    public:
+        TextIndexJobInternal( const QString &fileName, qint64 stamp, Generator *generator, const QVector< Page * > &pages, const QAtomicInt *cancelled, int generation )
+            : mFileName( fileName ), mStamp( stamp ), mGenerator( generator ), mPages( pages ), mCancelled( cancelled ),
+              mGeneration( generation ), mReady( false )
+        {
+        }
+
+        const QString mFileName;
+        const qint64 mStamp;
+        Generator * const mGenerator;
+        const QVector< Page * > mPages;
+        const QAtomicInt *mCancelled;
+        const int mGeneration;
+        TextIndexVocabulary mVocabulary;
+        bool mReady;
+
+    protected:
+        void run( ThreadWeaver::JobPointer, ThreadWeaver::Thread * ) override
+        {
+            Postings postings;
+            if ( load( postings ) )
+            {
+                mVocabulary.build( postings );
+                mReady = true;
+                return;
+            }
+
+            for ( int i = 0; i < mPages.count(); ++i )
+            {
+                // stop within a page of being closed
+                if ( mCancelled->load() )
+                    return;
+
+                TextPage *textPage = mGenerator->textPage( mPages.at( i ) );
+                if ( textPage )
+                    addPage( postings, i, textPage->text() );
+                delete textPage;
+            }
+
+            save( postings );
+            mVocabulary.build( postings );
+            mReady = true;
+        }
+
+    private:
+        bool load( Postings &postings )
+        {
+            QFile file( mFileName );
+            if ( !file.open( QIODevice::ReadOnly ) )
+                return false;
+
+            QDataStream stream( &file );
+            stream.setVersion( QDataStream::Qt_5_0 );
+            quint32 magic, version;
+            qint64 stamp;
+            qint32 pageCount;
+            stream >> magic >> version >> stamp >> pageCount;
+            if ( magic != indexFileMagic || version != indexFileVersion || stamp != mStamp || pageCount != mPages.count() )
+                return false;
+
+            stream >> postings;
+            if ( stream.status() != QDataStream::Ok )
+            {
+                postings.clear();
+                return false;
+            }
+            return true;
+        }
+
+        void save( const Postings &postings )
+        {
+            QSaveFile file( mFileName );
+            if ( !file.open( QIODevice::WriteOnly ) )
+                return;
+
+            QDataStream stream( &file );
+            stream.setVersion( QDataStream::Qt_5_0 );
+            stream << indexFileMagic << indexFileVersion << mStamp << (qint32)mPages.count() << postings;
+            if ( !file.commit() )
+                qCWarning(OkularCoreDebug) << "Could not save the text index" << mFileName;
+        }
+};
+
+class TextIndexJob : public ThreadWeaver::QObjectDecorator
+{
+    public:
+        TextIndexJob( TextIndexJobInternal *job )
+            : ThreadWeaver::QObjectDecorator( job )
+        {
+        }
+
+        TextIndexJobInternal *internal() { return static_cast< TextIndexJobInternal * >( job() ); }
+};
+
+}
+
+TextIndex::TextIndex()
+    : QObject(), m_generation( 0 ), m_pageCount( 0 ), m_ready( false )
+{
+    m_weaver.setMaximumNumberOfThreads( 1 );
+}
+
+TextIndex::~TextIndex()
+{
+    close();
+}
+
+QString TextIndex::fileName( const QString &docDataFileName )
+{
+    QString name = docDataFileName;
+    if ( name.endsWith( QLatin1String( ".xml" ) ) )
+        name.chop( 4 );
+    return name + QStringLiteral( ".textindex" );
+}
+
+void TextIndex::open( const QString &fileName, qint64 stamp, Generator *generator, const QVector< Page * > &pages )
+{
+    close();
+
+    m_fileName = fileName;
+    m_pageCount = pages.count();
+    TextIndexJob *job = new TextIndexJob( new TextIndexJobInternal( fileName, stamp, generator, pages, &m_cancelled, m_generation ) );
+    connect( job, SIGNAL(done(ThreadWeaver::JobPointer)),
+             this, SLOT(jobDone(ThreadWeaver::JobPointer)) );
+    ThreadWeaver::enqueue( &m_weaver, job );
+}
+
+void TextIndex::close()
+{
+    // the job uses the pages and the generator, wait for it
+    m_cancelled.store( 1 );
+    m_weaver.dequeue();
+    m_weaver.finish();
+    m_cancelled.store( 0 );
+    // a job done meanwhile is still to be delivered
+    ++m_generation;
+
+    m_fileName.clear();
+    m_vocabulary.clear();
+    m_pageCount = 0;
+    m_ready = false;
+}
+
+QString TextIndex::fileName() const
+{
+    return m_fileName;
+}
+
+bool TextIndex::isReady() const
+{
+    return m_ready;
+}
+
+QVector< bool > TextIndex::candidatePages( const QString &text ) const
+{
+    // the indexed text was normalized by TextPage::append()
+    const QStringList queryWords = words( text.normalized( QString::NormalizationForm_KC ) );
+    if ( !m_ready || queryWords.isEmpty() )
+        return QVector< bool >();
+
+    // the text may start or end in the middle of a word: a query word
+    // matches every indexed word containing it. Those are among the words
+    // containing its rarest trigram; shorter query words do not narrow the
+    // search down
+    QVector< bool > candidates( m_pageCount, true );
+    foreach ( const QString &queryWord, queryWords )
+    {
+        if ( queryWord.length() < trigramLength )
+            continue;
+
+        const QVector< qint32 > *rarest = nullptr;
+        for ( int j = 0; j + trigramLength <= queryWord.length(); ++j )
+        {
+            QHash< QString, QVector< qint32 > >::const_iterator it = m_vocabulary.trigrams.constFind( queryWord.mid( j, trigramLength ) );
+            if ( it == m_vocabulary.trigrams.constEnd() )
+                return QVector< bool >( m_pageCount, false );
+            if ( !rarest || it.value().count() < rarest->count() )
+                rarest = &it.value();
+        }
+
+        QVector< bool > wordPages( m_pageCount, false );
+        foreach ( qint32 i, *rarest )
+        {
+            if ( !m_vocabulary.words.at( i ).contains( queryWord ) )
+                continue;
+
+            foreach ( qint32 page, m_vocabulary.pages.at( i ) )
+            {
+                if ( page < m_pageCount )
+                    wordPages[ page ] = true;
+            }
+        }
+
+        for ( int page = 0; page < m_pageCount; ++page )
+            candidates[ page ] = candidates.at( page ) && wordPages.at( page );
+    }
+    return candidates;
+}
+
+QStringList TextIndex::words( const QString &text, bool joinHyphenated )
+{
+    QStringList result;
+    QString word;
+    bool hyphenated = false;
+    const int length = text.length();
+    for ( int i = 0; i <= length; ++i )
+    {
+        const QChar c = i < length ? text.at( i ) : QChar();
+        if ( c.isLetterOrNumber() || c.isMark() )
+        {
+            word += c;
+            continue;
+        }
+
+        if ( word.isEmpty() )
+            continue;
+
+        const QString folded = word.toCaseFolded();
+        result.append( folded );
+        // a word hyphenated at the end of a line is also there whole
+        if ( hyphenated )
+            result.append( result.at( result.count() - 2 ) + folded );
+        hyphenated = joinHyphenated && c == QLatin1Char( '-' ) && i + 1 < length && text.at( i + 1 ) == QLatin1Char( '\n' );
+        word.clear();
+    }
+    return result;
+}
+
+void TextIndex::setPageTexts( const QStringList &pageTexts )
+{
+    close();
+
+    Postings postings;
+    for ( int i = 0; i < pageTexts.count(); ++i )
+        addPage( postings, i, pageTexts.at( i ) );
+    m_vocabulary.build( postings );
+    m_pageCount = pageTexts.count();
+    m_ready = true;
+}
+
+void TextIndex::jobDone( const ThreadWeaver::JobPointer &j )
+{
+    TextIndexJob *job = static_cast< TextIndexJob * >( j.data() );
+    if ( job->internal()->mGeneration != m_generation || !job->internal()->mReady )
+        return;
+
+    m_vocabulary = job->internal()->mVocabulary;
+    job->internal()->mVocabulary.clear();
+    m_ready = true;
+    qCDebug(OkularCoreDebug) << "Text index ready," << m_vocabulary.words.count() << "words";
+}
+
+#include "moc_textindex_p.cpp"
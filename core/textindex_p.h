@@ -0,0 +1,125 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_TEXTINDEX_P_H_
+#define _OKULAR_TEXTINDEX_P_H_
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include <threadweaver/queue.h>
+
+namespace Okular {
+
+class Generator;
+class Page;
+
+/**
+ * The sorted words of a text index, the pages each of them is on, and the
+ * words each trigram is found in, to look words up by substring.
+ */
+struct TextIndexVocabulary
+{
+    void build( const QHash< QString, QVector< qint32 > > &postings );
+    void clear();
+
+    QStringList words;
+    QVector< QVector< qint32 > > pages;
+    QHash< QString, QVector< qint32 > > trigrams;
+};
+
+/**
+ * @short An inverted index of the text of a document.
+ *
+ * The index maps the case folded words of the document to the pages they
+ * are on. It is kept in a file
+ * next to the docdata of the document: opening the index loads that file
+ * in a background thread, or builds the index there by extracting the text
+ * of every page and then saves it.
+ *
+ * The index only ever narrows a search down: candidatePages() tells which
+ * pages may contain a text, the exact match still has to be done on the
+ * text page of those.
+ */
+class TextIndex : public QObject
+{
+    Q_OBJECT
+
+    public:
+        TextIndex();
+        ~TextIndex();
+
+        /**
+         * Returns the file of the index of the document whose docdata is in
+         * @p docDataFileName.
+         */
+        static QString fileName( const QString &docDataFileName );
+
+        /**
+         * Starts loading the index from @p fileName, or building it from
+         * the @p pages of the document with @p generator. @p stamp
+         * identifies the version of the document file, an index saved for
+         * another one is built again.
+         */
+        void open( const QString &fileName, qint64 stamp, Generator *generator, const QVector< Page * > &pages );
+
+        /**
+         * Stops loading or building the index, and forgets it.
+         */
+        void close();
+
+        /**
+         * Returns the file of the index opened last, if not closed since.
+         */
+        QString fileName() const;
+
+        /**
+         * Returns whether the index is loaded and can be queried.
+         */
+        bool isReady() const;
+
+        /**
+         * Returns for each page whether it may contain @p text, or an empty
+         * vector if the index cannot tell, e.g. because it is not ready or
+         * @p text has no words.
+         */
+        QVector< bool > candidatePages( const QString &text ) const;
+
+        /**
+         * Splits @p text into case folded words. With @p joinHyphenated,
+         * words hyphenated at the end of a line are also returned joined.
+         */
+        static QStringList words( const QString &text, bool joinHyphenated = false );
+
+        /**
+         * Builds the index in memory from the text of each page, as the
+         * background job does; meant for testing.
+         */
+        void setPageTexts( const QStringList &pageTexts );
+
+    private Q_SLOTS:
+        void jobDone( const ThreadWeaver::JobPointer &job );
+
+    private:
+        ThreadWeaver::Queue m_weaver;
+        QAtomicInt m_cancelled;
+        int m_generation;
+        QString m_fileName;
+        TextIndexVocabulary m_vocabulary;
+        int m_pageCount;
+        bool m_ready;
+};
+
+}
+
+#endif
@@ -18,7 +18,9 @@
 #include "page.h"
 #include "page_p.h"
 
+#include <algorithm>
 #include <cstring>
+#include <iterator>
 
 #include <QtAlgorithms>
 #include <QVarLengthArray>
@@ -29,37 +31,276 @@ class SearchPoint
 {
     public:
         SearchPoint()
-            : offset_begin( -1 ), offset_end( -1 )
+            : begin( -1 ), end( -1 )
         {
         }
 
-        /** The TinyTextEntity containing the first character of the match. */
-        TextList::ConstIterator it_begin;
+        /** The position of the first character of the match in the search buffer. */
+        int begin;
 
-        /** The TinyTextEntity containing the last character of the match. */
-        TextList::ConstIterator it_end;
+        /** One plus the position of the last character of the match in the search buffer. */
+        int end;
+};
 
-        /** The index of the first character of the match in (*it_begin)->text().
-         *  Satisfies 0 <= offset_begin < (*it_begin)->text().length().
-         */
-        int offset_begin;
+/* Case folding that keeps the length of the string, so that positions in
+ * the folded search buffer are positions in the search buffer too.
+ */
+static QString foldCase( const QString &str )
+{
+    QString folded = str;
+    QChar *data = folded.data();
+    const int length = folded.length();
+    for ( int i = 0; i < length; ++i )
+    {
+        if ( data[i].isHighSurrogate() && i + 1 < length && data[i + 1].isLowSurrogate() )
+        {
+            const uint ucs4 = QChar::toCaseFolded( QChar::surrogateToUcs4( data[i], data[i + 1] ) );
+            if ( QChar::requiresSurrogates( ucs4 ) )
+            {
+                data[i] = QChar::highSurrogate( ucs4 );
+                data[i + 1] = QChar::lowSurrogate( ucs4 );
+            }
+            ++i;
+            continue;
+        }
+        data[i] = data[i].toCaseFolded();
+    }
+    return folded;
+}
 
-        /** One plus the index of the last character of the match in (*it_end)->text().
-         *  Satisfies 0 < offset_end <= (*it_end)->text().length().
-         */
-        int offset_end;
-};
+/* Boyer-Moore-Horspool search of @p pattern in @p text, returning the first
+ * match starting at or after @p from, or -1. The shift table is indexed by
+ * the low byte of the UTF-16 units, which keeps it small and is still exact
+ * since each candidate is compared in full.
+ */
+static int findForward( const QString &text, const QString &pattern, int from )
+{
+    const int n = text.length();
+    const int m = pattern.length();
+    if ( m == 0 || from < 0 || from + m > n )
+        return -1;
+
+    const ushort *t = text.utf16();
+    const ushort *p = pattern.utf16();
+    int shift[256];
+    for ( int i = 0; i < 256; ++i )
+        shift[i] = m;
+    for ( int i = 0; i < m - 1; ++i )
+        shift[p[i] & 0xff] = m - 1 - i;
+
+    const ushort last = p[m - 1];
+    for ( int pos = from; pos <= n - m; pos += shift[t[pos + m - 1] & 0xff] )
+    {
+        if ( t[pos + m - 1] == last && std::memcmp( t + pos, p, ( m - 1 ) * sizeof( ushort ) ) == 0 )
+            return pos;
+    }
+    return -1;
+}
 
-/* text comparison functions */
+/* The mirror of findForward(): returns the last match ending at or before
+ * @p to, or -1.
+ */
+static int findBackward( const QString &text, const QString &pattern, int to )
+{
+    const int n = text.length();
+    const int m = pattern.length();
+    if ( m == 0 || to > n || to - m < 0 )
+        return -1;
+
+    const ushort *t = text.utf16();
+    const ushort *p = pattern.utf16();
+    int shift[256];
+    for ( int i = 0; i < 256; ++i )
+        shift[i] = m;
+    for ( int i = m - 1; i > 0; --i )
+        shift[p[i] & 0xff] = i;
+
+    const ushort first = p[0];
+    for ( int pos = to - m; pos >= 0; pos -= shift[t[pos] & 0xff] )
+    {
+        if ( t[pos] == first && std::memcmp( t + pos + 1, p + 1, ( m - 1 ) * sizeof( ushort ) ) == 0 )
+            return pos;
+    }
+    return -1;
+}
 
-static bool CaseInsensitiveCmpFn( const QStringRef & from, const QStringRef & to )
+/* Removes the accents of @p str: combining marks are dropped and letters
+ * with a canonical decomposition into a letter and marks are replaced by
+ * that letter. If @p positions is given, it is filled with the position in
+ * @p str of each character of the result, plus the length of @p str.
+ */
+static QString stripAccents( const QString &str, QVector< int > *positions )
 {
-    return from.compare( to, Qt::CaseInsensitive ) == 0;
+    QString result;
+    result.reserve( str.length() );
+    if ( positions )
+    {
+        positions->clear();
+        positions->reserve( str.length() + 1 );
+    }
+
+    const int length = str.length();
+    for ( int i = 0; i < length; ++i )
+    {
+        QChar c = str.at( i );
+        if ( c.isMark() )
+            continue;
+
+        while ( c.decompositionTag() == QChar::Canonical )
+        {
+            const QString decomposition = c.decomposition();
+            if ( decomposition.length() < 2 || !decomposition.at( 1 ).isMark() )
+                break;
+            c = decomposition.at( 0 );
+        }
+        result += c;
+        if ( positions )
+            positions->append( i );
+    }
+    if ( positions )
+        positions->append( length );
+    return result;
 }
 
-static bool CaseSensitiveCmpFn( const QStringRef & from, const QStringRef & to )
+static bool isWordCharacter( const QChar &c )
 {
-    return from.compare( to, Qt::CaseSensitive ) == 0;
+    return c.isLetterOrNumber() || c.isMark() || c == QLatin1Char( '_' );
+}
+
+/* Whether @p position in @p text is not inside a word.
+ */
+static bool isWordBoundary( const QString &text, int position )
+{
+    return position <= 0 || position >= text.length()
+           || !isWordCharacter( text.at( position - 1 ) ) || !isWordCharacter( text.at( position ) );
+}
+
+
+SearchPattern::SearchPattern()
+    : m_caseSensitivity( Qt::CaseSensitive ), m_options( NoSearchOption )
+{
+}
+
+SearchPattern::SearchPattern( const QString &text, Qt::CaseSensitivity caseSensitivity, SearchOptions options )
+    : m_text( text ), m_caseSensitivity( caseSensitivity ), m_options( options )
+{
+    if ( m_options & RegularExpressionSearchOption )
+    {
+        QRegularExpression::PatternOptions patternOptions = QRegularExpression::UseUnicodePropertiesOption;
+        if ( m_caseSensitivity == Qt::CaseInsensitive )
+            patternOptions |= QRegularExpression::CaseInsensitiveOption;
+        m_regularExpression.setPattern( m_options & IgnoreAccentsSearchOption ? stripAccents( text, nullptr ) : text );
+        m_regularExpression.setPatternOptions( patternOptions );
+        // compile it now, once for all the pages
+        m_regularExpression.optimize();
+        return;
+    }
+
+    // normalize query search all unicode (including glyphs)
+    m_literal = text.normalized( QString::NormalizationForm_KC );
+    if ( m_options & IgnoreAccentsSearchOption )
+        m_literal = stripAccents( m_literal, nullptr );
+    if ( m_caseSensitivity == Qt::CaseInsensitive )
+        m_literal = foldCase( m_literal );
+}
+
+bool SearchPattern::isValid() const
+{
+    if ( m_options & RegularExpressionSearchOption )
+        return !m_text.isEmpty() && m_regularExpression.isValid();
+    return !m_literal.isEmpty();
+}
+
+QString SearchPattern::text() const
+{
+    return m_text;
+}
+
+Qt::CaseSensitivity SearchPattern::caseSensitivity() const
+{
+    return m_caseSensitivity;
+}
+
+SearchOptions SearchPattern::options() const
+{
+    return m_options;
+}
+
+bool SearchPattern::foldsCase() const
+{
+    return m_caseSensitivity == Qt::CaseInsensitive && !( m_options & RegularExpressionSearchOption );
+}
+
+bool SearchPattern::match( const QString &text, int from, bool forward, int *begin, int *end ) const
+{
+    int position = from;
+    while ( true )
+    {
+        int matchBegin, matchEnd;
+        if ( m_options & RegularExpressionSearchOption )
+        {
+            if ( !matchRegularExpression( text, position, forward, &matchBegin, &matchEnd ) )
+                return false;
+        }
+        else
+        {
+            matchBegin = forward ? findForward( text, m_literal, position ) : findBackward( text, m_literal, position );
+            if ( matchBegin < 0 )
+                return false;
+            matchEnd = matchBegin + m_literal.length();
+        }
+
+        if ( !( m_options & WholeWordsSearchOption ) || ( isWordBoundary( text, matchBegin ) && isWordBoundary( text, matchEnd ) ) )
+        {
+            *begin = matchBegin;
+            *end = matchEnd;
+            return true;
+        }
+
+        // part of a longer word, look again just past this match
+        position = forward ? matchBegin + 1 : matchEnd - 1;
+    }
+}
+
+bool SearchPattern::matchRegularExpression( const QString &text, int from, bool forward, int *begin, int *end ) const
+{
+    if ( forward )
+    {
+        int position = from;
+        while ( position <= text.length() )
+        {
+            const QRegularExpressionMatch match = m_regularExpression.match( text, position );
+            if ( !match.hasMatch() )
+                return false;
+
+            // an empty match has nothing to highlight
+            if ( match.capturedLength() > 0 )
+            {
+                *begin = match.capturedStart();
+                *end = match.capturedEnd();
+                return true;
+            }
+            position = match.capturedStart() + 1;
+        }
+        return false;
+    }
+
+    // there is no backward matching: take the last match ending in time
+    bool found = false;
+    QRegularExpressionMatchIterator it = m_regularExpression.globalMatch( text );
+    while ( it.hasNext() )
+    {
+        const QRegularExpressionMatch match = it.next();
+        if ( match.capturedEnd() > from )
+            break;
+        if ( match.capturedLength() > 0 )
+        {
+            *begin = match.capturedStart();
+            *end = match.capturedEnd();
+            found = true;
+        }
+    }
+    return found;
 }
 
 
@@ -108,6 +349,9 @@ static bool doesConsumeY(const NormalizedRect& first, const NormalizedRect& seco
 /*
   Rationale behind TinyTextEntity:
 
+  the words of a text page are kept in TextWords, TinyTextEntity is only
+  used while putting them in reading order.
+
   instead of storing directly a QString for the text of an entity,
   we store the UTF-16 data and their length. This way, we save about
   4 int's wrt a QString, and we can create a new string from that
@@ -185,6 +429,50 @@ class TinyTextEntity
 };
 
 
+void TextWords::append( const QString &text, const NormalizedRect &area )
+{
+    m_left.append( area.left );
+    m_top.append( area.top );
+    m_right.append( area.right );
+    m_bottom.append( area.bottom );
+    m_textStarts.append( m_text.length() );
+    m_text += text;
+}
+
+void TextWords::clear()
+{
+    m_left.clear();
+    m_top.clear();
+    m_right.clear();
+    m_bottom.clear();
+    m_textStarts.clear();
+    m_text.clear();
+}
+
+void TextWords::squeeze()
+{
+    m_left.squeeze();
+    m_top.squeeze();
+    m_right.squeeze();
+    m_bottom.squeeze();
+    m_textStarts.squeeze();
+    m_text.squeeze();
+}
+
+qulonglong TextWords::memory() const
+{
+    return ( m_left.capacity() + m_top.capacity() + m_right.capacity() + m_bottom.capacity() ) * sizeof( float )
+           + m_textStarts.capacity() * sizeof( int ) + m_text.capacity() * sizeof( QChar );
+}
+
+NormalizedRect TextWords::transformedArea( int i, const QTransform &matrix ) const
+{
+    NormalizedRect transformed_area = area( i );
+    transformed_area.transform( matrix );
+    return transformed_area;
+}
+
+
 TextEntity::TextEntity( const QString &text, NormalizedRect *area )
     : m_text( text ), m_area( area ), d( nullptr )
 {
@@ -214,14 +502,52 @@ NormalizedRect TextEntity::transformedArea(const QTransform &matrix) const
 
 
 TextPagePrivate::TextPagePrivate()
-    : m_page( nullptr )
+    : m_page( nullptr ), m_searchBufferValid( false )
 {
 }
 
 TextPagePrivate::~TextPagePrivate()
 {
     qDeleteAll( m_searchPoints );
-    qDeleteAll( m_words );
+}
+
+TextPagePrivate *TextPagePrivate::get( TextPage *textPage )
+{
+    return textPage->d;
+}
+
+
+qulonglong TextPagePrivate::memory() const
+{
+    return sizeof( TextPagePrivate ) + m_words.memory()
+           + ( m_searchBuffer.capacity() + m_foldedSearchBuffer.capacity() ) * sizeof( QChar )
+           + ( m_accentlessSearchBuffer.capacity() + m_foldedAccentlessSearchBuffer.capacity() ) * sizeof( QChar )
+           + ( m_searchBufferStarts.capacity() + m_accentlessPositions.capacity() ) * sizeof( int )
+           + m_searchPoints.count() * sizeof( SearchPoint );
+}
+
+QMap< int, QPair< int, int > > TextPagePrivate::searchPoints() const
+{
+    QMap< int, QPair< int, int > > points;
+    QMap< int, SearchPoint* >::const_iterator it = m_searchPoints.constBegin(), itEnd = m_searchPoints.constEnd();
+    for ( ; it != itEnd; ++it )
+        points.insert( it.key(), qMakePair( it.value()->begin, it.value()->end ) );
+    return points;
+}
+
+void TextPagePrivate::restoreSearchPoints( const QMap< int, QPair< int, int > > &points )
+{
+    QMap< int, QPair< int, int > >::const_iterator it = points.constBegin(), itEnd = points.constEnd();
+    for ( ; it != itEnd; ++it )
+    {
+        if ( m_searchPoints.contains( it.key() ) )
+            continue;
+
+        SearchPoint *sp = new SearchPoint;
+        sp->begin = it.value().first;
+        sp->end = it.value().second;
+        m_searchPoints.insert( it.key(), sp );
+    }
 }
 
 
@@ -238,9 +564,10 @@ TextPage::TextPage( const TextEntity::List &words )
     {
         TextEntity *e = *it;
         if ( !e->text().isEmpty() )
-            d->m_words.append( new TinyTextEntity( e->text(), *e->area() ) );
+            d->m_words.append( e->text(), *e->area() );
         delete e;
     }
+    d->m_words.squeeze();
 }
 
 TextPage::~TextPage()
@@ -251,12 +578,18 @@ TextPage::~TextPage()
 void TextPage::append( const QString &text, NormalizedRect *area )
 {
     if ( !text.isEmpty() )
-        d->m_words.append( new TinyTextEntity( text.normalized(QString::NormalizationForm_KC), *area ) );
+        d->m_words.append( text.normalized(QString::NormalizationForm_KC), *area );
+    d->m_searchBufferValid = false;
     delete area;
 }
 
 struct WordWithCharacters
 {
+    WordWithCharacters()
+     : word(nullptr)
+    {
+    }
+
     WordWithCharacters(TinyTextEntity *w, const TextList &c)
      : word(w), characters(c)
     {
@@ -275,37 +608,77 @@ struct WordWithCharacters
     TinyTextEntity *word;
     TextList characters;
 };
-typedef QList<WordWithCharacters> WordsWithCharacters;
+typedef QVector<WordWithCharacters> WordsWithCharacters;
+
+/**
+ * The words of a page during the layout analysis, all in a single array:
+ * the regions and the lines refer to them by index. Their areas in the
+ * coordinates of the analysis are computed once.
+ */
+struct LayoutWords
+{
+    LayoutWords(int pageWidth, int pageHeight)
+     : pageWidth(pageWidth), pageHeight(pageHeight)
+    {
+    }
+
+    void append(const WordWithCharacters &word)
+    {
+        words.append(word);
+        areas.append(word.area().geometry(pageWidth, pageHeight));
+        roundedAreas.append(word.area().roundedGeometry(pageWidth, pageHeight));
+        const QRect sortArea = word.area().roundedGeometry(1000, 1000);
+        sortKeys.append(QPoint(sortArea.left(), sortArea.top()));
+    }
+
+    inline int count() const
+    {
+        return words.count();
+    }
+
+    const int pageWidth;
+    const int pageHeight;
+    WordsWithCharacters words;
+    QVector<QRect> areas;
+    QVector<QRect> roundedAreas;
+    // the left and top the words are sorted by
+    QVector<QPoint> sortKeys;
+};
+
+typedef QVector<int>::const_iterator WordIndexIterator;
+
+/**
+ * A line of words: the indexes of its words, from left to right, and its area.
+ */
+typedef QPair<QVector<int>, QRect> WordLine;
 
 /**
  * We will divide the whole page in some regions depending on the horizontal and
  * vertical spacing among different regions. Each region will have an area and an
- * associated WordsWithCharacters in sorted order.
+ * associated range of words, in an array of word indexes shared by all the regions.
 */
 class RegionText
 {
 
 public:
     RegionText()
+        : m_begin(0), m_end(0)
     {
     };
 
-    RegionText(const WordsWithCharacters &wordsWithCharacters, const QRect &area)
-        : m_region_wordWithCharacters(wordsWithCharacters), m_area(area)
+    RegionText(int begin, int end, const QRect &area)
+        : m_begin(begin), m_end(end), m_area(area)
     {
     }
-    
-    inline QString string() const
+
+    inline int begin() const
     {
-        QString res;
-        foreach(const WordWithCharacters &word, m_region_wordWithCharacters)
-            res += word.text();
-        return res;
+        return m_begin;
     }
 
-    inline WordsWithCharacters text() const
+    inline int end() const
     {
-        return m_region_wordWithCharacters;
+        return m_end;
     }
 
     inline QRect area() const
@@ -318,13 +691,9 @@ public:
         m_area = area;
     }
 
-    inline void setText(const WordsWithCharacters &wordsWithCharacters)
-    {
-        m_region_wordWithCharacters = wordsWithCharacters;
-    }
-
 private:
-    WordsWithCharacters m_region_wordWithCharacters;
+    int m_begin;
+    int m_end;
     QRect m_area;
 };
 
@@ -531,15 +900,15 @@ RegularAreaRect * TextPage::textArea ( TextSelection * sel) const
         if(endC.y * scaleY < minY) endC.y = minY/scaleY;
     }
 
-    TextList::ConstIterator it = d->m_words.constBegin(), itEnd = d->m_words.constEnd();
-    TextList::ConstIterator start = it, end = itEnd, tmpIt = it; //, tmpItEnd = itEnd;
+    int it = 0, itEnd = d->m_words.count();
+    int start = it, end = itEnd, tmpIt = it;
     const MergeSide side = d->m_page ? (MergeSide)d->m_page->m_page->totalOrientation() : MergeRight;
 
     NormalizedRect tmp;
     //case 2(a)
     for ( ; it != itEnd; ++it )
     {
-        tmp = (*it)->area;
+        tmp = d->m_words.area( it );
         if(tmp.contains(startC.x,startC.y)){
             start = it;
         }
@@ -555,7 +924,7 @@ RegularAreaRect * TextPage::textArea ( TextSelection * sel) const
         for ( ; it != itEnd; ++it )
         {
             // is there any text reactangle within the start_end rect
-            tmp = (*it)->area;
+            tmp = d->m_words.area( it );
             if(start_end.intersects(tmp))
                 break;
         }
@@ -581,7 +950,7 @@ RegularAreaRect * TextPage::textArea ( TextSelection * sel) const
         {
             for ( ; it != itEnd; ++it )
             {
-                rect= (*it)->area;
+                rect = d->m_words.area( it );
                 rect.isBottom(startC) ? flagV = false: flagV = true;
 
                 if(flagV && rect.isRight(startC))
@@ -601,7 +970,7 @@ RegularAreaRect * TextPage::textArea ( TextSelection * sel) const
 
             for ( ; it != itEnd; ++it )
             {
-                rect= (*it)->area;
+                rect = d->m_words.area( it );
 
                 if(rect.isBottomOrLevel(startC) && rect.isRight(startC))
                 {
@@ -638,7 +1007,7 @@ RegularAreaRect * TextPage::textArea ( TextSelection * sel) const
         {
             for ( ; itEnd >= it; itEnd-- )
             {
-                rect= (*itEnd)->area;
+                rect = d->m_words.area( itEnd );
                 rect.isTop(endC) ? flagV = false: flagV = true;
 
                 if(flagV && rect.isLeft(endC))
@@ -654,7 +1023,7 @@ RegularAreaRect * TextPage::textArea ( TextSelection * sel) const
             int distance = scaleX + scaleY + 100;
             for ( ; itEnd >= it; itEnd-- )
             {
-                rect= (*itEnd)->area;
+                rect = d->m_words.area( itEnd );
 
                 if(rect.isTopOrLevel(endC) && rect.isLeft(endC))
                 {
@@ -699,11 +1068,11 @@ RegularAreaRect * TextPage::textArea ( TextSelection * sel) const
     }
 
     // removes the possibility of crash, in case none of 1 to 3 is true
-    if(end == d->m_words.constEnd()) end--;
+    if(end == d->m_words.count()) end--;
 
     for( ;start <= end ; start++)
     {
-        ret->appendShape( (*start)->transformedArea( matrix ), side );
+        ret->appendShape( d->m_words.transformedArea( start, matrix ), side );
      }
 
 #endif
@@ -714,16 +1083,22 @@ RegularAreaRect * TextPage::textArea ( TextSelection * sel) const
 
 RegularAreaRect* TextPage::findText( int searchID, const QString &query, SearchDirection direct,
                                      Qt::CaseSensitivity caseSensitivity, const RegularAreaRect *area )
+{
+    // invalid search request
+    if ( query.isEmpty() || ( area && area->isNull() ) )
+        return nullptr;
+    return d->findText( searchID, SearchPattern( query, caseSensitivity ), direct );
+}
+
+RegularAreaRect* TextPagePrivate::findText( int searchID, const SearchPattern &pattern, SearchDirection direct )
 {
     SearchDirection dir=direct;
     // invalid search request
-    if ( d->m_words.isEmpty() || query.isEmpty() || ( area && area->isNull() ) )
+    if ( m_words.isEmpty() || !pattern.isValid() )
         return nullptr;
-    TextList::ConstIterator start;
-    int start_offset = 0;
-    TextList::ConstIterator end;
-    const QMap< int, SearchPoint* >::const_iterator sIt = d->m_searchPoints.constFind( searchID );
-    if ( sIt == d->m_searchPoints.constEnd() )
+    int from = 0;
+    const QMap< int, SearchPoint* >::const_iterator sIt = m_searchPoints.constFind( searchID );
+    if ( sIt == m_searchPoints.constEnd() )
     {
         // if no previous run of this search is found, then set it to start
         // from the beginning (respecting the search direction)
@@ -732,52 +1107,35 @@ RegularAreaRect* TextPage::findText( int searchID, const QString &query, SearchD
         else if ( dir == PreviousResult )
             dir = FromBottom;
     }
+    buildSearchBuffer();
     bool forward = true;
     switch ( dir )
     {
         case FromTop:
-            start = d->m_words.constBegin();
-            start_offset = 0;
-            end = d->m_words.constEnd();
+            from = 0;
             break;
         case FromBottom:
-            start = d->m_words.constEnd();
-            start_offset = 0;
-            end = d->m_words.constBegin();
+            from = m_searchBuffer.length();
             forward = false;
             break;
         case NextResult:
-            start = (*sIt)->it_end;
-            start_offset = (*sIt)->offset_end;
-            end = d->m_words.constEnd();
+            from = (*sIt)->end;
             break;
         case PreviousResult:
-            start = (*sIt)->it_begin;
-            start_offset = (*sIt)->offset_begin;
-            end = d->m_words.constBegin();
+            from = (*sIt)->begin;
             forward = false;
             break;
     };
-    RegularAreaRect* ret = nullptr;
-    const TextComparisonFunction cmpFn = caseSensitivity == Qt::CaseSensitive
-                                       ? CaseSensitiveCmpFn : CaseInsensitiveCmpFn;
-    if ( forward )
-    {
-        ret = d->findTextInternalForward( searchID, query, cmpFn, start, start_offset, end );
-    }
-    else
-    {
-        ret = d->findTextInternalBackward( searchID, query, cmpFn, start, start_offset, end );
-    }
-    return ret;
+    return findTextInternal( searchID, pattern, from, forward );
 }
 
 // hyphenated '-' must be at the end of a word, so hyphenation means
 // we have a '-' just followed by a '\n' character
 // check if the string contains a '-' character
 // if the '-' is the last entry
-static int stringLengthAdaptedWithHyphen(const QString &str, const TextList::ConstIterator &it, const TextList::ConstIterator &textListEnd)
+static int stringLengthAdaptedWithHyphen(const TextWords &words, int i)
 {
+    const QString str = words.text( i );
     int len = str.length();
     
     // hyphenated '-' must be at the end of a word, so hyphenation means
@@ -786,20 +1144,19 @@ static int stringLengthAdaptedWithHyphen(const QString &str, const TextList::Con
     // if the '-' is the last entry
     if ( str.endsWith( QLatin1Char('-') ) )
     {
-        // validity chek of it + 1
-        if ( ( it + 1 ) != textListEnd )
+        // validity chek of i + 1
+        if ( i + 1 < words.count() )
         {
             // 1. if the next character is '\n'
-            const QString &lookahedStr = (*(it+1))->text();
-            if (lookahedStr.startsWith(QLatin1Char('\n')))
+            if ( *words.textData( i + 1 ) == QLatin1Char('\n') )
             {
                 len -= 1;
             }
             else
             {
                 // 2. if the next word is in a different line or not
-                const NormalizedRect& hyphenArea = (*it)->area;
-                const NormalizedRect& lookaheadArea = (*(it + 1))->area;
+                const NormalizedRect hyphenArea = words.area( i );
+                const NormalizedRect lookaheadArea = words.area( i + 1 );
 
                 // lookahead to check whether both the '-' rect and next character rect overlap
                 if( !doesConsumeY( hyphenArea, lookaheadArea, 70 ) )
@@ -818,251 +1175,106 @@ static int stringLengthAdaptedWithHyphen(const QString &str, const TextList::Con
     return len;
 }
 
-RegularAreaRect* TextPagePrivate::searchPointToArea(const SearchPoint* sp)
+void TextPagePrivate::buildSearchBuffer()
 {
-    const QTransform matrix = m_page ? m_page->rotationMatrix() : QTransform();
-    RegularAreaRect* ret=new RegularAreaRect;
-
-    for (TextList::ConstIterator it = sp->it_begin; ; it++)
+    if ( m_searchBufferValid )
+        return;
+
+    m_searchBuffer.clear();
+    m_foldedSearchBuffer.clear();
+    m_accentlessSearchBuffer.clear();
+    m_foldedAccentlessSearchBuffer.clear();
+    m_accentlessPositions.clear();
+    m_searchBufferStarts.clear();
+    m_searchBufferStarts.reserve( m_words.count() );
+
+    m_searchBuffer.reserve( m_words.count() );
+    const int count = m_words.count();
+    for ( int i = 0; i < count; ++i )
     {
-        const TinyTextEntity* curEntity = *it;
-        ret->append( curEntity->transformedArea( matrix ) );
+        m_searchBufferStarts.append( m_searchBuffer.length() );
 
-        if (it == sp->it_end) {
-            break;
-        }
+        const int len = stringLengthAdaptedWithHyphen( m_words, i );
+        if ( len > 0 )
+            m_searchBuffer += QString::fromRawData( m_words.textData( i ), len ).normalized( QString::NormalizationForm_KC );
     }
-
-    ret->simplify();
-    return ret;
+    m_searchBufferValid = true;
 }
 
-RegularAreaRect* TextPagePrivate::findTextInternalForward( int searchID, const QString &_query,
-                                                             TextComparisonFunction comparer,
-                                                             const TextList::ConstIterator &start,
-                                                             int start_offset,
-                                                             const TextList::ConstIterator &end)
+int TextPagePrivate::searchBufferWord( int position ) const
 {
-    // normalize query search all unicode (including glyphs)
-    const QString query = _query.normalized(QString::NormalizationForm_KC);
+    // the last word starting at or before the position; words that left
+    // nothing in the buffer share their start with the next one
+    const QVector< int >::const_iterator it = std::upper_bound( m_searchBufferStarts.constBegin(), m_searchBufferStarts.constEnd(), position );
+    return it - m_searchBufferStarts.constBegin() - 1;
+}
 
-    // j is the current position in our query
-    // len is the length of the string in TextEntity
-    // queryLeft is the length of the query we have left
-    int j=0, queryLeft=query.length();
+RegularAreaRect* TextPagePrivate::searchPointToArea(const SearchPoint* sp)
+{
+    const QTransform matrix = m_page ? m_page->rotationMatrix() : QTransform();
+    RegularAreaRect* ret=new RegularAreaRect;
 
-    TextList::ConstIterator it = start;
-    int offset = start_offset;
+    const int last = searchBufferWord( sp->end - 1 );
+    for ( int i = searchBufferWord( sp->begin ); i <= last; ++i )
+        ret->append( m_words.transformedArea( i, matrix ) );
 
-    TextList::ConstIterator it_begin = TextList::ConstIterator();
-    int offset_begin = 0; //dummy initial value to suppress compiler warnings
+    ret->simplify();
+    return ret;
+}
 
-    while ( it != end )
+const QString &TextPagePrivate::searchText( const SearchPattern &pattern, const QVector< int > **positions )
+{
+    if ( !( pattern.options() & IgnoreAccentsSearchOption ) )
     {
-        const TinyTextEntity* curEntity = *it;
-        const QString& str = curEntity->text();
-        int len = stringLengthAdaptedWithHyphen(str, it, m_words.constEnd());
-
-        if (offset >= len)
-        {
-            it++;
-            offset = 0;
-            continue;
-        }
-
-        if ( it_begin == TextList::ConstIterator() )
-        {
-            it_begin = it;
-            offset_begin = offset;
-        }
-
-        int min=qMin(queryLeft,len-offset);
-        {
-#ifdef DEBUG_TEXTPAGE
-            qCDebug(OkularCoreDebug) << str.midRef(offset, min) << ":" << _query.midRef(j, min);
-#endif
-            // we have equal (or less than) area of the query left as the length of the current 
-            // entity
-
-            if ( !comparer( str.midRef( offset, min ), query.midRef( j, min ) ) )
-            {
-                    // we have not matched
-                    // this means we do not have a complete match
-                    // we need to get back to query start
-                    // and continue the search from this place
-#ifdef DEBUG_TEXTPAGE
-            qCDebug(OkularCoreDebug) << "\tnot matched";
-#endif
-                    j = 0;
-                    queryLeft=query.length();
-                    it = it_begin;
-                    offset = offset_begin+1;
-                    it_begin = TextList::ConstIterator();
-            }
-            else
-            {
-                    // we have a match
-                    // move the current position in the query
-                    // to the position after the length of this string
-                    // we matched
-                    // subtract the length of the current entity from 
-                    // the left length of the query
-#ifdef DEBUG_TEXTPAGE
-            qCDebug(OkularCoreDebug) << "\tmatched";
-#endif
-                    j += min;
-                    queryLeft -= min;
-
-                    if (queryLeft==0)
-                    {
-                        // save or update the search point for the current searchID
-                        QMap< int, SearchPoint* >::iterator sIt = m_searchPoints.find( searchID );
-                        if ( sIt == m_searchPoints.end() )
-                        {
-                            sIt = m_searchPoints.insert( searchID, new SearchPoint );
-                        }
-                        SearchPoint* sp = *sIt;
-                        sp->it_begin = it_begin;
-                        sp->it_end = it;
-                        sp->offset_begin = offset_begin;
-                        sp->offset_end = offset + min;
-                        return searchPointToArea(sp);
-                    }
-
-                    it++;
-                    offset = 0;
-            }
-        }
+        *positions = nullptr;
+        if ( !pattern.foldsCase() )
+            return m_searchBuffer;
+        if ( m_foldedSearchBuffer.isNull() )
+            m_foldedSearchBuffer = foldCase( m_searchBuffer );
+        return m_foldedSearchBuffer;
     }
-    // end of loop - it means that we've ended the textentities
 
-    const QMap< int, SearchPoint* >::iterator sIt = m_searchPoints.find( searchID );
-    if ( sIt != m_searchPoints.end() )
-    {
-        SearchPoint* sp = *sIt;
-        m_searchPoints.erase( sIt );
-        delete sp;
-    }
-    return nullptr;
+    if ( m_accentlessSearchBuffer.isNull() )
+        m_accentlessSearchBuffer = stripAccents( m_searchBuffer, &m_accentlessPositions );
+    *positions = &m_accentlessPositions;
+    if ( !pattern.foldsCase() )
+        return m_accentlessSearchBuffer;
+    if ( m_foldedAccentlessSearchBuffer.isNull() )
+        m_foldedAccentlessSearchBuffer = foldCase( m_accentlessSearchBuffer );
+    return m_foldedAccentlessSearchBuffer;
 }
 
-RegularAreaRect* TextPagePrivate::findTextInternalBackward( int searchID, const QString &_query,
-                                                            TextComparisonFunction comparer,
-                                                            const TextList::ConstIterator &start,
-                                                            int start_offset,
-                                                            const TextList::ConstIterator &end)
+RegularAreaRect* TextPagePrivate::findTextInternal( int searchID, const SearchPattern &pattern, int from, bool forward )
 {
-    // normalize query to search all unicode (including glyphs)
-    const QString query = _query.normalized(QString::NormalizationForm_KC);
-
-    // j is the current position in our query
-    // len is the length of the string in TextEntity
-    // queryLeft is the length of the query we have left
-    int j=query.length(), queryLeft=query.length();
-
-    TextList::ConstIterator it = start;
-    int offset = start_offset;
-
-    TextList::ConstIterator it_begin = TextList::ConstIterator();
-    int offset_begin = 0; //dummy initial value to suppress compiler warnings
+    const QVector< int > *positions;
+    const QString &text = searchText( pattern, &positions );
+    if ( positions )
+        from = std::lower_bound( positions->constBegin(), positions->constEnd(), from ) - positions->constBegin();
 
-    while ( true )
+    int begin, end;
+    if ( !pattern.match( text, from, forward, &begin, &end ) )
     {
-        if (offset <= 0)
-        {
-            if ( it == end )
-            {
-                break;
-            }
-            it--;
-        }
-
-        const TinyTextEntity* curEntity = *it;
-        const QString& str = curEntity->text();
-        int len = stringLengthAdaptedWithHyphen(str, it, m_words.constEnd());
-
-        if (offset <= 0)
+        // we've ended the text, forget about this search
+        const QMap< int, SearchPoint* >::iterator sIt = m_searchPoints.find( searchID );
+        if ( sIt != m_searchPoints.end() )
         {
-            offset = len;
+            SearchPoint* sp = *sIt;
+            m_searchPoints.erase( sIt );
+            delete sp;
         }
-
-        if ( it_begin == TextList::ConstIterator() )
-        {
-            it_begin = it;
-            offset_begin = offset;
-        }
-
-        int min=qMin(queryLeft,offset);
-        {
-#ifdef DEBUG_TEXTPAGE
-            qCDebug(OkularCoreDebug) << str.midRef(offset-min, min) << " : " << _query.midRef(j-min, min);
-#endif
-            // we have equal (or less than) area of the query left as the length of the current 
-            // entity
-
-            // Note len is not str.length() so we can't use rightRef here
-            if ( !comparer( str.midRef(offset-min, min ), query.midRef( j - min, min ) ) )
-            {
-                    // we have not matched
-                    // this means we do not have a complete match
-                    // we need to get back to query start
-                    // and continue the search from this place
-#ifdef DEBUG_TEXTPAGE
-                    qCDebug(OkularCoreDebug) << "\tnot matched";
-#endif
-
-                    j = query.length();
-                    queryLeft = query.length();
-                    it = it_begin;
-                    offset = offset_begin-1;
-                    it_begin = TextList::ConstIterator();
-            }
-            else
-            {
-                    // we have a match
-                    // move the current position in the query
-                    // to the position after the length of this string
-                    // we matched
-                    // subtract the length of the current entity from 
-                    // the left length of the query
-#ifdef DEBUG_TEXTPAGE
-                    qCDebug(OkularCoreDebug) << "\tmatched";
-#endif
-                    j -= min;
-                    queryLeft -= min;
-
-                    if ( queryLeft == 0 )
-                    {
-                        // save or update the search point for the current searchID
-                        QMap< int, SearchPoint* >::iterator sIt = m_searchPoints.find( searchID );
-                        if ( sIt == m_searchPoints.end() )
-                        {
-                            sIt = m_searchPoints.insert( searchID, new SearchPoint );
-                        }
-                        SearchPoint* sp = *sIt;
-                        sp->it_begin = it;
-                        sp->it_end = it_begin;
-                        sp->offset_begin = offset - min;
-                        sp->offset_end = offset_begin;
-                        return searchPointToArea(sp);
-                    }
-
-                    offset = 0;
-            }
-
-        }
-
+        return nullptr;
     }
-    // end of loop - it means that we've ended the textentities
 
-    const QMap< int, SearchPoint* >::iterator sIt = m_searchPoints.find( searchID );
-    if ( sIt != m_searchPoints.end() )
+    // save or update the search point for the current searchID
+    QMap< int, SearchPoint* >::iterator sIt = m_searchPoints.find( searchID );
+    if ( sIt == m_searchPoints.end() )
     {
-        SearchPoint* sp = *sIt;
-        m_searchPoints.erase( sIt );
-        delete sp;
+        sIt = m_searchPoints.insert( searchID, new SearchPoint );
     }
-    return nullptr;
+    SearchPoint* sp = *sIt;
+    sp->begin = positions ? positions->at( begin ) : begin;
+    sp->end = positions ? positions->at( end ) : end;
+    return searchPointToArea(sp);
 }
 
 QString TextPage::text(const RegularAreaRect *area) const
@@ -1075,82 +1287,72 @@ QString TextPage::text(const RegularAreaRect *area, TextAreaInclusionBehaviour b
     if ( area && area->isNull() )
         return QString();
 
-    TextList::ConstIterator it = d->m_words.constBegin(), itEnd = d->m_words.constEnd();
+    const int count = d->m_words.count();
     QString ret;
     if ( area )
     {
-        for ( ; it != itEnd; ++it )
+        for ( int i = 0; i < count; ++i )
         {
             if (b == AnyPixelTextAreaInclusionBehaviour)
             {
-                if ( area->intersects( (*it)->area ) )
+                if ( area->intersects( d->m_words.area( i ) ) )
                 {
-                    ret += (*it)->text();
+                    ret.append( d->m_words.textData( i ), d->m_words.textLength( i ) );
                 }
             }
             else
             {
-                NormalizedPoint center = (*it)->area.center();
+                NormalizedPoint center = d->m_words.area( i ).center();
                 if ( area->contains( center.x, center.y ) )
                 {
-                    ret += (*it)->text();
+                    ret.append( d->m_words.textData( i ), d->m_words.textLength( i ) );
                 }
             }
         }
     }
     else
     {
-        for ( ; it != itEnd; ++it )
-            ret += (*it)->text();
+        ret.reserve( count );
+        for ( int i = 0; i < count; ++i )
+            ret.append( d->m_words.textData( i ), d->m_words.textLength( i ) );
     }
     return ret;
 }
 
-static bool compareTinyTextEntityX(const WordWithCharacters &first, const WordWithCharacters &second)
-{
-    QRect firstArea = first.area().roundedGeometry(1000,1000);
-    QRect secondArea = second.area().roundedGeometry(1000,1000);
-
-    return firstArea.left() < secondArea.left();
-}
-
-static bool compareTinyTextEntityY(const WordWithCharacters &first, const WordWithCharacters &second)
-{
-    const QRect firstArea = first.area().roundedGeometry(1000,1000);
-    const QRect secondArea = second.area().roundedGeometry(1000,1000);
-
-    return firstArea.top() < secondArea.top();
-}
-
 /**
  * Sets a new world list. Deleting the contents of the old one
  */
 void TextPagePrivate::setWordList(const TextList &list)
 {
-    qDeleteAll(m_words);
-    m_words = list;
+    m_words.clear();
+    foreach (TinyTextEntity *te, list)
+        m_words.append(te->text(), te->area);
+    m_words.squeeze();
+    qDeleteAll(list);
+
+    // the search positions refer to the old words
+    qDeleteAll(m_searchPoints);
+    m_searchPoints.clear();
+    m_searchBufferValid = false;
 }
 
 /**
  * Remove all the spaces in between texts. It will make all the generators
  * same, whether they save spaces(like pdf) or not(like djvu).
+ * Returns the indexes of the remaining words.
  */
-static void removeSpace(TextList *words)
+static QVector<int> removeSpace(const TextWords &words)
 {
-    TextList::Iterator it = words->begin();
-    const QString str(QLatin1Char(' '));
-
-    while ( it != words->end() )
+    QVector<int> result;
+    result.reserve(words.count());
+    for (int i = 0; i < words.count(); ++i)
     {
-        if((*it)->text() == str)
+        if (words.textLength(i) != 1 || *words.textData(i) != QLatin1Char(' '))
         {
-            it = words->erase(it);
-        }
-        else
-        {
-            ++it;
+            result.append(i);
         }
     }
+    return result;
 }
 
 /**
@@ -1160,7 +1362,7 @@ static void removeSpace(TextList *words)
  * WordsWithCharacters memory has to be managed by the caller, both the 
  * WordWithCharacters::word and WordWithCharacters::characters contents
  */
-static WordsWithCharacters makeWordFromCharacters(const TextList &characters, int pageWidth, int pageHeight)
+static WordsWithCharacters makeWordFromCharacters(const TextWords &words, const QVector<int> &characters, int pageWidth, int pageHeight)
 {
     /**
      * We will traverse characters and try to create words from the TinyTextEntities in it.
@@ -1175,15 +1377,15 @@ static WordsWithCharacters makeWordFromCharacters(const TextList &characters, in
      */
     WordsWithCharacters wordsWithCharacters;
 
-    TextList::ConstIterator it = characters.begin(), itEnd = characters.end(), tmpIt;
+    QVector<int>::ConstIterator it = characters.begin(), itEnd = characters.end(), tmpIt;
     int newLeft,newRight,newTop,newBottom;
     int index = 0;
 
     for( ; it != itEnd ; it++)
     {
-        QString textString = (*it)->text();
+        QString textString = words.text(*it);
         QString newString;
-        QRect lineArea = (*it)->area.roundedGeometry(pageWidth,pageHeight),elementArea;
+        QRect lineArea = words.area(*it).roundedGeometry(pageWidth,pageHeight),elementArea;
         TextList wordCharacters;
         tmpIt = it;
         int space = 0;
@@ -1216,7 +1418,7 @@ static WordsWithCharacters makeWordFromCharacters(const TextList &characters, in
              otherwise the last character can be missed
              */
             if (it == itEnd) break;
-            elementArea = (*it)->area.roundedGeometry(pageWidth,pageHeight);
+            elementArea = words.area(*it).roundedGeometry(pageWidth,pageHeight);
             if (!doesConsumeY(elementArea, lineArea, 60))
             {
                 --it;
@@ -1249,7 +1451,7 @@ static WordsWithCharacters makeWordFromCharacters(const TextList &characters, in
             lineArea.setWidth( newRight - newLeft );
             lineArea.setHeight( newBottom - newTop );
 
-            textString = (*it)->text();
+            textString = words.text(*it);
         }
 
         // if newString is not empty, save it
@@ -1269,9 +1471,9 @@ static WordsWithCharacters makeWordFromCharacters(const TextList &characters, in
 }
 
 /**
- * Create Lines from the words and sort them
+ * Create Lines from the words between begin and end and sort them
  */
-QList< QPair<WordsWithCharacters, QRect> > makeAndSortLines(const WordsWithCharacters &wordsTmp, int pageWidth, int pageHeight)
+static QVector<WordLine> makeAndSortLines(const LayoutWords &layout, WordIndexIterator begin, WordIndexIterator end)
 {
     /**
      * We cannot assume that the generator will give us texts in the right order.
@@ -1284,24 +1486,22 @@ QList< QPair<WordsWithCharacters, QRect> > makeAndSortLines(const WordsWithChara
      * 3. Within each line sort the TinyTextEntity 's by x0(left)
      */
     
-    QList< QPair<WordsWithCharacters, QRect> > lines;
+    QVector<WordLine> lines;
 
-    /*
-     Make a new copy of the TextList in the words, so that the wordsTmp and lines do
-     not contain same pointers for all the TinyTextEntity.
-     */
-    QList<WordWithCharacters> words = wordsTmp;
+    QVector<int> words;
+    words.reserve(end - begin);
+    std::copy(begin, end, std::back_inserter(words));
 
     // Step 1
-    qSort(words.begin(),words.end(),compareTinyTextEntityY);
+    std::stable_sort(words.begin(), words.end(), [&layout](int first, int second) {
+        return layout.sortKeys.at(first).y() < layout.sortKeys.at(second).y();
+    });
 
     // Step 2
-    QList<WordWithCharacters>::Iterator it = words.begin(), itEnd = words.end();
-
     //for every non-space texts(characters/words) in the textList
-    for( ; it != itEnd ; it++)
+    foreach (int word, words)
     {
-        const QRect elementArea = (*it).area().roundedGeometry(pageWidth,pageHeight);
+        const QRect elementArea = layout.roundedAreas.at(word);
         bool found = false;
 
         for( int i = 0 ; i < lines.length() ; i++)
@@ -1326,8 +1526,7 @@ QList< QPair<WordsWithCharacters, QRect> > makeAndSortLines(const WordsWithChara
              */
             if(doesConsumeY(elementArea,lineArea,70))
             {
-                WordsWithCharacters &line = lines[i].first;
-                line.append(*it);
+                lines[i].first.append(word);
 
                 const int newLeft = line_x1 < text_x1 ? line_x1 : text_x1;
                 const int newRight = line_x2 > text_x2 ? line_x2 : text_x2;
@@ -1346,17 +1545,17 @@ QList< QPair<WordsWithCharacters, QRect> > makeAndSortLines(const WordsWithChara
          */
         if(!found)
         {
-            WordsWithCharacters tmp;
-            tmp.append((*it));
-            lines.append(QPair<WordsWithCharacters, QRect>(tmp, elementArea));
+            lines.append(WordLine(QVector<int>() << word, elementArea));
         }
     }
 
     // Step 3
     for(int i = 0 ; i < lines.length() ; i++)
     {
-        WordsWithCharacters &list = lines[i].first;
-        qSort(list.begin(), list.end(), compareTinyTextEntityX);
+        QVector<int> &list = lines[i].first;
+        std::stable_sort(list.begin(), list.end(), [&layout](int first, int second) {
+            return layout.sortKeys.at(first).x() < layout.sortKeys.at(second).x();
+        });
     }
     
     return lines;
@@ -1365,7 +1564,7 @@ QList< QPair<WordsWithCharacters, QRect> > makeAndSortLines(const WordsWithChara
 /**
  * Calculate Statistical information from the lines we made previously
  */
-static void calculateStatisticalInformation(const QList<WordWithCharacters> &words, int pageWidth, int pageHeight, int *word_spacing, int *line_spacing, int *col_spacing)
+static void calculateStatisticalInformation(const LayoutWords &layout, WordIndexIterator begin, WordIndexIterator end, int *word_spacing, int *line_spacing, int *col_spacing)
 {
     /**
      * For the region, defined by line_rects and lines
@@ -1377,7 +1576,7 @@ static void calculateStatisticalInformation(const QList<WordWithCharacters> &wor
     /**
      * Step 0
      */
-    const QList< QPair<WordsWithCharacters, QRect> > sortedLines = makeAndSortLines(words, pageWidth, pageHeight);
+    const QVector<WordLine> sortedLines = makeAndSortLines(layout, begin, end);
 
     /**
      * Step 1
@@ -1423,22 +1622,21 @@ static void calculateStatisticalInformation(const QList<WordWithCharacters> &wor
     // Space in every line
     for(int i = 0 ; i < sortedLines.length() ; i++)
     {
-        const WordsWithCharacters list = sortedLines.at(i).first;
+        const QVector<int> &list = sortedLines.at(i).first;
         QList<QRect> line_space_rects;
-        int maxSpace = 0, minSpace = pageWidth;
+        int maxSpace = 0, minSpace = layout.pageWidth;
 
         // for every TinyTextEntity element in the line
-        WordsWithCharacters::ConstIterator it = list.begin(), itEnd = list.end();
+        WordIndexIterator it = list.begin(), itEnd = list.end();
         QRect max_area1,max_area2;
-        QString before_max, after_max;
 
         // for every line
         for( ; it != itEnd ; it++ )
         {
-            const QRect area1 = (*it).area().roundedGeometry(pageWidth,pageHeight);
+            const QRect area1 = layout.roundedAreas.at(*it);
             if( it+1 == itEnd ) break;
 
-            const QRect area2 = (*(it+1)).area().roundedGeometry(pageWidth,pageHeight);
+            const QRect area2 = layout.roundedAreas.at(*(it+1));
             int space = area2.left() - area1.right();
 
             if(space > maxSpace)
@@ -1446,14 +1644,12 @@ static void calculateStatisticalInformation(const QList<WordWithCharacters> &wor
                 max_area1 = area1;
                 max_area2 = area2;
                 maxSpace = space;
-                before_max = (*it).text();
-                after_max = (*(it+1)).text();
             }
 
             if(space < minSpace && space != 0) minSpace = space;
 
             //if we found a real space, whose length is not zero and also less than the pageWidth
-            if(space != 0 && space != pageWidth)
+            if(space != 0 && space != layout.pageWidth)
             {
                 // increase the count of the space amount
                 if(hor_space_stat.contains(space)) hor_space_stat[space]++;
@@ -1536,14 +1732,15 @@ static void calculateStatisticalInformation(const QList<WordWithCharacters> &wor
 
 /**
  * Implements the XY Cut algorithm for textpage segmentation
- * The resulting RegionTextList will contain RegionText whose WordsWithCharacters::word and
- * WordsWithCharacters::characters are reused from wordsWithCharacters (i.e. no new nor delete happens in this function)
+ * order holds the indexes of all the words of layout; it is reordered so that
+ * each RegionText of the resulting RegionTextList covers a range of it.
+ * Cutting a region only partitions its range in place, no word is copied.
  */
-static RegionTextList XYCutForBoundingBoxes(const QList<WordWithCharacters> &wordsWithCharacters, const NormalizedRect &boundingBox, int pageWidth, int pageHeight)
+static RegionTextList XYCutForBoundingBoxes(const LayoutWords &layout, QVector<int> &order, const NormalizedRect &boundingBox)
 {
     RegionTextList tree;
-    QRect contentRect(boundingBox.geometry(pageWidth,pageHeight));
-    const RegionText root(wordsWithCharacters, contentRect);
+    QRect contentRect(boundingBox.geometry(layout.pageWidth,layout.pageHeight));
+    const RegionText root(0, order.count(), contentRect);
 
     // start the tree with the root, it is our only region at the start
     tree.push_back(root);
@@ -1569,11 +1766,11 @@ static RegionTextList XYCutForBoundingBoxes(const QList<WordWithCharacters> &wor
         for( int j = 0 ; j < size_proj_y ; ++j ) proj_on_yaxis[j] = 0;
         for( int j = 0 ; j < size_proj_x ; ++j ) proj_on_xaxis[j] = 0;
 
-        const QList<WordWithCharacters> list = node.text();
+        const WordIndexIterator begin = order.constBegin() + node.begin(), end = order.constBegin() + node.end();
 
         // Calculate tcx and tcy locally for each new region
         int word_spacing, line_spacing, column_spacing;
-        calculateStatisticalInformation(list, pageWidth, pageHeight, &word_spacing, &line_spacing, &column_spacing);
+        calculateStatisticalInformation(layout, begin, end, &word_spacing, &line_spacing, &column_spacing);
 
         const int tcx = word_spacing * 2;
         const int tcy = line_spacing * 2;
@@ -1583,10 +1780,9 @@ static RegionTextList XYCutForBoundingBoxes(const QList<WordWithCharacters> &wor
         int count;
 
         // for every text in the region
-        for(int j = 0 ; j < list.length() ; ++j )
+        for(WordIndexIterator it = begin ; it != end ; ++it )
         {
-            TinyTextEntity *ent = list.at(j).word;
-            const QRect entRect = ent->area.geometry(pageWidth, pageHeight);
+            const QRect &entRect = layout.areas.at(*it);
 
             // calculate vertical projection profile proj_on_xaxis1
             for(int k = entRect.left() ; k <= entRect.left() + entRect.width() ; ++k)
@@ -1751,83 +1947,65 @@ static RegionTextList XYCutForBoundingBoxes(const QList<WordWithCharacters> &wor
             continue;
         }
 
-        WordsWithCharacters list1,list2;
+        QRect firstRect, secondRect;
 
         // horizontal cut, topRect and bottomRect
         if(cut_hor)
         {
-            for( int j = 0 ; j < list.length() ; ++j )
-            {
-                const WordWithCharacters word = list.at(j);
-                const QRect wordRect = word.area().geometry(pageWidth,pageHeight);
-
-                if(topRect.intersects(wordRect))
-                    list1.append(word);
-                else
-                    list2.append(word);
-            }
-
-            RegionText node1(list1,topRect);
-            RegionText node2(list2,bottomRect);
-
-            tree.replace(i,node1);
-            tree.insert(i+1,node2);
+            firstRect = topRect;
+            secondRect = bottomRect;
         }
 
         //vertical cut, leftRect and rightRect
         else if(cut_ver)
         {
-            for( int j = 0 ; j < list.length() ; ++j )
-            {
-                const WordWithCharacters word = list.at(j);
-                const QRect wordRect = word.area().geometry(pageWidth,pageHeight);
-
-                if(leftRect.intersects(wordRect))
-                    list1.append(word);
-                else 
-                    list2.append(word);
-            }
+            firstRect = leftRect;
+            secondRect = rightRect;
+        }
 
-            RegionText node1(list1,leftRect);
-            RegionText node2(list2,rightRect);
+        // split the words of the region in place, keeping their order
+        const QVector<int>::iterator middle = std::stable_partition(order.begin() + node.begin(), order.begin() + node.end(), [&layout, &firstRect](int word) {
+            return firstRect.intersects(layout.areas.at(word));
+        });
+        const int split = middle - order.begin();
 
-            tree.replace(i,node1);
-            tree.insert(i+1,node2);
-        }
+        tree.replace(i, RegionText(node.begin(), split, firstRect));
+        tree.insert(i+1, RegionText(split, node.end(), secondRect));
     }
 
     return tree;
 }
 
 /**
- * Add spaces in between words in a line. It reuses the pointers passed in tree and might add new ones. You will need to take care of deleting them if needed
+ * Add spaces in between words in a line. Returns the indexes of the words in reading order, spaces included.
+ * The spaces are new words appended to layout, you will need to take care of deleting them
  */
-WordsWithCharacters addNecessarySpace(RegionTextList tree, int pageWidth, int pageHeight)
+static QVector<int> addNecessarySpace(LayoutWords &layout, const QVector<int> &order, const RegionTextList &tree)
 {
     /**
      * 1. Call makeAndSortLines before adding spaces in between words in a line
      * 2. Now add spaces between every two words in a line
      * 3. Finally, extract all the space separated texts from each region and return it
      */
+    QVector<int> result;
+    result.reserve(order.count() * 2);
 
-    // Only change the texts under RegionTexts, not the area
-    for(int j = 0 ; j < tree.length() ; j++)
+    foreach (const RegionText &region, tree)
     {
-        RegionText &tmpRegion = tree[j];
-
         // Step 01
-        QList< QPair<WordsWithCharacters, QRect> > sortedLines = makeAndSortLines(tmpRegion.text(), pageWidth, pageHeight);
+        const QVector<WordLine> sortedLines = makeAndSortLines(layout, order.constBegin() + region.begin(), order.constBegin() + region.end());
 
-        // Step 02
-        for(int i = 0 ; i < sortedLines.length() ; i++)
+        // Step 02 and 03
+        foreach (const WordLine &line, sortedLines)
         {
-            WordsWithCharacters &list = sortedLines[i].first;
-            for(int k = 0 ; k < list.length() ; k++ )
+            const QVector<int> &list = line.first;
+            for(int k = 0 ; k < list.count() ; k++ )
             {
-                const QRect area1 = list.at(k).area().roundedGeometry(pageWidth,pageHeight);
-                if( k+1 >= list.length() ) break;
+                result.append(list.at(k));
+                if( k+1 >= list.count() ) break;
 
-                const QRect area2 = list.at(k+1).area().roundedGeometry(pageWidth,pageHeight);
+                const QRect area1 = layout.roundedAreas.at(list.at(k));
+                const QRect area2 = layout.roundedAreas.at(list.at(k+1));
                 const int space = area2.left() - area1.right();
 
                 if(space != 0)
@@ -1840,34 +2018,17 @@ WordsWithCharacters addNecessarySpace(RegionTextList tree, int pageWidth, int pa
 
                     const QString spaceStr(QStringLiteral(" "));
                     const QRect rect(QPoint(left,top),QPoint(right,bottom));
-                    const NormalizedRect entRect(rect,pageWidth,pageHeight);
+                    const NormalizedRect entRect(rect,layout.pageWidth,layout.pageHeight);
                     TinyTextEntity *ent1 = new TinyTextEntity(spaceStr, entRect);
                     TinyTextEntity *ent2 = new TinyTextEntity(spaceStr, entRect);
-                    WordWithCharacters word(ent1, QList<TinyTextEntity*>() << ent2);
-
-                    list.insert(k+1, word);
-
-                    // Skip the space
-                    k++;
+                    layout.append(WordWithCharacters(ent1, QList<TinyTextEntity*>() << ent2));
+                    result.append(layout.count() - 1);
                 }
             }
         }
-
-        WordsWithCharacters tmpList;
-        for(int i = 0 ; i < sortedLines.length() ; i++)
-        {
-            tmpList += sortedLines.at(i).first;
-        }
-        tmpRegion.setText(tmpList);
     }
 
-    // Step 03
-    WordsWithCharacters tmp;
-    for(int i = 0 ; i < tree.length() ; i++)
-    {
-        tmp += tree.at(i).text();
-    }
-    return tmp;
+    return result;
 }
 
 /**
@@ -1883,37 +2044,39 @@ void TextPagePrivate::correctTextOrder()
     const int pageWidth  = (int) (scalingFactor * m_page->m_page->width() );
     const int pageHeight = (int) (scalingFactor * m_page->m_page->height());
 
-    TextList characters = m_words;
-
     /**
      * Remove spaces from the text
      */
-    removeSpace(&characters);
+    const QVector<int> characters = removeSpace(m_words);
 
     /**
      * Construct words from characters
      */
-    const QList<WordWithCharacters> wordsWithCharacters = makeWordFromCharacters(characters, pageWidth, pageHeight);
+    LayoutWords layout(pageWidth, pageHeight);
+    foreach(const WordWithCharacters &word, makeWordFromCharacters(m_words, characters, pageWidth, pageHeight))
+        layout.append(word);
 
     /**
      * Make a XY Cut tree for segmentation of the texts
      */
-    const RegionTextList tree = XYCutForBoundingBoxes(wordsWithCharacters, m_page->m_page->boundingBox(), pageWidth, pageHeight);
+    QVector<int> order(layout.count());
+    for (int i = 0; i < order.count(); ++i)
+        order[i] = i;
+    const RegionTextList tree = XYCutForBoundingBoxes(layout, order, m_page->m_page->boundingBox());
 
     /**
      * Add spaces to the word
      */
-    const WordsWithCharacters listWithWordsAndSpaces = addNecessarySpace(tree, pageWidth, pageHeight);
+    const QVector<int> wordsAndSpaces = addNecessarySpace(layout, order, tree);
 
     /**
      * Break the words into characters
      */
     TextList listOfCharacters;
-    foreach(const WordWithCharacters &word, listWithWordsAndSpaces)
-    {
+    foreach(int word, wordsAndSpaces)
+        listOfCharacters.append(layout.words.at(word).characters);
+    foreach(const WordWithCharacters &word, layout.words)
         delete word.word;
-        listOfCharacters.append(word.characters);
-    }
     setWordList(listOfCharacters);
 }
 
@@ -1922,33 +2085,36 @@ TextEntity::List TextPage::words(const RegularAreaRect *area, TextAreaInclusionB
     if ( area && area->isNull() )
         return TextEntity::List();
 
+    const int count = d->m_words.count();
     TextEntity::List ret;
     if ( area )
     {
-        foreach (TinyTextEntity *te, d->m_words)
+        for ( int i = 0; i < count; ++i )
         {
+            const NormalizedRect wordArea = d->m_words.area( i );
             if (b == AnyPixelTextAreaInclusionBehaviour)
             {
-                if ( area->intersects( te->area ) )
+                if ( area->intersects( wordArea ) )
                 {
-                    ret.append( new TextEntity( te->text(), new Okular::NormalizedRect( te->area) ) );
+                    ret.append( new TextEntity( QString( d->m_words.textData( i ), d->m_words.textLength( i ) ), new Okular::NormalizedRect( wordArea ) ) );
                 }
             }
             else
             {
-                const NormalizedPoint center = te->area.center();
+                const NormalizedPoint center = wordArea.center();
                 if ( area->contains( center.x, center.y ) )
                 {
-                    ret.append( new TextEntity( te->text(), new Okular::NormalizedRect( te->area) ) );
+                    ret.append( new TextEntity( QString( d->m_words.textData( i ), d->m_words.textLength( i ) ), new Okular::NormalizedRect( wordArea ) ) );
                 }
             }
         }
     }
     else
     {
-        foreach (TinyTextEntity *te, d->m_words)
+        ret.reserve( count );
+        for ( int i = 0; i < count; ++i )
         {
-            ret.append( new TextEntity( te->text(), new Okular::NormalizedRect( te->area) ) );
+            ret.append( new TextEntity( QString( d->m_words.textData( i ), d->m_words.textLength( i ) ), new Okular::NormalizedRect( d->m_words.area( i ) ) ) );
         }
     }
     return ret;
@@ -1956,12 +2122,12 @@ TextEntity::List TextPage::words(const RegularAreaRect *area, TextAreaInclusionB
 
 RegularAreaRect * TextPage::wordAt( const NormalizedPoint &p, QString *word ) const
 {
-    TextList::ConstIterator itBegin = d->m_words.constBegin(), itEnd = d->m_words.constEnd();
-    TextList::ConstIterator it = itBegin;
-    TextList::ConstIterator posIt = itEnd;
+    const int itBegin = 0, itEnd = d->m_words.count();
+    int it = itBegin;
+    int posIt = itEnd;
     for ( ; it != itEnd; ++it )
     {
-        if ( (*it)->area.contains( p.x, p.y ) )
+        if ( d->m_words.area( it ).contains( p.x, p.y ) )
         {
             posIt = it;
             break;
@@ -1970,7 +2136,7 @@ RegularAreaRect * TextPage::wordAt( const NormalizedPoint &p, QString *word ) co
     QString text;
     if ( posIt != itEnd )
     {
-        if ( (*posIt)->text().simplified().isEmpty() )
+        if ( d->m_words.text( posIt ).simplified().isEmpty() )
         {
             return nullptr;
         }
@@ -1978,7 +2144,7 @@ RegularAreaRect * TextPage::wordAt( const NormalizedPoint &p, QString *word ) co
         while ( posIt != itBegin )
         {
             --posIt;
-            const QString itText = (*posIt)->text();
+            const QString itText = d->m_words.text( posIt );
             if ( itText.right(1).at(0).isSpace() )
             {
                 if (itText.endsWith(QLatin1String("-\n")))
@@ -1991,7 +2157,7 @@ RegularAreaRect * TextPage::wordAt( const NormalizedPoint &p, QString *word ) co
                 if (itText == QLatin1String("\n") && posIt != itBegin )
                 {
                     --posIt;
-                    if ((*posIt)->text().endsWith(QLatin1String("-"))) {
+                    if (d->m_words.text( posIt ).endsWith(QLatin1String("-"))) {
                         // Is an hyphenated word
                         // continue searching the start of the word back
                         continue;
@@ -2006,14 +2172,14 @@ RegularAreaRect * TextPage::wordAt( const NormalizedPoint &p, QString *word ) co
         RegularAreaRect *ret = new RegularAreaRect();
         for ( ; posIt != itEnd; ++posIt )
         {
-            const QString itText = (*posIt)->text();
+            const QString itText = d->m_words.text( posIt );
             if ( itText.simplified().isEmpty() )
             {
                 break;
             }
             
-            ret->appendShape( (*posIt)->area );
-            text += (*posIt)->text();
+            ret->appendShape( d->m_words.area( posIt ) );
+            text.append( d->m_words.textData( posIt ), d->m_words.textLength( posIt ) );
             if (itText.right(1).at(0).isSpace())
             {
                 if (!text.endsWith(QLatin1String("-\n")))
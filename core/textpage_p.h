@@ -14,8 +14,15 @@
 #include <QtCore/QList>
 #include <QtCore/QMap>
 #include <QtCore/QPair>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QString>
+#include <QtCore/QVector>
 #include <QtGui/QTransform>
 
+#include "area.h"
+#include "global.h"
+#include "okularcore_export.h"
+
 class SearchPoint;
 class TinyTextEntity;
 class RegionText;
@@ -24,18 +31,109 @@ namespace Okular
 {
 
 class PagePrivate;
+class TextPage;
 typedef QList< TinyTextEntity* > TextList;
 
 /**
- * Returns whether the two strings match.
- * Satisfies the condition that if two strings match then their lengths are equal.
+ * A list of RegionText. It keeps a bunch of TextList with their bounding rectangles
  */
-typedef bool ( *TextComparisonFunction )( const QStringRef & from, const QStringRef & to );
+typedef QList<RegionText> RegionTextList;
 
 /**
- * A list of RegionText. It keeps a bunch of TextList with their bounding rectangles
+ * The words of a text page, stored as a struct of arrays: the coordinates
+ * of the areas in parallel float arrays and all the texts one after the
+ * other in a single buffer. A page takes a handful of allocations however
+ * many words it has, and going through the words walks contiguous memory.
  */
-typedef QList<RegionText> RegionTextList;
+class TextWords
+{
+    public:
+        int count() const { return m_left.count(); }
+        bool isEmpty() const { return m_left.isEmpty(); }
+
+        void append( const QString &text, const NormalizedRect &area );
+        void clear();
+
+        /**
+         * Frees the memory reserved for words appended later.
+         */
+        void squeeze();
+
+        /**
+         * Returns the memory allocated for the words, in bytes.
+         */
+        qulonglong memory() const;
+
+        NormalizedRect area( int i ) const
+        {
+            return NormalizedRect( m_left.at( i ), m_top.at( i ), m_right.at( i ), m_bottom.at( i ) );
+        }
+        NormalizedRect transformedArea( int i, const QTransform &matrix ) const;
+
+        const QChar *textData( int i ) const { return m_text.constData() + m_textStarts.at( i ); }
+        int textLength( int i ) const
+        {
+            return ( i + 1 < m_textStarts.count() ? m_textStarts.at( i + 1 ) : m_text.length() ) - m_textStarts.at( i );
+        }
+
+        /**
+         * Returns the text of the word @p i, without copying it: the string
+         * must not be kept after the words change.
+         */
+        QString text( int i ) const { return QString::fromRawData( textData( i ), textLength( i ) ); }
+
+    private:
+        QVector< float > m_left;
+        QVector< float > m_top;
+        QVector< float > m_right;
+        QVector< float > m_bottom;
+        QVector< int > m_textStarts;
+        QString m_text;
+};
+
+/**
+ * The text of a search, prepared once for all the pages it is looked for
+ * in: a literal text is put in the form of the search buffers, a regular
+ * expression is compiled.
+ */
+class OKULARCORE_EXPORT SearchPattern
+{
+    public:
+        SearchPattern();
+        SearchPattern( const QString &text, Qt::CaseSensitivity caseSensitivity, SearchOptions options = NoSearchOption );
+
+        /**
+         * Returns whether the pattern can match anything: it is not empty,
+         * and the regular expression is valid.
+         */
+        bool isValid() const;
+
+        QString text() const;
+        Qt::CaseSensitivity caseSensitivity() const;
+        SearchOptions options() const;
+
+        /**
+         * Returns whether the pattern is matched against a case folded
+         * text; regular expressions deal with the case themselves.
+         */
+        bool foldsCase() const;
+
+        /**
+         * Looks for the pattern in @p text, forward from the position
+         * @p from or backward for a match ending up to it, and sets
+         * @p begin and @p end to the span of the match.
+         */
+        bool match( const QString &text, int from, bool forward, int *begin, int *end ) const;
+
+    private:
+        bool matchRegularExpression( const QString &text, int from, bool forward, int *begin, int *end ) const;
+
+        QString m_text;
+        QString m_literal;
+        QRegularExpression m_regularExpression;
+        Qt::CaseSensitivity m_caseSensitivity;
+        SearchOptions m_options;
+};
 
 class TextPagePrivate
 {
@@ -43,19 +141,42 @@ class TextPagePrivate
         TextPagePrivate();
         ~TextPagePrivate();
 
-        RegularAreaRect * findTextInternalForward( int searchID, const QString &query,
-                                                   TextComparisonFunction comparer,
-                                                   const TextList::ConstIterator &start,
-                                                   int start_offset,
-                                                   const TextList::ConstIterator &end);
-        RegularAreaRect * findTextInternalBackward( int searchID, const QString &query,
-                                                    TextComparisonFunction comparer,
-                                                    const TextList::ConstIterator &start,
-                                                    int start_offset,
-                                                    const TextList::ConstIterator &end );
+        OKULARCORE_EXPORT static TextPagePrivate *get( TextPage *textPage );
+
+        /**
+         * Looks for @p pattern in @p direction, starting from the search
+         * point of @p searchID for the next and previous results.
+         */
+        OKULARCORE_EXPORT RegularAreaRect * findText( int searchID, const SearchPattern &pattern, SearchDirection direction );
+
+        /**
+         * Looks for @p pattern in the search buffer, forward from the
+         * position @p from or backward up to it.
+         */
+        RegularAreaRect * findTextInternal( int searchID, const SearchPattern &pattern, int from, bool forward );
+
+        /**
+         * Returns the text to match @p pattern against: the search buffer,
+         * or a copy of it case folded or without accents, built on first
+         * use. In the latter case, @p positions is set to the positions in
+         * the search buffer of the characters of the copy, plus its length.
+         */
+        const QString &searchText( const SearchPattern &pattern, const QVector< int > **positions );
 
         /**
-         * Copy a TextList to m_words, the pointers of list are adopted
+         * Builds the search buffer if needed: the text of all the words in
+         * a row, without the hyphens of hyphenated words and in NFKC form.
+         */
+        void buildSearchBuffer();
+
+        /**
+         * Returns the index of the word holding the character at
+         * @p position in the search buffer.
+         */
+        int searchBufferWord( int position ) const;
+
+        /**
+         * Copy a TextList to m_words, deleting the entities of list
          */
         void setWordList(const TextList &list);
 
@@ -65,11 +186,39 @@ class TextPagePrivate
          */
         void correctTextOrder();
 
+        /**
+         * Returns an estimate of the memory used by the text page, in bytes.
+         */
+        OKULARCORE_EXPORT qulonglong memory() const;
+
+        /**
+         * Returns the begin and end of the search points, by search ID.
+         */
+        QMap< int, QPair< int, int > > searchPoints() const;
+
+        /**
+         * Adds the search points @p points of a text page with the same
+         * text, keeping the ones of searches already run on this page.
+         */
+        void restoreSearchPoints( const QMap< int, QPair< int, int > > &points );
+
         // variables those can be accessed directly from TextPage
-        TextList m_words;
+        TextWords m_words;
         QMap< int, SearchPoint* > m_searchPoints;
         PagePrivate *m_page;
 
+        // the search buffer, its case folded copy (built on the first case
+        // insensitive search) and the start in it of each word
+        QString m_searchBuffer;
+        QString m_foldedSearchBuffer;
+        // the search buffer without accents, its case folded copy and the
+        // position in the search buffer of each of their characters
+        QString m_accentlessSearchBuffer;
+        QString m_foldedAccentlessSearchBuffer;
+        QVector< int > m_accentlessPositions;
+        QVector< int > m_searchBufferStarts;
+        bool m_searchBufferValid;
+
     private:
         RegularAreaRect * searchPointToArea(const SearchPoint* sp);
 };
@@ -0,0 +1,163 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "thumbnailpipeline_p.h"
+
+#include <threadweaver/job.h>
+#include <threadweaver/qobjectdecorator.h>
+#include <threadweaver/queueing.h>
+
+#include "generator.h"
+#include "interfaces/thumbnailinterface.h"
+
+using namespace Okular;
+
+namespace {
+
+// an embedded thumbnail is scaled up to no more than twice its size
+static const double maximumEmbeddedScale = 2.0;
+// nor used if its aspect ratio is off by more than this
+static const double maximumAspectRatioError = 0.05;
+
+class ThumbnailLookupJobInternal : public ThreadWeaver::Job
+{
+    public:
+        ThumbnailLookupJobInternal( const PixmapRequest *request, const DiskRenderCache *cache, const QString &fileName,
+                                    ThumbnailInterface *thumbnailInterface )
+            : mRequest( request ), mCache( cache ), mFileName( fileName ), mThumbnailInterface( thumbnailInterface ),
+              mPage( request->pageNumber() ), mWidth( request->width() ), mHeight( request->height() )
+        {
+        }
+
+        QImage image() const { return mImage; }
+
+    protected:
+        void run( ThreadWeaver::JobPointer, ThreadWeaver::Thread * ) override
+        {
+            if ( mRequest->shouldAbortRender() )
+                return;
+
+            if ( !mFileName.isEmpty() )
+            {
+                mImage = mCache->loadFile( mFileName, mWidth, mHeight );
+                if ( !mImage.isNull() )
+                    return;
+            }
+
+            if ( mThumbnailInterface )
+            {
+                const QImage embedded = mThumbnailInterface->embeddedThumbnail( mPage );
+                if ( isUsable( embedded ) )
+                    mImage = embedded.scaled( mWidth, mHeight, Qt::IgnoreAspectRatio, Qt::SmoothTransformation );
+            }
+        }
+
+    private:
+        bool isUsable( const QImage &embedded ) const
+        {
+            if ( embedded.isNull() || mWidth <= 0 || mHeight <= 0 )
+                return false;
+
+            if ( embedded.width() * maximumEmbeddedScale < mWidth || embedded.height() * maximumEmbeddedScale < mHeight )
+                return false;
+
+            const double aspectRatio = (double)embedded.width() / embedded.height();
+            const double wantedAspectRatio = (double)mWidth / mHeight;
+            return qAbs( aspectRatio / wantedAspectRatio - 1.0 ) <= maximumAspectRatioError;
+        }
+
+        const PixmapRequest *mRequest;
+        const DiskRenderCache *mCache;
+        const QString mFileName;
+        ThumbnailInterface *mThumbnailInterface;
+        const int mPage;
+        const int mWidth;
+        const int mHeight;
+        QImage mImage;
+};
+
+class ThumbnailLookupJob : public ThreadWeaver::QObjectDecorator
+{
+    public:
+        ThumbnailLookupJob( ThumbnailLookupJobInternal *job, PixmapRequest *request )
+            : ThreadWeaver::QObjectDecorator( job ), mRequest( request )
+        {
+        }
+
+        const ThumbnailLookupJobInternal *internal() const { return static_cast< const ThumbnailLookupJobInternal * >( job() ); }
+
+        PixmapRequest *mRequest;
+};
+
+}
+
+ThumbnailPipeline::ThumbnailPipeline()
+    : QObject(), m_cache( QStringLiteral( "thumbnails" ), DiskRenderCache::Compressed ), m_thumbnailInterface( nullptr )
+{
+    m_weaver.setMaximumNumberOfThreads( 1 );
+}
+
+ThumbnailPipeline::~ThumbnailPipeline()
+{
+    m_weaver.dequeue();
+    m_weaver.finish();
+}
+
+void ThumbnailPipeline::open( const QString &identity, qulonglong maxBytes, ThumbnailInterface *thumbnailInterface )
+{
+    m_cache.close();
+    if ( !identity.isEmpty() )
+        m_cache.open( identity, maxBytes );
+    m_thumbnailInterface = thumbnailInterface;
+}
+
+void ThumbnailPipeline::close()
+{
+    m_cache.close();
+    m_thumbnailInterface = nullptr;
+}
+
+bool ThumbnailPipeline::isOpen() const
+{
+    return m_cache.isOpen() || m_thumbnailInterface;
+}
+
+void ThumbnailPipeline::fetch( PixmapRequest *request, const QString &renderHints )
+{
+    const QString fileName = m_cache.isOpen() ? m_cache.fileName( request->pageNumber(), request->width(), request->height(), renderHints ) : QString();
+    ThumbnailLookupJob *job = new ThumbnailLookupJob( new ThumbnailLookupJobInternal( request, &m_cache, fileName, m_thumbnailInterface ), request );
+    connect( job, SIGNAL(done(ThreadWeaver::JobPointer)),
+             this, SLOT(jobDone(ThreadWeaver::JobPointer)) );
+    ThreadWeaver::enqueue( &m_weaver, job );
+}
+
+void ThumbnailPipeline::store( int page, const QPixmap &pixmap, const QString &renderHints )
+{
+    m_cache.store( page, pixmap, renderHints );
+}
+
+void ThumbnailPipeline::removePage( int page )
+{
+    m_cache.removePage( page );
+}
+
+void ThumbnailPipeline::clear()
+{
+    m_cache.clear();
+}
+
+void ThumbnailPipeline::jobDone( const ThreadWeaver::JobPointer &j )
+{
+    const ThumbnailLookupJob *job = static_cast< const ThumbnailLookupJob * >( j.data() );
+
+    // the request is waiting for its thumbnail whatever happened meanwhile
+    emit fetched( job->mRequest, job->internal()->image() );
+}
+
+#include "moc_thumbnailpipeline_p.cpp"
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_THUMBNAILPIPELINE_P_H_
+#define _OKULAR_THUMBNAILPIPELINE_P_H_
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtGui/QImage>
+
+#include <threadweaver/queue.h>
+
+#include "diskrendercache_p.h"
+
+namespace Okular {
+
+class PixmapRequest;
+class ThumbnailInterface;
+
+/**
+ * @short Where thumbnails are looked for before rendering them.
+ *
+ * The thumbnail requests are first looked for, in a thread of their own
+ * next to the render workers of the generator, among the thumbnails kept
+ * on disk by the earlier sessions and then among the ones embedded in the
+ * document, when the generator implements ThumbnailInterface. Only the
+ * requests found in neither place are rendered by the generator.
+ *
+ * The thumbnails kept on disk are the ones the generator rendered, PNG
+ * compressed, under the same document identity as the renders of
+ * DiskRenderCache.
+ */
+class ThumbnailPipeline : public QObject
+{
+    Q_OBJECT
+
+    public:
+        ThumbnailPipeline();
+        ~ThumbnailPipeline();
+
+        /**
+         * Starts looking for the thumbnails of the document with @p identity
+         * on disk, with a cap of @p maxBytes for all the thumbnails, unless
+         * @p identity is empty, and in the document through @p thumbnailInterface
+         * unless it is null.
+         */
+        void open( const QString &identity, qulonglong maxBytes, ThumbnailInterface *thumbnailInterface );
+        void close();
+        bool isOpen() const;
+
+        /**
+         * Starts looking for the thumbnail @p request asks for; fetched() is
+         * emitted once done.
+         */
+        void fetch( PixmapRequest *request, const QString &renderHints );
+
+        /**
+         * Keeps on disk the thumbnail @p pixmap of @p page the generator
+         * rendered.
+         */
+        void store( int page, const QPixmap &pixmap, const QString &renderHints );
+
+        /**
+         * Forgets the thumbnails kept on disk for @p page, or for all the
+         * pages.
+         */
+        void removePage( int page );
+        void clear();
+
+    Q_SIGNALS:
+        /**
+         * The thumbnail of @p request was looked for. @p image is null if it
+         * was not found, and the request is then to be rendered.
+         */
+        void fetched( Okular::PixmapRequest *request, const QImage &image );
+
+    private Q_SLOTS:
+        void jobDone( const ThreadWeaver::JobPointer &job );
+
+    private:
+        ThreadWeaver::Queue m_weaver;
+        DiskRenderCache m_cache;
+        ThumbnailInterface *m_thumbnailInterface;
+};
+
+}
+
+#endif
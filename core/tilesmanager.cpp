@@ -12,9 +12,13 @@
 #include <QtCore/qmath.h>
 #include <QList>
 #include <QPainter>
+#include <QRectF>
+#include <QSize>
 
 #include "tile.h"
 
+// Bounds of the size of a tile, in pixels
+#define TILES_MINSIZE 262144
 #define TILES_MAXSIZE 2000000
 
 using namespace Okular;
@@ -65,8 +69,17 @@ class TilesManager::Private
          */
         bool splitBigTiles( TileNode &tile, const NormalizedRect &rect );
 
-        // The page is split in a 4x4 grid of tiles
-        TileNode tiles[16];
+        /**
+         * Hands the pixmap of @p tile down to its children that have nothing
+         * to show, so that they keep showing a scaled placeholder until their
+         * own pixmaps arrive.
+         */
+        void pushDownPixmap( TileNode &tile );
+
+        // The page is split in a grid of roughly square tiles
+        TileNode *tiles;
+        int nTiles;
+        qulonglong tileSize;
         int width;
         int height;
         int pageNumber;
@@ -79,7 +92,10 @@ class TilesManager::Private
 };
 
 TilesManager::Private::Private()
-    : width( 0 )
+    : tiles( nullptr )
+    , nTiles( 0 )
+    , tileSize( TILES_MAXSIZE )
+    , width( 0 )
     , height( 0 )
     , pageNumber( 0 )
     , totalPixels( 0 )
@@ -98,20 +114,33 @@ TilesManager::TilesManager( int pageNumber, int width, int height, Rotation rota
     d->height = height;
     d->rotation = rotation;
 
-    // The page is split in a 4x4 grid of tiles
-    const double dim = 0.25;
-    for ( int i = 0; i < 16; ++i )
+    // The page is split in a grid of 4 tiles along its short side, and as
+    // many along its long side as keep the tiles roughly square
+    int columns = 4;
+    int rows = 4;
+    if ( width > 0 && height > 0 )
     {
-        int x = i % 4;
-        int y = i / 4;
-        d->tiles[ i ].rect = NormalizedRect( x*dim, y*dim, x*dim+dim, y*dim+dim );
+        if ( width > height )
+            columns = qBound( 4, qRound( 4.0 * width / height ), 16 );
+        else
+            rows = qBound( 4, qRound( 4.0 * height / width ), 16 );
+    }
+
+    d->nTiles = columns * rows;
+    d->tiles = new TileNode[ d->nTiles ];
+    for ( int i = 0; i < d->nTiles; ++i )
+    {
+        int x = i % columns;
+        int y = i / columns;
+        d->tiles[ i ].rect = NormalizedRect( (double)x / columns, (double)y / rows, (double)(x + 1) / columns, (double)(y + 1) / rows );
     }
 }
 
 TilesManager::~TilesManager()
 {
-    for ( int i = 0; i < 16; ++i )
+    for ( int i = 0; i < d->nTiles; ++i )
         d->deleteTiles( d->tiles[ i ] );
+    delete [] d->tiles;
 
     delete d;
 }
@@ -167,9 +196,30 @@ Rotation TilesManager::rotation() const
     return d->rotation;
 }
 
+void TilesManager::setViewportSize( const QSize &size )
+{
+    // a few tiles cover the viewport: the partially visible ones are not
+    // much bigger than what is shown of them. Sizes go by powers of two so
+    // that small changes of the viewport do not reshape the tiles
+    if ( size.isEmpty() )
+        return;
+
+    const qulonglong viewportPixels = (qulonglong)size.width() * size.height();
+    qulonglong tileSize = TILES_MINSIZE;
+    while ( tileSize * 2 <= viewportPixels / 4 && tileSize * 2 <= TILES_MAXSIZE )
+        tileSize *= 2;
+
+    d->tileSize = tileSize;
+}
+
+qulonglong TilesManager::tileSize() const
+{
+    return d->tileSize;
+}
+
 void TilesManager::markDirty()
 {
-    for ( int i = 0; i < 16; ++i )
+    for ( int i = 0; i < d->nTiles; ++i )
     {
         TilesManager::Private::markDirty( d->tiles[ i ] );
     }
@@ -214,7 +264,7 @@ void TilesManager::setPixmap( const QPixmap *pixmap, const NormalizedRect &rect
         d->requestRect = NormalizedRect();
     }
 
-    for ( int i = 0; i < 16; ++i )
+    for ( int i = 0; i < d->nTiles; ++i )
     {
         d->setPixmap( pixmap, rotatedRect, d->tiles[ i ] );
     }
@@ -232,14 +282,14 @@ void TilesManager::Private::setPixmap( const QPixmap *pixmap, const NormalizedRe
     // edged of the viewport), attempt to set the pixmap in the children tiles
     if ( !((tile.rect & rect) == tile.rect) )
     {
-        // paint children tiles
+        // paint children tiles, the ones outside the viewport keep showing
+        // their part of the current pixmap meanwhile
         if ( tile.nTiles > 0 )
         {
+            pushDownPixmap( tile );
+
             for ( int i = 0; i < tile.nTiles; ++i )
                 setPixmap( pixmap, rect, tile.tiles[ i ] );
-
-            delete tile.pixmap;
-            tile.pixmap = nullptr;
         }
 
         return;
@@ -281,7 +331,7 @@ void TilesManager::Private::setPixmap( const QPixmap *pixmap, const NormalizedRe
         QRect tileRect = tile.rect.geometry( width, height );
         // sets the pixmap of the children tiles. if the tile's size is too
         // small, discards the children tiles and use the current one
-        if ( tileRect.width()*tileRect.height() >= TILES_MAXSIZE )
+        if ( (qulonglong)tileRect.width()*tileRect.height() >= tileSize )
         {
             tile.dirty = false;
             if ( tile.pixmap )
@@ -325,7 +375,7 @@ void TilesManager::Private::setPixmap( const QPixmap *pixmap, const NormalizedRe
 bool TilesManager::hasPixmap( const NormalizedRect &rect )
 {
     NormalizedRect rotatedRect = fromRotatedRect( rect, d->rotation );
-    for ( int i = 0; i < 16; ++i )
+    for ( int i = 0; i < d->nTiles; ++i )
     {
         if ( !d->hasPixmap( rotatedRect, d->tiles[ i ] ) )
             return false;
@@ -360,7 +410,7 @@ QList<Tile> TilesManager::tilesAt( const NormalizedRect &rect, TileLeaf tileLeaf
     QList<Tile> result;
 
     NormalizedRect rotatedRect = fromRotatedRect( rect, d->rotation );
-    for ( int i = 0; i < 16; ++i )
+    for ( int i = 0; i < d->nTiles; ++i )
     {
         d->tilesAt( rotatedRect, d->tiles[ i ], result, tileLeaf );
     }
@@ -449,7 +499,7 @@ qulonglong TilesManager::totalMemory() const
 void TilesManager::cleanupPixmapMemory( qulonglong numberOfBytes, const NormalizedRect &visibleRect, int visiblePageNumber )
 {
     QList<TileNode*> rankedTiles;
-    for ( int i = 0; i < 16; ++i )
+    for ( int i = 0; i < d->nTiles; ++i )
     {
         d->rankTiles( d->tiles[ i ], rankedTiles, visibleRect, visiblePageNumber );
     }
@@ -546,13 +596,60 @@ void TilesManager::setRequest( const NormalizedRect &rect, int pageWidth, int pa
 bool TilesManager::Private::splitBigTiles( TileNode &tile, const NormalizedRect &rect )
 {
     QRect tileRect = tile.rect.geometry( width, height );
-    if ( tileRect.width()*tileRect.height() < TILES_MAXSIZE )
+    if ( (qulonglong)tileRect.width()*tileRect.height() < tileSize )
         return false;
 
     split( tile, rect );
     return true;
 }
 
+static bool hasPixmapInSubtree( const TileNode &tile )
+{
+    if ( tile.pixmap )
+        return true;
+
+    for ( int i = 0; i < tile.nTiles; ++i )
+    {
+        if ( hasPixmapInSubtree( tile.tiles[ i ] ) )
+            return true;
+    }
+
+    return false;
+}
+
+void TilesManager::Private::pushDownPixmap( TileNode &tile )
+{
+    if ( !tile.pixmap )
+        return;
+
+    // the pixmap may still have the rotation it was rendered with
+    const NormalizedRect parentRect = TilesManager::toRotatedRect( tile.rect, tile.rotation );
+    const double xScale = tile.pixmap->width() / parentRect.width();
+    const double yScale = tile.pixmap->height() / parentRect.height();
+
+    for ( int i = 0; i < tile.nTiles; ++i )
+    {
+        TileNode &child = tile.tiles[ i ];
+        if ( hasPixmapInSubtree( child ) )
+            continue;
+
+        const NormalizedRect childRect = TilesManager::toRotatedRect( child.rect, tile.rotation );
+        const QRect cropRect = QRectF( ( childRect.left - parentRect.left ) * xScale, ( childRect.top - parentRect.top ) * yScale,
+                                       childRect.width() * xScale, childRect.height() * yScale ).toAlignedRect() & tile.pixmap->rect();
+        if ( cropRect.isEmpty() )
+            continue;
+
+        child.pixmap = new QPixmap( tile.pixmap->copy( cropRect ) );
+        child.rotation = tile.rotation;
+        child.dirty = true;
+        totalPixels += child.pixmap->width()*child.pixmap->height();
+    }
+
+    totalPixels -= tile.pixmap->width()*tile.pixmap->height();
+    delete tile.pixmap;
+    tile.pixmap = nullptr;
+}
+
 void TilesManager::Private::split( TileNode &tile, const NormalizedRect &rect )
 {
     if ( tile.nTiles != 0 )
@@ -13,6 +13,7 @@
 #include "area.h"
 
 class QPixmap;
+class QSize;
 
 namespace Okular {
 
@@ -24,8 +25,9 @@ class Tile;
  * Except for the first level, the tiles manager stores tiles in a quadtree
  * structure.
  * Each node stores the pixmap of a tile and its location on the page.
- * There's a limit on the size of the pixmaps (TILES_MAXSIZE, defined in
- * tilesmanager.cpp), and tiles that are bigger than that value are split into
+ * There's a limit on the size of the pixmaps, which follows the size of the
+ * viewport (see TilesManager::setViewportSize()), and tiles that are bigger
+ * than that value are split into
  * four children tiles, which are stored as children of the original tile.
  * If children tiles are still too big, they are recursively split again.
  * If the zoom level changes and a big tile goes below the limit, it is merged
@@ -91,9 +93,13 @@ class TileNode
  * This class has direct access to all tiles and handles how they should be
  * stored, deleted and retrieved. Each tiles manager only handles one page.
  *
- * The tiles manager is a tree of tiles. At first the page is divided in a 4x4
- * grid of 16 tiles. Then each of these tiles can be recursively split in 4
- * subtiles so that we keep the size of each pixmap inside a safe interval.
+ * The tiles manager is a tree of tiles. At first the page is divided in a grid
+ * of roughly square tiles, 4 of them along the short side of the page. Then
+ * each of these tiles can be recursively split in 4 subtiles so that we keep
+ * the size of each pixmap inside a safe interval.
+ *
+ * When a tile is split, its pixmap is handed down to the subtiles as a
+ * placeholder until their own pixmaps arrive.
  */
 class TilesManager
 {
@@ -181,6 +187,18 @@ class TilesManager
         void setRotation( Rotation rotation );
         Rotation rotation() const;
 
+        /**
+         * Adapts the size of the tiles to a viewport of @p size pixels, in
+         * device pixels at the current zoom level, so that a few tiles cover
+         * it. The new size applies as tiles get split or merged.
+         */
+        void setViewportSize( const QSize &size );
+
+        /**
+         * The maximum size of a tile, in pixels
+         */
+        qulonglong tileSize() const;
+
         /**
          * Mark all tiles as dirty
          */
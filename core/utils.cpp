@@ -22,6 +22,10 @@
 #include <QWindow>
 #include <QScreen>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef Q_OS_MAC
 #include <ApplicationServices/ApplicationServices.h>
 #include <IOKit/graphics/IOGraphicsLib.h>
@@ -164,51 +168,157 @@ inline static bool isPaperColor( QRgb argb, QRgb paperColor ) {
     return ( argb & 0xFFFFFF ) == ( paperColor & 0xFFFFFF); // ignore alpha
 }
 
+namespace {
+
+// Tells the pixels of the paper color in the scan lines of an image, as
+// isPaperColor() on what QImage::pixel() gives: the raw values, still
+// premultiplied for the premultiplied formats.
+class PaperColorMatcher
+{
+    public:
+        explicit PaperColorMatcher( QRgb paperColor )
+            : m_paperColor( paperColor ), m_mask( 0x00FFFFFF ), m_value( paperColor & 0x00FFFFFF )
+        {
+        }
+
+        inline bool isPaper( QRgb pixel ) const
+        {
+            return isPaperColor( pixel, m_paperColor );
+        }
+
+        // the first pixel not of the paper color in [from, to), or to
+        int firstNonPaper( const QRgb *pixels, int from, int to ) const
+        {
+            int x = from;
+#ifdef __SSE2__
+            const __m128i mask = _mm_set1_epi32( m_mask );
+            const __m128i value = _mm_set1_epi32( m_value );
+            for ( ; x + 4 <= to; x += 4 )
+            {
+                const __m128i p = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pixels + x ) );
+                if ( _mm_movemask_epi8( _mm_cmpeq_epi32( _mm_and_si128( p, mask ), value ) ) == 0xFFFF )
+                    continue;
+                for ( int i = x; i < x + 4; ++i )
+                    if ( !isPaper( pixels[ i ] ) )
+                        return i;
+            }
+#endif
+            for ( ; x < to; ++x )
+                if ( !isPaper( pixels[ x ] ) )
+                    return x;
+            return to;
+        }
+
+        // the last pixel not of the paper color in [from, to), or from - 1
+        int lastNonPaper( const QRgb *pixels, int from, int to ) const
+        {
+            int x = to;
+#ifdef __SSE2__
+            const __m128i mask = _mm_set1_epi32( m_mask );
+            const __m128i value = _mm_set1_epi32( m_value );
+            for ( ; x - 4 >= from; x -= 4 )
+            {
+                const __m128i p = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pixels + x - 4 ) );
+                if ( _mm_movemask_epi8( _mm_cmpeq_epi32( _mm_and_si128( p, mask ), value ) ) == 0xFFFF )
+                    continue;
+                for ( int i = x - 1; i >= x - 4; --i )
+                    if ( !isPaper( pixels[ i ] ) )
+                        return i;
+            }
+#endif
+            for ( --x; x >= from; --x )
+                if ( !isPaper( pixels[ x ] ) )
+                    return x;
+            return from - 1;
+        }
+
+    private:
+        QRgb m_paperColor;
+        QRgb m_mask;
+        QRgb m_value;
+};
+
+}
+
+static inline const QRgb *scanLine( const QImage *image, int y )
+{
+    return reinterpret_cast< const QRgb * >( image->constScanLine( y ) );
+}
+
+// the rows looked at to estimate the left and right bounds, before all of
+// them are
+static const int boundingBoxEstimateStep = 8;
+
 NormalizedRect Utils::imageBoundingBox( const QImage * image )
 {
     if ( !image )
         return NormalizedRect();
 
+    // the 32 bit formats are scanned as they are
+    QImage converted;
+    switch ( image->format() )
+    {
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            break;
+        default:
+            converted = image->convertToFormat( QImage::Format_ARGB32 );
+            image = &converted;
+            break;
+    }
+
     const int width = image->width();
     const int height = image->height();
-    const QRgb paperColor = SettingsCore::paperColor().rgb();
-    int left, top, bottom, right, x, y;
+    const PaperColorMatcher matcher( SettingsCore::paperColor().rgb() );
+    int left, top, bottom, right, x = 0, y;
 
 #ifdef BBOX_DEBUG
     QTime time;
     time.start();
 #endif
 
-    // Scan pixels for top non-white
+    // Scan rows for top non-white
     for ( top = 0; top < height; ++top )
-        for ( x = 0; x < width; ++x )
-            if ( !isPaperColor( image->pixel( x, top ), paperColor ) )
-                goto got_top;
-    return NormalizedRect( 0, 0, 0, 0 ); // the image is blank
-got_top:
+    {
+        x = matcher.firstNonPaper( scanLine( image, top ), 0, width );
+        if ( x < width )
+            break;
+    }
+    if ( top == height )
+        return NormalizedRect( 0, 0, 0, 0 ); // the image is blank
     left = right = x;
 
-    // Scan pixels for bottom non-white
-    for ( bottom = height-1; bottom >= top; --bottom )
-        for ( x = width-1; x >= 0; --x )
-            if ( !isPaperColor( image->pixel( x, bottom ), paperColor ) )
-                goto got_bottom;
-    Q_ASSERT( 0 ); // image changed?!
-got_bottom:
+    // Scan rows for bottom non-white, the top row having some
+    for ( bottom = height-1; bottom > top; --bottom )
+    {
+        x = matcher.lastNonPaper( scanLine( image, bottom ), 0, width );
+        if ( x >= 0 )
+            break;
+    }
+    if ( bottom == top )
+        x = matcher.lastNonPaper( scanLine( image, top ), 0, width );
     if ( x < left )
         left = x;
     if ( x > right )
         right = x;
 
-    // Scan for leftmost and rightmost (we already found some bounds on these):
+    // Scan for leftmost and rightmost (we already found some bounds on these),
+    // from some of the rows first, so that the others have only their margins
+    // to look at
+    for ( y = top; y <= bottom && ( left > 0 || right < width-1 ); y += boundingBoxEstimateStep )
+    {
+        const QRgb *pixels = scanLine( image, y );
+        left = matcher.firstNonPaper( pixels, 0, left );
+        right = matcher.lastNonPaper( pixels, right+1, width );
+    }
     for ( y = top; y <= bottom && ( left > 0 || right < width-1 ); ++y )
     {
-        for ( x = 0; x < left; ++x )
-            if ( !isPaperColor( image->pixel( x, y ), paperColor ) )
-                left = x;
-        for ( x = width-1; x > right+1; --x )
-            if ( !isPaperColor( image->pixel( x, y ), paperColor ) )
-                right = x;
+        if ( ( y - top ) % boundingBoxEstimateStep == 0 )
+            continue;
+        const QRgb *pixels = scanLine( image, y );
+        left = matcher.firstNonPaper( pixels, 0, left );
+        right = matcher.lastNonPaper( pixels, right+1, width );
     }
 
     NormalizedRect bbox( QRect( left, top, ( right - left + 1), ( bottom - top + 1 ) ),
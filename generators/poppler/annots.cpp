@@ -62,8 +62,8 @@ static int maskExportedFlags(int flags)
 }
 
 //BEGIN PopplerAnnotationProxy implementation
-PopplerAnnotationProxy::PopplerAnnotationProxy( Poppler::Document *doc, QMutex *userMutex )
-    : ppl_doc ( doc ), mutex ( userMutex )
+PopplerAnnotationProxy::PopplerAnnotationProxy( Poppler::Document *doc, QMutex *userMutex, QAtomicInt *revision )
+    : ppl_doc ( doc ), mutex ( userMutex ), revision ( revision )
 {
 }
 
@@ -92,6 +92,7 @@ void PopplerAnnotationProxy::notifyAddition( Okular::Annotation *okl_ann, int pa
     Okular::AnnotationUtils::storeAnnotation( okl_ann, dom_ann, doc );
 
     QMutexLocker ml(mutex);
+    revision->ref();
 
     // Create poppler annotation
     Poppler::Annotation *ppl_ann = Poppler::AnnotationUtils::createAnnotation( dom_ann );
@@ -143,6 +144,7 @@ void PopplerAnnotationProxy::notifyModification( const Okular::Annotation *okl_a
         return;
 
     QMutexLocker ml(mutex);
+    revision->ref();
 
     if ( okl_ann->flags() & (Okular::Annotation::BeingMoved | Okular::Annotation::BeingResized) )
     {
@@ -252,6 +254,7 @@ void PopplerAnnotationProxy::notifyRemoval( Okular::Annotation *okl_ann, int pag
         return;
 
     QMutexLocker ml(mutex);
+    revision->ref();
 
     Poppler::Page *ppl_page = ppl_doc->page( page );
     ppl_page->removeAnnotation( ppl_ann ); // Also destroys ppl_ann
@@ -13,6 +13,7 @@
 #include <poppler-annotation.h>
 #include <poppler-qt5.h>
 
+#include <qatomic.h>
 #include <qmutex.h>
 
 #include "core/annotations.h"
@@ -23,7 +24,7 @@ extern Okular::Annotation* createAnnotationFromPopplerAnnotation( Poppler::Annot
 class PopplerAnnotationProxy : public Okular::AnnotationProxy
 {
     public:
-        PopplerAnnotationProxy( Poppler::Document *doc, QMutex *userMutex );
+        PopplerAnnotationProxy( Poppler::Document *doc, QMutex *userMutex, QAtomicInt *revision );
         ~PopplerAnnotationProxy();
 
         bool supports( Capability capability ) const override;
@@ -33,6 +34,8 @@ class PopplerAnnotationProxy : public Okular::AnnotationProxy
     private:
         Poppler::Document *ppl_doc;
         QMutex *mutex;
+        // bumped on each change to ppl_doc
+        QAtomicInt *revision;
 };
 
 #endif
@@ -29,8 +29,8 @@ extern Okular::Action* createLinkFromPopplerLink(const Poppler::Link *popplerLin
     setActivationAction( createLinkFromPopplerLink( field->activationAction() ) );
 #endif
 
-PopplerFormFieldButton::PopplerFormFieldButton( Poppler::FormFieldButton * field )
-    : Okular::FormFieldButton(), m_field( field )
+PopplerFormFieldButton::PopplerFormFieldButton( Poppler::FormFieldButton * field, QAtomicInt *revision )
+    : Okular::FormFieldButton(), m_field( field ), m_revision( revision )
 {
     m_rect = Okular::NormalizedRect::fromQRectF( m_field->rect() );
     SET_ACTIONS
@@ -98,6 +98,7 @@ bool PopplerFormFieldButton::state() const
 void PopplerFormFieldButton::setState( bool state )
 {
     m_field->setState( state );
+    m_revision->ref();
 }
 
 QList< int > PopplerFormFieldButton::siblings() const
@@ -106,8 +107,8 @@ QList< int > PopplerFormFieldButton::siblings() const
 }
 
 
-PopplerFormFieldText::PopplerFormFieldText( Poppler::FormFieldText * field )
-    : Okular::FormFieldText(), m_field( field )
+PopplerFormFieldText::PopplerFormFieldText( Poppler::FormFieldText * field, QAtomicInt *revision )
+    : Okular::FormFieldText(), m_field( field ), m_revision( revision )
 {
     m_rect = Okular::NormalizedRect::fromQRectF( m_field->rect() );
     SET_ACTIONS
@@ -170,6 +171,7 @@ QString PopplerFormFieldText::text() const
 void PopplerFormFieldText::setText( const QString& text )
 {
     m_field->setText( text );
+    m_revision->ref();
 }
 
 bool PopplerFormFieldText::isPassword() const
@@ -198,8 +200,8 @@ bool PopplerFormFieldText::canBeSpellChecked() const
 }
 
 
-PopplerFormFieldChoice::PopplerFormFieldChoice( Poppler::FormFieldChoice * field )
-    : Okular::FormFieldChoice(), m_field( field )
+PopplerFormFieldChoice::PopplerFormFieldChoice( Poppler::FormFieldChoice * field, QAtomicInt *revision )
+    : Okular::FormFieldChoice(), m_field( field ), m_revision( revision )
 {
     m_rect = Okular::NormalizedRect::fromQRectF( m_field->rect() );
     SET_ACTIONS
@@ -275,6 +277,7 @@ QList<int> PopplerFormFieldChoice::currentChoices() const
 void PopplerFormFieldChoice::setCurrentChoices( const QList<int>& choices )
 {
     m_field->setCurrentChoices( choices );
+    m_revision->ref();
 }
 
 QString PopplerFormFieldChoice::editChoice() const
@@ -285,6 +288,7 @@ QString PopplerFormFieldChoice::editChoice() const
 void PopplerFormFieldChoice::setEditChoice( const QString& text )
 {
     m_field->setEditChoice( text );
+    m_revision->ref();
 }
 
 Qt::Alignment PopplerFormFieldChoice::textAlignment() const
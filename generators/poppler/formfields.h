@@ -10,13 +10,14 @@
 #ifndef _OKULAR_GENERATOR_PDF_FORMFIELDS_H_
 #define _OKULAR_GENERATOR_PDF_FORMFIELDS_H_
 
+#include <qatomic.h>
 #include <poppler-form.h>
 #include "core/form.h"
 
 class PopplerFormFieldButton : public Okular::FormFieldButton
 {
     public:
-        PopplerFormFieldButton( Poppler::FormFieldButton * field );
+        PopplerFormFieldButton( Poppler::FormFieldButton * field, QAtomicInt *revision );
         virtual ~PopplerFormFieldButton();
 
         // inherited from Okular::FormField
@@ -37,13 +38,15 @@ class PopplerFormFieldButton : public Okular::FormFieldButton
     private:
         Poppler::FormFieldButton * m_field;
         Okular::NormalizedRect m_rect;
+        // bumped on each change to the document
+        QAtomicInt * m_revision;
 
 };
 
 class PopplerFormFieldText : public Okular::FormFieldText
 {
     public:
-        PopplerFormFieldText( Poppler::FormFieldText * field );
+        PopplerFormFieldText( Poppler::FormFieldText * field, QAtomicInt *revision );
         virtual ~PopplerFormFieldText();
 
         // inherited from Okular::FormField
@@ -67,13 +70,15 @@ class PopplerFormFieldText : public Okular::FormFieldText
     private:
         Poppler::FormFieldText * m_field;
         Okular::NormalizedRect m_rect;
+        // bumped on each change to the document
+        QAtomicInt * m_revision;
 
 };
 
 class PopplerFormFieldChoice : public Okular::FormFieldChoice
 {
     public:
-        PopplerFormFieldChoice( Poppler::FormFieldChoice * field );
+        PopplerFormFieldChoice( Poppler::FormFieldChoice * field, QAtomicInt *revision );
         virtual ~PopplerFormFieldChoice();
 
         // inherited from Okular::FormField
@@ -99,6 +104,8 @@ class PopplerFormFieldChoice : public Okular::FormFieldChoice
     private:
         Poppler::FormFieldChoice * m_field;
         Okular::NormalizedRect m_rect;
+        // bumped on each change to the document
+        QAtomicInt * m_revision;
 
 };
 
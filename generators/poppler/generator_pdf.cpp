@@ -14,6 +14,8 @@
 // qt/kde includes
 #include <qcheckbox.h>
 #include <qcolor.h>
+#include <qcryptographichash.h>
+#include <qdatastream.h>
 #include <qdir.h>
 #include <qfile.h>
 #include <qimage.h>
@@ -65,6 +67,9 @@ Q_DECLARE_METATYPE(const Poppler::LinkOCGState*)
 
 static const int defaultPageWidth = 595;
 static const int defaultPageHeight = 842;
+// the largest file kept in memory, so that a reload can still tell what the
+// pages were once the file changed on disk
+static const qint64 maxFileContentsSize = 32 * 1024 * 1024;
 
 class PDFOptionsPage : public QWidget
 {
@@ -488,6 +493,14 @@ static QLinkedList<Okular::ObjectRect*> generateLinks( const QList<Poppler::Link
 
 OKULAR_EXPORT_PLUGIN(PDFGenerator, "libokularGenerator_poppler.json")
 
+static QByteArray readFileContents( const QString &filePath )
+{
+    QFile file( filePath );
+    if ( file.size() > maxFileContentsSize || !file.open( QIODevice::ReadOnly ) )
+        return QByteArray();
+    return file.readAll();
+}
+
 static void PDFGeneratorPopplerDebugFunction(const QString &message, const QVariant &closure)
 {
     Q_UNUSED(closure);
@@ -495,7 +508,7 @@ static void PDFGeneratorPopplerDebugFunction(const QString &message, const QVari
 }
 
 PDFGenerator::PDFGenerator( QObject *parent, const QVariantList &args )
-    : Generator( parent, args ), pdfdoc( 0 ),
+    : Generator( parent, args ), pdfdoc( 0 ), reloadable( false ), pdfdocRevision( 0 ),
     docSynopsisDirty( true ),
     docEmbeddedFilesDirty( true ), nextFontPage( 0 ),
     annotProxy( 0 )
@@ -512,6 +525,10 @@ PDFGenerator::PDFGenerator( QObject *parent, const QVariantList &args )
         setFeature( PrintToFile );
     setFeature( ReadRawData );
     setFeature( TiledRendering );
+    setFeature( ParallelRendering );
+#ifdef HAVE_POPPLER_0_63
+    setFeature( SupportsCancelling );
+#endif
 
     // You only need to do it once not for each of the documents but it is cheap enough
     // so doing it all the time won't hurt either
@@ -533,8 +550,15 @@ Okular::Document::OpenResult PDFGenerator::loadDocumentWithPassword( const QStri
         return Okular::Document::OpenError;
     }
 #endif
-    // create PDFDoc for the given file
-    pdfdoc = Poppler::Document::load( filePath, 0, 0 );
+    // create PDFDoc for the given file, from a copy of it if a reload will
+    // need to know what the pages were
+    if ( reloadable )
+        documentFileContents = readFileContents( filePath );
+    if ( documentFileContents.isEmpty() )
+        pdfdoc = Poppler::Document::load( filePath, 0, 0 );
+    else
+        pdfdoc = Poppler::Document::loadFromData( documentFileContents, 0, 0 );
+    documentFilePath = filePath;
     return init(pagesVector, password);
 }
 
@@ -549,6 +573,7 @@ Okular::Document::OpenResult PDFGenerator::loadDocumentFromDataWithPassword( con
 #endif
     // create PDFDoc for the given file
     pdfdoc = Poppler::Document::loadFromData( fileData, 0, 0 );
+    documentData = fileData;
     return init(pagesVector, password);
 }
 
@@ -579,6 +604,7 @@ Okular::Document::OpenResult PDFGenerator::init(QVector<Okular::Page*> & pagesVe
     rectsGenerated.fill(false, pageCount);
 
     annotationsHash.clear();
+    unresolvedMediaLinkPages.clear();
 
     loadPages(pagesVector, 0, false);
 
@@ -586,7 +612,9 @@ Okular::Document::OpenResult PDFGenerator::init(QVector<Okular::Page*> & pagesVe
     reparseConfig();
 
     // create annotation proxy
-    annotProxy = new PopplerAnnotationProxy( pdfdoc, userMutex() );
+    annotProxy = new PopplerAnnotationProxy( pdfdoc, userMutex(), &pdfdocRevision );
+
+    documentPassword = password.toLatin1();
 
     // the file has been loaded correctly
     return Okular::Document::OpenSuccess;
@@ -600,7 +628,14 @@ bool PDFGenerator::doCloseDocument()
     annotProxy = 0;
     delete pdfdoc;
     pdfdoc = 0;
+    qDeleteAll(renderDocs);
+    renderDocs.clear();
     userMutex()->unlock();
+    documentFilePath.clear();
+    documentFileContents.clear();
+    documentData.clear();
+    documentPassword.clear();
+    pdfdocRevision.store( 0 );
     docSynopsisDirty = true;
     docSyn.clear();
     docEmbeddedFilesDirty = true;
@@ -608,6 +643,7 @@ bool PDFGenerator::doCloseDocument()
     docEmbeddedFiles.clear();
     nextFontPage = 0;
     rectsGenerated.clear();
+    unresolvedMediaLinkPages.clear();
 
     return true;
 }
@@ -637,25 +673,11 @@ void PDFGenerator::loadPages(QVector<Okular::Page*> &pagesVector, int rotation,
             }
             if (rotation % 2 == 1)
             qSwap(w,h);
-            // init a Okular::page, add transition and annotation information
+            // init a Okular::page, the transition, annotations, forms and
+            // actions are left to loadPageData()
             page = new Okular::Page( i, w, h, orientation );
-            addTransition( p, page );
-            if ( true ) //TODO real check
-            addAnnotations( p, page );
-            Poppler::Link * tmplink = p->action( Poppler::Page::Opening );
-            if ( tmplink )
-            {
-                page->setPageAction( Okular::Page::Opening, createLinkFromPopplerLink( tmplink ) );
-            }
-            tmplink = p->action( Poppler::Page::Closing );
-            if ( tmplink )
-            {
-                page->setPageAction( Okular::Page::Closing, createLinkFromPopplerLink( tmplink ) );
-            }
             page->setDuration( p->duration() );
             page->setLabel( p->label() );
-
-            addFormFields( p, page );
 //        kWarning(PDFDebug).nospace() << page->width() << "x" << page->height();
 
 #ifdef PDFGENERATOR_DEBUG
@@ -675,6 +697,58 @@ void PDFGenerator::loadPages(QVector<Okular::Page*> &pagesVector, int rotation,
     }
 }
 
+void PDFGenerator::loadPageData( Okular::Page *page )
+{
+    QMutexLocker ml( userMutex() );
+    if ( !pdfdoc )
+        return;
+
+    Poppler::Page * p = pdfdoc->page( page->number() );
+    if ( !p )
+        return;
+
+    // add transition, annotation, action and form information
+    addTransition( p, page );
+    const int annotationCount = annotationsHash.count();
+    addAnnotations( p, page );
+    Poppler::Link * tmplink = p->action( Poppler::Page::Opening );
+    if ( tmplink )
+    {
+        page->setPageAction( Okular::Page::Opening, createLinkFromPopplerLink( tmplink ) );
+    }
+    tmplink = p->action( Poppler::Page::Closing );
+    if ( tmplink )
+    {
+        page->setPageAction( Okular::Page::Closing, createLinkFromPopplerLink( tmplink ) );
+    }
+
+    addFormFields( p, page );
+
+    // the pages kept through a reload may not be rendered again
+    if ( !rectsGenerated.at( page->number() ) )
+    {
+        page->setObjectRects( generateLinks( p->links() ) );
+        rectsGenerated[ page->number() ] = true;
+    }
+
+    // the movies and screens the media links of a page refer to may be
+    // on pages whose data is loaded later on
+    if ( !resolveMediaLinkReferences( page ) && !unresolvedMediaLinkPages.contains( page ) )
+        unresolvedMediaLinkPages.append( page );
+    if ( annotationsHash.count() > annotationCount )
+    {
+        QMutableListIterator<Okular::Page*> it( unresolvedMediaLinkPages );
+        while ( it.hasNext() )
+        {
+            Okular::Page *unresolvedPage = it.next();
+            if ( unresolvedPage != page && resolveMediaLinkReferences( unresolvedPage ) )
+                it.remove();
+        }
+    }
+
+    delete p;
+}
+
 Okular::DocumentInfo PDFGenerator::generateDocumentInfo( const QSet<Okular::DocumentInfo::Key> &keys ) const
 {
     Okular::DocumentInfo docInfo;
@@ -894,6 +968,14 @@ bool PDFGenerator::isAllowed( Okular::Permission permission ) const
     return b;
 }
 
+#ifdef HAVE_POPPLER_0_63
+static bool shouldAbortRenderCallback( const QVariant &payload )
+{
+    const Okular::PixmapRequest *request = static_cast<const Okular::PixmapRequest *>( payload.value<void *>() );
+    return request->shouldAbortRender();
+}
+#endif
+
 QImage PDFGenerator::image( Okular::PixmapRequest * request )
 {
     // debug requests to this (xpdf) generator
@@ -911,20 +993,50 @@ QImage PDFGenerator::image( Okular::PixmapRequest * request )
     qreal fakeDpiX = request->width() / pageWidth * dpi().width();
     qreal fakeDpiY = request->height() / pageHeight * dpi().height();
 
-    // generate links rects only the first time
-    bool genObjectRects = !rectsGenerated.at( page->number() );
+    // render workers use their own document, so they don't need to wait
+    // for each other; it is loaded from the file, so it can't be used any
+    // more as soon as annotations or forms are edited in pdfdoc, be it by
+    // the user or when restoring them from the docdata
+    Poppler::Document *workerDoc = 0;
+    const int worker = renderWorker( request );
+    if ( worker >= 0 && pdfdocRevision.load() == 0 )
+        workerDoc = renderDocument( worker );
 
     // 0. LOCK [waits for the thread end]
-    userMutex()->lock();
+    if ( !workerDoc )
+        userMutex()->lock();
 
     // 1. Set OutputDev parameters and Generate contents
     // note: thread safety is set on 'false' for the GUI (this) thread
-    Poppler::Page *p = pdfdoc->page(page->number());
+    Poppler::Document *renderDoc = workerDoc ? workerDoc : pdfdoc;
+    Poppler::Page *p = renderDoc->page(page->number());
+
+    // previews are only shown until the full render arrives, antialiasing
+    // is not worth its time there
+    const Poppler::Document::RenderHints renderHints = renderDoc->renderHints();
+    if ( request->isPreview() )
+    {
+        renderDoc->setRenderHint( Poppler::Document::Antialiasing, false );
+        renderDoc->setRenderHint( Poppler::Document::TextAntialiasing, false );
+        renderDoc->setRenderHint( Poppler::Document::TextHinting, false );
+    }
 
     // 2. Take data from outputdev and attach it to the Page
     QImage img;
     if (p)
     {
+#ifdef HAVE_POPPLER_0_63
+        const QVariant payload = QVariant::fromValue<void *>( request );
+        if ( request->isTile() )
+        {
+            QRect rect = request->normalizedRect().geometry( request->width(), request->height() );
+            img = p->renderToImage( fakeDpiX, fakeDpiY, rect.x(), rect.y(), rect.width(), rect.height(), Poppler::Page::Rotate0, nullptr, nullptr, shouldAbortRenderCallback, payload );
+        }
+        else
+        {
+            img = p->renderToImage(fakeDpiX, fakeDpiY, -1, -1, -1, -1, Poppler::Page::Rotate0, nullptr, nullptr, shouldAbortRenderCallback, payload );
+        }
+#else
         if ( request->isTile() )
         {
             QRect rect = request->normalizedRect().geometry( request->width(), request->height() );
@@ -934,6 +1046,7 @@ QImage PDFGenerator::image( Okular::PixmapRequest * request )
         {
             img = p->renderToImage(fakeDpiX, fakeDpiY, -1, -1, -1, -1, Poppler::Page::Rotate0 );
         }
+#endif
     }
     else
     {
@@ -941,15 +1054,32 @@ QImage PDFGenerator::image( Okular::PixmapRequest * request )
         img.fill( Qt::white );
     }
 
+    if ( request->isPreview() )
+    {
+        renderDoc->setRenderHint( Poppler::Document::Antialiasing, renderHints.testFlag( Poppler::Document::Antialiasing ) );
+        renderDoc->setRenderHint( Poppler::Document::TextAntialiasing, renderHints.testFlag( Poppler::Document::TextAntialiasing ) );
+        renderDoc->setRenderHint( Poppler::Document::TextHinting, renderHints.testFlag( Poppler::Document::TextHinting ) );
+    }
+
+    // the object rects are shared state, always build them from pdfdoc
+    if ( workerDoc )
+        userMutex()->lock();
+
+    // generate links rects only the first time
+    const bool genObjectRects = !rectsGenerated.at( page->number() );
     if ( p && genObjectRects )
     {
+        Poppler::Page *linksPage = workerDoc ? pdfdoc->page( page->number() ) : p;
+
         // TODO previously we extracted Image type rects too, but that needed porting to poppler
         // and as we are not doing anything with Image type rects i did not port it, have a look at
         // dead gp_outputdev.cpp on image extraction
-        page->setObjectRects( generateLinks(p->links()) );
+        if ( linksPage )
+            page->setObjectRects( generateLinks(linksPage->links()) );
         rectsGenerated[ request->page()->number() ] = true;
 
-        resolveMediaLinkReferences( page );
+        if ( linksPage != p )
+            delete linksPage;
     }
 
     // 3. UNLOCK [re-enables shared access]
@@ -965,7 +1095,10 @@ void resolveMediaLinks( Okular::Action *action, enum Okular::Annotation::SubType
 {
     OkularLinkType *okularAction = static_cast<OkularLinkType*>( action );
 
+    // already resolved
     const PopplerLinkType *popplerLink = action->nativeId().value<const PopplerLinkType*>();
+    if ( !popplerLink )
+        return;
 
     QHashIterator<Okular::Annotation*, Poppler::Annotation*> it( annotationsHash );
     while ( it.hasNext() )
@@ -987,42 +1120,48 @@ void resolveMediaLinks( Okular::Action *action, enum Okular::Annotation::SubType
     }
 }
 
-void PDFGenerator::resolveMediaLinkReference( Okular::Action *action )
+bool PDFGenerator::resolveMediaLinkReference( Okular::Action *action )
 {
     if ( !action )
-        return;
+        return true;
 
-    if ( (action->actionType() != Okular::Action::Movie) && (action->actionType() != Okular::Action::Rendition) )
-        return;
+    if ( action->actionType() == Okular::Action::Movie )
+        resolveMediaLinks<Poppler::LinkMovie, Okular::MovieAction, Poppler::MovieAnnotation, Okular::MovieAnnotation>( action, Okular::Annotation::AMovie, annotationsHash );
+    else if ( action->actionType() == Okular::Action::Rendition )
+        resolveMediaLinks<Poppler::LinkRendition, Okular::RenditionAction, Poppler::ScreenAnnotation, Okular::ScreenAnnotation>( action, Okular::Annotation::AScreen, annotationsHash );
+    else
+        return true;
 
-    resolveMediaLinks<Poppler::LinkMovie, Okular::MovieAction, Poppler::MovieAnnotation, Okular::MovieAnnotation>( action, Okular::Annotation::AMovie, annotationsHash );
-    resolveMediaLinks<Poppler::LinkRendition, Okular::RenditionAction, Poppler::ScreenAnnotation, Okular::ScreenAnnotation>( action, Okular::Annotation::AScreen, annotationsHash );
+    // the native link is dropped once resolved
+    return !action->nativeId().isValid();
 }
 
-void PDFGenerator::resolveMediaLinkReferences( Okular::Page *page )
+bool PDFGenerator::resolveMediaLinkReferences( Okular::Page *page )
 {
-    resolveMediaLinkReference( const_cast<Okular::Action*>( page->pageAction( Okular::Page::Opening ) ) );
-    resolveMediaLinkReference( const_cast<Okular::Action*>( page->pageAction( Okular::Page::Closing ) ) );
+    bool resolved = resolveMediaLinkReference( const_cast<Okular::Action*>( page->pageAction( Okular::Page::Opening ) ) );
+    resolved = resolveMediaLinkReference( const_cast<Okular::Action*>( page->pageAction( Okular::Page::Closing ) ) ) && resolved;
 
     foreach ( Okular::Annotation *annotation, page->annotations() )
     {
         if ( annotation->subType() == Okular::Annotation::AScreen )
         {
             Okular::ScreenAnnotation *screenAnnotation = static_cast<Okular::ScreenAnnotation*>( annotation );
-            resolveMediaLinkReference( screenAnnotation->additionalAction( Okular::Annotation::PageOpening ) );
-            resolveMediaLinkReference( screenAnnotation->additionalAction( Okular::Annotation::PageClosing ) );
+            resolved = resolveMediaLinkReference( screenAnnotation->additionalAction( Okular::Annotation::PageOpening ) ) && resolved;
+            resolved = resolveMediaLinkReference( screenAnnotation->additionalAction( Okular::Annotation::PageClosing ) ) && resolved;
         }
 
         if ( annotation->subType() == Okular::Annotation::AWidget )
         {
             Okular::WidgetAnnotation *widgetAnnotation = static_cast<Okular::WidgetAnnotation*>( annotation );
-            resolveMediaLinkReference( widgetAnnotation->additionalAction( Okular::Annotation::PageOpening ) );
-            resolveMediaLinkReference( widgetAnnotation->additionalAction( Okular::Annotation::PageClosing ) );
+            resolved = resolveMediaLinkReference( widgetAnnotation->additionalAction( Okular::Annotation::PageOpening ) ) && resolved;
+            resolved = resolveMediaLinkReference( widgetAnnotation->additionalAction( Okular::Annotation::PageClosing ) ) && resolved;
         }
     }
 
     foreach ( Okular::FormField *field, page->formFields() )
-        resolveMediaLinkReference( field->activationAction() );
+        resolved = resolveMediaLinkReference( field->activationAction() ) && resolved;
+
+    return resolved;
 }
 
 Okular::TextPage* PDFGenerator::textPage( Okular::Page *page )
@@ -1033,12 +1172,13 @@ Okular::TextPage* PDFGenerator::textPage( Okular::Page *page )
     // build a TextList...
     QList<Poppler::TextBox*> textList;
     double pageWidth, pageHeight;
+    // this runs in the text threads while loadPageData() and the other
+    // text threads use pdfdoc as well
+    userMutex()->lock();
     Poppler::Page *pp = pdfdoc->page( page->number() );
     if (pp)
     {
-        userMutex()->lock();
         textList = pp->textList();
-        userMutex()->unlock();
 
         QSizeF s = pp->pageSizeF();
         pageWidth = s.width();
@@ -1051,6 +1191,7 @@ Okular::TextPage* PDFGenerator::textPage( Okular::Page *page )
         pageWidth = defaultPageWidth;
         pageHeight = defaultPageHeight;
     }
+    userMutex()->unlock();
 
     Okular::TextPage *tp = abstractTextPage(textList, pageHeight, pageWidth, (Poppler::Page::Rotation)page->orientation());
     qDeleteAll(textList);
@@ -1293,7 +1434,10 @@ bool PDFGenerator::reparseConfig()
         userMutex()->unlock();
         somethingchanged = true;
     }
-    bool aaChanged = setDocumentRenderHints();
+    // the render workers copy the hints
+    userMutex()->lock();
+    bool aaChanged = setDocumentRenderHints( pdfdoc );
+    userMutex()->unlock();
     somethingchanged = somethingchanged || aaChanged;
     return somethingchanged;
 }
@@ -1308,16 +1452,16 @@ void PDFGenerator::addPages( KConfigDialog *dlg )
 #endif
 }
 
-bool PDFGenerator::setDocumentRenderHints()
+bool PDFGenerator::setDocumentRenderHints( Poppler::Document *doc )
 {
     bool changed = false;
-    const Poppler::Document::RenderHints oldhints = pdfdoc->renderHints();
+    const Poppler::Document::RenderHints oldhints = doc->renderHints();
 #define SET_HINT(hintname, hintdefvalue, hintflag) \
 { \
     bool newhint = documentMetaData(hintname, hintdefvalue).toBool(); \
     if (newhint != oldhints.testFlag(hintflag)) \
     { \
-        pdfdoc->setRenderHint(hintflag, newhint); \
+        doc->setRenderHint(hintflag, newhint); \
         changed = true; \
     } \
 }
@@ -1333,17 +1477,67 @@ bool PDFGenerator::setDocumentRenderHints()
     const bool thinLineSolidWasEnabled = (oldhints & Poppler::Document::ThinLineSolid) == Poppler::Document::ThinLineSolid;
     const bool thinLineShapeWasEnabled = (oldhints & Poppler::Document::ThinLineShape) == Poppler::Document::ThinLineShape;
     if (enableThinLineSolid != thinLineSolidWasEnabled) {
-      pdfdoc->setRenderHint(Poppler::Document::ThinLineSolid, enableThinLineSolid);
+      doc->setRenderHint(Poppler::Document::ThinLineSolid, enableThinLineSolid);
       changed = true;
     }
     if (enableShapeLineSolid != thinLineShapeWasEnabled) {
-      pdfdoc->setRenderHint(Poppler::Document::ThinLineShape, enableShapeLineSolid);
+      doc->setRenderHint(Poppler::Document::ThinLineShape, enableShapeLineSolid);
       changed = true;
     }
 #endif
     return changed;
 }
 
+Poppler::Document *PDFGenerator::renderDocument( int worker )
+{
+    QMutexLocker locker( userMutex() );
+    if ( !pdfdoc )
+        return 0;
+
+    if ( renderDocs.count() <= worker )
+        renderDocs.resize( worker + 1 );
+
+    Poppler::Document *doc = renderDocs.at( worker );
+    if ( !doc )
+    {
+        if ( !documentData.isEmpty() )
+            doc = Poppler::Document::loadFromData( documentData, 0, 0 );
+        else if ( !documentFileContents.isEmpty() )
+            doc = Poppler::Document::loadFromData( documentFileContents, 0, 0 );
+        else
+            doc = Poppler::Document::load( documentFilePath, 0, 0 );
+
+        if ( doc && doc->isLocked() )
+            doc->unlock( documentPassword, documentPassword );
+
+        if ( !doc || doc->isLocked() )
+        {
+            qCDebug(OkularPdfDebug) << "Could not load a document for render worker" << worker;
+            delete doc;
+            return 0;
+        }
+        renderDocs[ worker ] = doc;
+    }
+
+    // keep up with configuration changes done on pdfdoc; the hints are
+    // copied from it as they were read from the settings in the GUI thread
+    if ( doc->paperColor() != pdfdoc->paperColor() )
+        doc->setPaperColor( pdfdoc->paperColor() );
+    const Poppler::Document::RenderHints hints = pdfdoc->renderHints();
+    if ( doc->renderHints() != hints )
+    {
+        doc->setRenderHint( Poppler::Document::Antialiasing, hints.testFlag( Poppler::Document::Antialiasing ) );
+        doc->setRenderHint( Poppler::Document::TextAntialiasing, hints.testFlag( Poppler::Document::TextAntialiasing ) );
+        doc->setRenderHint( Poppler::Document::TextHinting, hints.testFlag( Poppler::Document::TextHinting ) );
+#ifdef HAVE_POPPLER_0_24
+        doc->setRenderHint( Poppler::Document::ThinLineSolid, hints.testFlag( Poppler::Document::ThinLineSolid ) );
+        doc->setRenderHint( Poppler::Document::ThinLineShape, hints.testFlag( Poppler::Document::ThinLineShape ) );
+#endif
+    }
+
+    return doc;
+}
+
 Okular::ExportFormat::List PDFGenerator::exportFormats() const
 {
     static Okular::ExportFormat::List formats;
@@ -1648,13 +1842,13 @@ void PDFGenerator::addFormFields( Poppler::Page * popplerPage, Okular::Page * pa
         switch ( f->type() )
         {
             case Poppler::FormField::FormButton:
-                of = new PopplerFormFieldButton( static_cast<Poppler::FormFieldButton*>( f ) );
+                of = new PopplerFormFieldButton( static_cast<Poppler::FormFieldButton*>( f ), &pdfdocRevision );
                 break;
             case Poppler::FormField::FormText:
-                of = new PopplerFormFieldText( static_cast<Poppler::FormFieldText*>( f ) );
+                of = new PopplerFormFieldText( static_cast<Poppler::FormFieldText*>( f ), &pdfdocRevision );
                 break;
             case Poppler::FormField::FormChoice:
-                of = new PopplerFormFieldChoice( static_cast<Poppler::FormFieldChoice*>( f ) );
+                of = new PopplerFormFieldChoice( static_cast<Poppler::FormFieldChoice*>( f ), &pdfdocRevision );
                 break;
             default: ;
         }
@@ -1734,6 +1928,98 @@ Okular::AnnotationProxy* PDFGenerator::annotationProxy() const
     return annotProxy;
 }
 
+QByteArray PDFGenerator::pageFingerprint( int page )
+{
+    // a document read from its file as needed may read the new one already
+    QMutexLocker locker( userMutex() );
+    if ( !pdfdoc || documentFileContents.isEmpty() )
+        return QByteArray();
+
+    Poppler::Page *p = pdfdoc->page( page );
+    if ( !p )
+        return QByteArray();
+
+    // poppler gives no access to the content stream of the page, so the
+    // fingerprint covers what it shows instead: size, text, annotations and
+    // a small render for the rest; an edit too small to change a pixel of
+    // that render, e.g. a thin line moved by a fraction of a point, goes
+    // unnoticed
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+    QByteArray data;
+    QDataStream stream( &data, QIODevice::WriteOnly );
+    stream << p->pageSizeF() << (int)p->orientation() << p->label();
+
+    QList<Poppler::TextBox*> text = p->textList();
+    foreach ( Poppler::TextBox *box, text )
+        stream << box->text() << box->boundingBox();
+    qDeleteAll( text );
+
+    QList<Poppler::Annotation*> annotations = p->annotations();
+    foreach ( Poppler::Annotation *annotation, annotations )
+        stream << (int)annotation->subType() << annotation->boundary() << annotation->contents() << annotation->uniqueName();
+    qDeleteAll( annotations );
+    hash.addData( data );
+
+    const QImage img = p->renderToImage( 72, 72 );
+    hash.addData( reinterpret_cast< const char * >( img.constBits() ), img.byteCount() );
+
+    delete p;
+    return hash.result();
+}
+
+void PDFGenerator::setReloadable( bool canReload )
+{
+    reloadable = canReload;
+}
+
+bool PDFGenerator::reloadDocument( const QString &fileName, QVector<Okular::Page*> &pagesVector )
+{
+    // the data and the temporary files are not reloaded
+    if ( !documentData.isEmpty() || documentFilePath != fileName )
+        return false;
+
+    const QByteArray fileContents = reloadable ? readFileContents( fileName ) : QByteArray();
+    Poppler::Document *newdoc;
+    if ( fileContents.isEmpty() )
+        newdoc = Poppler::Document::load( fileName, 0, 0 );
+    else
+        newdoc = Poppler::Document::loadFromData( fileContents, 0, 0 );
+    if ( !newdoc )
+        return false;
+
+    const QByteArray password = documentPassword;
+    if ( newdoc->isLocked() )
+    {
+        newdoc->unlock( password, password );
+        if ( newdoc->isLocked() )
+        {
+            delete newdoc;
+            return false;
+        }
+    }
+
+    closeDocument();
+    pdfdoc = newdoc;
+    documentFilePath = fileName;
+    documentFileContents = fileContents;
+    return init( pagesVector, QString::fromLatin1( password ) ) == Okular::Document::OpenSuccess;
+}
+
+QImage PDFGenerator::embeddedThumbnail( int page )
+{
+    QMutexLocker locker( userMutex() );
+    if ( !pdfdoc )
+        return QImage();
+
+    Poppler::Page *p = pdfdoc->page( page );
+    if ( !p )
+        return QImage();
+
+    const QImage thumbnail = p->thumbnail();
+    delete p;
+    return thumbnail;
+}
+
 #include "generator_pdf.moc"
 
 Q_LOGGING_CATEGORY(OkularPdfDebug, "org.kde.okular.generators.pdf", QtWarningMsg)
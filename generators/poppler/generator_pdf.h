@@ -16,14 +16,18 @@
 #include <poppler-qt5.h>
 
 
+#include <qatomic.h>
 #include <qbitarray.h>
 #include <qpointer.h>
 
 #include <core/document.h>
 #include <core/generator.h>
 #include <interfaces/configinterface.h>
+#include <interfaces/pagedatainterface.h>
 #include <interfaces/printinterface.h>
+#include <interfaces/reloadinterface.h>
 #include <interfaces/saveinterface.h>
+#include <interfaces/thumbnailinterface.h>
 
 namespace Okular {
 class ObjectRect;
@@ -45,13 +49,16 @@ class PopplerAnnotationProxy;
  * contents from out OutputDevs when rendering finishes.
  *
  */
-class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, public Okular::PrintInterface, public Okular::SaveInterface
+class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, public Okular::PrintInterface, public Okular::SaveInterface, public Okular::PageDataInterface, public Okular::ReloadInterface, public Okular::ThumbnailInterface
 {
     Q_OBJECT
     Q_INTERFACES( Okular::Generator )
     Q_INTERFACES( Okular::ConfigInterface )
     Q_INTERFACES( Okular::PrintInterface )
     Q_INTERFACES( Okular::SaveInterface )
+    Q_INTERFACES( Okular::PageDataInterface )
+    Q_INTERFACES( Okular::ReloadInterface )
+    Q_INTERFACES( Okular::ThumbnailInterface )
 
     public:
         PDFGenerator( QObject *parent, const QVariantList &args );
@@ -61,6 +68,8 @@ class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, p
         Okular::Document::OpenResult loadDocumentWithPassword( const QString & fileName, QVector<Okular::Page*> & pagesVector, const QString & password ) override;
         Okular::Document::OpenResult loadDocumentFromDataWithPassword( const QByteArray & fileData, QVector<Okular::Page*> & pagesVector, const QString & password ) override;
         void loadPages(QVector<Okular::Page*> &pagesVector, int rotation=-1, bool clear=false);
+        // [INHERITED] the page data left out by loadPages()
+        void loadPageData( Okular::Page *page ) override;
         // [INHERITED] document information
         Okular::DocumentInfo generateDocumentInfo( const QSet<Okular::DocumentInfo::Key> &keys ) const override;
         const Okular::DocumentSynopsis * generateDocumentSynopsis() override;
@@ -98,6 +107,14 @@ class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, p
         bool save( const QString &fileName, SaveOptions options, QString *errorText ) override;
         Okular::AnnotationProxy* annotationProxy() const override;
 
+        // [INHERITED] reload interface
+        QByteArray pageFingerprint( int page ) override;
+        void setReloadable( bool reloadable ) override;
+        bool reloadDocument( const QString &fileName, QVector<Okular::Page*> &pagesVector ) override;
+
+        // [INHERITED] thumbnail interface
+        QImage embeddedThumbnail( int page ) override;
+
     protected:
         bool doCloseDocument() override;
         Okular::TextPage* textPage( Okular::Page *page ) override;
@@ -120,14 +137,31 @@ class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, p
 
         Okular::TextPage * abstractTextPage(const QList<Poppler::TextBox*> &text, double height, double width, int rot);
 
-        void resolveMediaLinkReferences( Okular::Page *page );
-        void resolveMediaLinkReference( Okular::Action *action );
+        // return whether all the media links have their movie or screen
+        bool resolveMediaLinkReferences( Okular::Page *page );
+        bool resolveMediaLinkReference( Okular::Action *action );
 
-        bool setDocumentRenderHints();
+        bool setDocumentRenderHints( Poppler::Document *doc );
+
+        // returns the document the given render worker renders with, loading it if needed
+        Poppler::Document *renderDocument( int worker );
 
         // poppler dependant stuff
         Poppler::Document *pdfdoc;
 
+        // one document per render worker, see ParallelRendering
+        QVector<Poppler::Document*> renderDocs;
+        QString documentFilePath;
+        // the contents of documentFilePath as loaded, when small enough and
+        // the document may be reloaded
+        bool reloadable;
+        QByteArray documentFileContents;
+        QByteArray documentData;
+        QByteArray documentPassword;
+        // the edits made to annotations and forms of pdfdoc since it was
+        // loaded, the render workers only have the file as it was
+        QAtomicInt pdfdocRevision;
+
 
         // misc variables for document info and synopsis caching
         bool docSynopsisDirty;
@@ -137,6 +171,8 @@ class PDFGenerator : public Okular::Generator, public Okular::ConfigInterface, p
         int nextFontPage;
         PopplerAnnotationProxy *annotProxy;
         QHash<Okular::Annotation*, Poppler::Annotation*> annotationsHash;
+        // the pages whose media links refer to annotations not loaded yet
+        QList<Okular::Page*> unresolvedMediaLinkPages;
 
         QBitArray rectsGenerated;
 
@@ -0,0 +1,67 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_PAGEDATAINTERFACE_H_
+#define _OKULAR_PAGEDATAINTERFACE_H_
+
+#include "../core/okularcore_export.h"
+
+#include <QtCore/QObject>
+
+namespace Okular {
+
+class Page;
+
+/**
+ * @short Abstract interface for loading the data of the pages on demand
+ *
+ * This interface lets a Generator create the pages of a document with only
+ * what is needed to lay them out (size, orientation, label, ...) and leave
+ * the rest (annotations, form fields, transition, page actions) to be loaded
+ * later, so that opening a document does not depend on its page count.
+ *
+ * The document asks for the data of a page the first time the page becomes
+ * visible or the data is asked for through the Page API, and loads the
+ * remaining pages a few at a time while idle.
+ *
+ * How to use it in a custom Generator:
+ * @code
+    class MyGenerator : public Okular::Generator, public Okular::PageDataInterface
+    {
+        Q_OBJECT
+        Q_INTERFACES( Okular::PageDataInterface )
+
+        ...
+    };
+ * @endcode
+ * and - of course - implementing its methods.
+ *
+ * @since 1.3
+ */
+class OKULARCORE_EXPORT PageDataInterface
+{
+    public:
+        /**
+         * Destroys the page data interface.
+         */
+        virtual ~PageDataInterface() {}
+
+        /**
+         * Adds to @p page the data left out when it was created in
+         * loadDocument(). It is called once for each page, in the GUI
+         * thread.
+         */
+        virtual void loadPageData( Page *page ) = 0;
+};
+
+}
+
+Q_DECLARE_INTERFACE( Okular::PageDataInterface, "org.kde.okular.PageDataInterface/0.1" )
+
+#endif
@@ -0,0 +1,91 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_RELOADINTERFACE_H_
+#define _OKULAR_RELOADINTERFACE_H_
+
+#include "../core/okularcore_export.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+
+namespace Okular {
+
+class Page;
+
+/**
+ * @short Abstract interface for reloading a document whose file changed
+ *
+ * This interface lets a Generator open again the file of its document
+ * without being closed first, and tell which pages look the same as before,
+ * so that the document keeps what it has of those (pixmaps, text, ...)
+ * instead of starting from scratch.
+ *
+ * How to use it in a custom Generator:
+ * @code
+    class MyGenerator : public Okular::Generator, public Okular::ReloadInterface
+    {
+        Q_OBJECT
+        Q_INTERFACES( Okular::ReloadInterface )
+
+        ...
+    };
+ * @endcode
+ * and - of course - implementing its methods.
+ *
+ * @since 1.3
+ */
+class OKULARCORE_EXPORT ReloadInterface
+{
+    public:
+        /**
+         * Destroys the reload interface.
+         */
+        virtual ~ReloadInterface() {}
+
+        /**
+         * Returns a fingerprint of the page number @p page of the document
+         * currently loaded: two pages with the same fingerprint, before and
+         * after a reload, must render the same and have the same text. An
+         * empty fingerprint means the page always counts as changed.
+         *
+         * It is only called on reload, for the pages the document has
+         * pixmaps or text of: first on the document as loaded, while the
+         * file already changed on disk, then on the reloaded one. A generator
+         * that cannot tell what the page was without its file must return an
+         * empty fingerprint then.
+         */
+        virtual QByteArray pageFingerprint( int page ) = 0;
+
+        /**
+         * Tells whether the document about to be loaded may be reloaded
+         * later. Only then does the generator need to keep what
+         * pageFingerprint() needs once the file changed, if anything.
+         */
+        virtual void setReloadable( bool reloadable ) = 0;
+
+        /**
+         * Loads again the document from @p fileName, which changed since it
+         * was loaded, and fills @p pagesVector with its pages as
+         * loadDocument() does. The pages of the previous load are not used
+         * afterwards.
+         *
+         * Returns false if the document could not be loaded again this way,
+         * e.g. because it now needs a password; the generator may be left
+         * without a document then, and the document is opened from scratch.
+         */
+        virtual bool reloadDocument( const QString &fileName, QVector< Page * > &pagesVector ) = 0;
+};
+
+}
+
+Q_DECLARE_INTERFACE( Okular::ReloadInterface, "org.kde.okular.ReloadInterface/0.1" )
+
+#endif
@@ -0,0 +1,64 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef _OKULAR_THUMBNAILINTERFACE_H_
+#define _OKULAR_THUMBNAILINTERFACE_H_
+
+#include "../core/okularcore_export.h"
+
+#include <QtCore/QObject>
+#include <QtGui/QImage>
+
+namespace Okular {
+
+/**
+ * @short Abstract interface for the thumbnails stored in documents
+ *
+ * This interface lets a Generator hand out the thumbnails some documents
+ * carry for their pages, so that the thumbnails of those pages are shown
+ * without rendering them.
+ *
+ * How to use it in a custom Generator:
+ * @code
+    class MyGenerator : public Okular::Generator, public Okular::ThumbnailInterface
+    {
+        Q_OBJECT
+        Q_INTERFACES( Okular::ThumbnailInterface )
+
+        ...
+    };
+ * @endcode
+ * and - of course - implementing its methods.
+ *
+ * @since 1.3
+ */
+class OKULARCORE_EXPORT ThumbnailInterface
+{
+    public:
+        /**
+         * Destroys the thumbnail interface.
+         */
+        virtual ~ThumbnailInterface() {}
+
+        /**
+         * Returns the thumbnail stored in the document for the page number
+         * @p page, unrotated, or a null image if there is none. It is used
+         * when it is not much smaller than the thumbnail to show.
+         *
+         * It is called in a thread other than the GUI one, so it must take
+         * the userMutex() if needed.
+         */
+        virtual QImage embeddedThumbnail( int page ) = 0;
+};
+
+}
+
+Q_DECLARE_INTERFACE( Okular::ThumbnailInterface, "org.kde.okular.ThumbnailInterface/0.1" )
+
+#endif
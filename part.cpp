@@ -495,6 +495,7 @@ m_cliPresentation(false), m_cliPrint(false), m_embedMode(detectEmbedMode(parentW
     connect( m_document, &Document::notice, this, &Part::noticeMessage );
     connect( m_document, &Document::sourceReferenceActivated, this, &Part::slotHandleActivatedSourceReference );
     connect( m_pageView.data(), &PageView::fitWindowToPage, this, &Part::fitWindowToPage );
+    connect( m_pageView.data(), &PageView::formWidgetsAvailable, this, &Part::slotFormWidgetsAvailable );
     rightLayout->addWidget( m_pageView );
     m_layers->setPageView( m_pageView );
     m_findBar = new FindBar( m_document, rightContainer );
@@ -1007,6 +1008,9 @@ bool Part::isWatchFileModeEnabled() const
 
 void Part::setWatchFileModeEnabled(bool enabled)
 {
+    // only a watched file gets reloaded in place
+    m_document->setReloadable( enabled );
+
     if ( enabled && m_watcher->isStopped() )
     {
         m_watcher->startScan();
@@ -1472,9 +1476,7 @@ bool Part::openFile()
     // m_pageView->toggleFormsAction() may be null on dummy mode
     else if ( ok && m_pageView->toggleFormsAction() && m_pageView->toggleFormsAction()->isEnabled() )
     {
-        m_formsMessage->setText( i18n( "This document has forms. Click on the button to interact with them, or use View -> Show Forms." ) );
-        m_formsMessage->setMessageType( KMessageWidget::Information );
-        m_formsMessage->setVisible( true );
+        slotFormWidgetsAvailable();
     }
     else
     {
@@ -1857,6 +1859,29 @@ void Part::slotDoFileDirty()
         m_pageView->displayMessage( i18n("Reloading the document...") );
     }
 
+    // when the generator can, reload in place keeping what did not change;
+    // the document is closed if that fails, and opened again below
+    if ( url().isLocalFile() && !m_tempfile && m_temporaryLocalFile.isEmpty() && !isModified()
+         && m_document->reloadDocumentFile() )
+    {
+        if ( tocReloadPrepared )
+            m_toc->finishReload();
+        m_oldUrl = QUrl();
+        m_viewportDirty.pageNumber = -1;
+
+        // the file may have been replaced instead of written to
+        m_watcher->removeFile( localFilePath() );
+        addFileToWatcher( m_watcher, localFilePath() );
+#ifdef OKULAR_KEEP_FILE_OPEN
+        m_keeper->close();
+        if ( keepFileOpen() )
+            m_keeper->open( localFilePath() );
+#endif
+        updateViewActions();
+        setWindowTitleFromDocument();
+        return;
+    }
+
     // close and (try to) reopen the document
     if ( !closeUrl() )
     {
@@ -2515,6 +2540,9 @@ void Part::slotNewConfig()
 
     setWindowTitleFromDocument ();
 
+    if ( m_presentationWidget )
+        m_presentationWidget->reparseConfig();
+
     if ( m_presentationDrawingActions ) {
         m_presentationDrawingActions->reparseConfig();
         if (factory()) {
@@ -2676,6 +2704,17 @@ void Part::slotShowEmbeddedFiles()
 }
 
 
+void Part::slotFormWidgetsAvailable()
+{
+    // the XFA warning stays
+    if ( m_document->metaData( QStringLiteral("HasUnsupportedXfaForm") ).toBool() )
+        return;
+
+    m_formsMessage->setText( i18n( "This document has forms. Click on the button to interact with them, or use View -> Show Forms." ) );
+    m_formsMessage->setMessageType( KMessageWidget::Information );
+    m_formsMessage->setVisible( true );
+}
+
 void Part::slotShowPresentation()
 {
     if ( !m_presentationWidget )
@@ -20,6 +20,7 @@
 #include "core/document.h"
 #include "core/observer.h"
 #include "core/page.h"
+#include "core/page_p.h"
 #include "ui/guiutils.h"
 
 struct AnnItem
@@ -240,6 +241,10 @@ void AnnotationModelPrivate::rebuildTree( const QVector< Okular::Page * > &pages
     emit q->layoutAboutToBeChanged();
     for ( int i = 0; i < pages.count(); ++i )
     {
+        // the annotations of the page are added as they are loaded
+        if ( Okular::PagePrivate::get( pages.at( i ) )->m_dataPending )
+            continue;
+
         const QLinkedList< Okular::Annotation* > annots = filterOutWidgetAnnotations( pages.at( i )->annotations() );
         if ( annots.isEmpty() )
             continue;
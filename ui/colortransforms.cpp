@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#include "colortransforms.h"
+
+#include <QColor>
+#include <QImage>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// maps the gray level of each pixel through the 256 entries of table,
+// keeping the bits of the pixel in alphaMask
+static void mapGrayLevels( QImage *image, const QRgb *table, QRgb alphaMask )
+{
+    if ( image->format() != QImage::Format_ARGB32_Premultiplied )
+        *image = image->convertToFormat( QImage::Format_ARGB32_Premultiplied );
+
+    const int width = image->width();
+    const int height = image->height();
+#ifdef __SSE2__
+    // qGray() is ( 11 * red + 16 * green + 5 * blue ) / 32, the channels
+    // being stored as blue, green, red and alpha bytes
+    const __m128i weights = _mm_setr_epi16( 5, 16, 11, 0, 5, 16, 11, 0 );
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi32( alphaMask );
+#endif
+
+    for ( int y = 0; y < height; ++y )
+    {
+        QRgb *pixels = reinterpret_cast< QRgb * >( image->scanLine( y ) );
+        int x = 0;
+#ifdef __SSE2__
+        for ( ; x + 4 <= width; x += 4 )
+        {
+            const __m128i p = _mm_loadu_si128( reinterpret_cast< const __m128i * >( pixels + x ) );
+            // blue and green, red and alpha of two pixels in each
+            const __m128 lo = _mm_castsi128_ps( _mm_madd_epi16( _mm_unpacklo_epi8( p, zero ), weights ) );
+            const __m128 hi = _mm_castsi128_ps( _mm_madd_epi16( _mm_unpackhi_epi8( p, zero ), weights ) );
+            const __m128i blueGreen = _mm_castps_si128( _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+            const __m128i redAlpha = _mm_castps_si128( _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+            int grays[ 4 ];
+            _mm_storeu_si128( reinterpret_cast< __m128i * >( grays ), _mm_srli_epi32( _mm_add_epi32( blueGreen, redAlpha ), 5 ) );
+
+            const __m128i mapped = _mm_setr_epi32( table[ grays[ 0 ] ], table[ grays[ 1 ] ], table[ grays[ 2 ] ], table[ grays[ 3 ] ] );
+            _mm_storeu_si128( reinterpret_cast< __m128i * >( pixels + x ), _mm_or_si128( _mm_and_si128( p, mask ), mapped ) );
+        }
+#endif
+        for ( ; x < width; ++x )
+            pixels[ x ] = ( pixels[ x ] & alphaMask ) | table[ qGray( pixels[ x ] ) ];
+    }
+}
+
+void ColorTransforms::recolor( QImage *image, const QColor &foreground, const QColor &background )
+{
+    const float scaleRed = background.redF() - foreground.redF();
+    const float scaleGreen = background.greenF() - foreground.greenF();
+    const float scaleBlue = background.blueF() - foreground.blueF();
+
+    QRgb table[ 256 ];
+    for ( int lightness = 0; lightness < 256; ++lightness )
+    {
+        table[ lightness ] = qRgba( scaleRed * lightness + foreground.red(),
+                                    scaleGreen * lightness + foreground.green(),
+                                    scaleBlue * lightness + foreground.blue(),
+                                    0 );
+    }
+
+    mapGrayLevels( image, table, 0xff000000 );
+}
+
+void ColorTransforms::blackWhite( QImage *image, int contrast, int threshold )
+{
+    QRgb table[ 256 ];
+    for ( int gray = 0; gray < 256; ++gray )
+    {
+        int val = gray;
+        if ( val > threshold )
+            val = 128 + ( 127 * ( val - threshold ) ) / ( 255 - threshold );
+        else if ( val < threshold )
+            val = ( 128 * val ) / threshold;
+        if ( contrast > 2 )
+        {
+            val = contrast * ( val - threshold ) / 2 + threshold;
+            if ( val > 255 )
+                val = 255;
+            else if ( val < 0 )
+                val = 0;
+        }
+        table[ gray ] = qRgba( val, val, val, 255 );
+    }
+
+    mapGrayLevels( image, table, 0 );
+}
@@ -0,0 +1,40 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the Okular developers                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+
+#ifndef OKULAR_COLORTRANSFORMS_H
+#define OKULAR_COLORTRANSFORMS_H
+
+class QColor;
+class QImage;
+
+/**
+ * The color transforms of the accessibility render modes, applied to
+ * QImage::Format_ARGB32_Premultiplied images in place.
+ *
+ * Both map the gray level of each pixel through a table built once per
+ * image, the gray levels being computed four pixels at a time with SSE2
+ * where available.
+ */
+namespace ColorTransforms
+{
+    /**
+     * Maps the gray level of each pixel linearly from @p foreground (black)
+     * to @p background (white), keeping its alpha.
+     */
+    void recolor( QImage *image, const QColor &foreground, const QColor &background );
+
+    /**
+     * Turns the image to opaque gray levels, with the gray levels above
+     * @p threshold made lighter and the others darker, and their distance
+     * to the threshold multiplied by half the @p contrast when it is above 2.
+     */
+    void blackWhite( QImage *image, int contrast, int threshold );
+}
+
+#endif
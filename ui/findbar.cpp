@@ -69,6 +69,12 @@ FindBar::FindBar( Okular::Document * document, QWidget * parent )
     m_caseSensitiveAct->setCheckable( true );
     m_fromCurrentPageAct = optionsMenu->addAction( i18n( "From current page" ) );
     m_fromCurrentPageAct->setCheckable( true );
+    m_wholeWordsAct = optionsMenu->addAction( i18n( "Whole words only" ) );
+    m_wholeWordsAct->setCheckable( true );
+    m_ignoreAccentsAct = optionsMenu->addAction( i18n( "Ignore accents" ) );
+    m_ignoreAccentsAct->setCheckable( true );
+    m_regularExpressionAct = optionsMenu->addAction( i18n( "Regular expression" ) );
+    m_regularExpressionAct->setCheckable( true );
     m_findAsYouTypeAct = optionsMenu->addAction( i18n( "Find as you type" ) );
     m_findAsYouTypeAct->setCheckable( true );
     optionsBtn->setMenu( optionsMenu );
@@ -79,10 +85,16 @@ FindBar::FindBar( Okular::Document * document, QWidget * parent )
     connect( findPrevBtn, &QAbstractButton::clicked, this, &FindBar::findPrev );
     connect( m_caseSensitiveAct, &QAction::toggled, this, &FindBar::caseSensitivityChanged );
     connect( m_fromCurrentPageAct, &QAction::toggled, this, &FindBar::fromCurrentPageChanged );
+    connect( m_wholeWordsAct, &QAction::toggled, this, &FindBar::searchOptionsChanged );
+    connect( m_ignoreAccentsAct, &QAction::toggled, this, &FindBar::searchOptionsChanged );
+    connect( m_regularExpressionAct, &QAction::toggled, this, &FindBar::searchOptionsChanged );
     connect( m_findAsYouTypeAct, &QAction::toggled, this, &FindBar::findAsYouTypeChanged );
 
     m_caseSensitiveAct->setChecked( Okular::Settings::searchCaseSensitive() );
     m_fromCurrentPageAct->setChecked( Okular::Settings::searchFromCurrentPage() );
+    m_wholeWordsAct->setChecked( Okular::Settings::searchWholeWords() );
+    m_ignoreAccentsAct->setChecked( Okular::Settings::searchIgnoreAccents() );
+    m_regularExpressionAct->setChecked( Okular::Settings::searchRegularExpression() );
     m_findAsYouTypeAct->setChecked( Okular::Settings::findAsYouType() );
 
     hide();
@@ -178,6 +190,25 @@ void FindBar::fromCurrentPageChanged()
     Okular::Settings::self()->save();
 }
 
+void FindBar::searchOptionsChanged()
+{
+    Okular::SearchOptions options = Okular::NoSearchOption;
+    if ( m_wholeWordsAct->isChecked() )
+        options |= Okular::WholeWordsSearchOption;
+    if ( m_ignoreAccentsAct->isChecked() )
+        options |= Okular::IgnoreAccentsSearchOption;
+    if ( m_regularExpressionAct->isChecked() )
+        options |= Okular::RegularExpressionSearchOption;
+    m_search->lineEdit()->setSearchOptions( options );
+    if ( !m_active )
+        return;
+    Okular::Settings::setSearchWholeWords( m_wholeWordsAct->isChecked() );
+    Okular::Settings::setSearchIgnoreAccents( m_ignoreAccentsAct->isChecked() );
+    Okular::Settings::setSearchRegularExpression( m_regularExpressionAct->isChecked() );
+    Okular::Settings::self()->save();
+    m_search->lineEdit()->restartSearch();
+}
+
 void FindBar::findAsYouTypeChanged()
 {
     m_search->lineEdit()->setFindAsYouType( m_findAsYouTypeAct->isChecked() );
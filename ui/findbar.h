@@ -46,6 +46,7 @@ class FindBar
     private Q_SLOTS:
         void caseSensitivityChanged();
         void fromCurrentPageChanged();
+        void searchOptionsChanged();
         void findAsYouTypeChanged();
         void closeAndStopSearch();
 
@@ -53,6 +54,9 @@ class FindBar
         SearchLineWidget * m_search;
         QAction * m_caseSensitiveAct;
         QAction * m_fromCurrentPageAct;
+        QAction * m_wholeWordsAct;
+        QAction * m_ignoreAccentsAct;
+        QAction * m_regularExpressionAct;
         QAction * m_findAsYouTypeAct;
         bool eventFilter( QObject *target, QEvent *event ) override;
         bool m_active;
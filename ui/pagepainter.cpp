@@ -10,6 +10,7 @@
 #include "pagepainter.h"
 
 // qt / kde includes
+#include <qcache.h>
 #include <qrect.h>
 #include <qpainter.h>
 #include <qpalette.h>
@@ -24,6 +25,7 @@
 #include <math.h>
 
 // local includes
+#include "colortransforms.h"
 #include "core/area.h"
 #include "core/page.h"
 #include "core/page_p.h"
@@ -40,6 +42,233 @@ Q_GLOBAL_STATIC_WITH_ARGS( QPixmap, busyPixmap, ( KIconLoader::global()->loadIco
 
 #define TEXTANNOTATION_ICONSIZE 24
 
+// the page pixmaps scaled to the size they are painted at, in KiB, for the
+// Normal memory level
+#define SCALEDPIXMAPCACHE_SIZE ( 48 * 1024 )
+// the page pixmaps with the colors of the accessibility render mode, in KiB,
+// for the Normal memory level
+#define ACCESSIBLEPIXMAPCACHE_SIZE ( 32 * 1024 )
+
+namespace {
+
+/**
+ * The pixmap of a page for an observer, scaled to the size it is painted at,
+ * so that painting a strip of the page while scrolling does not scale the
+ * whole pixmap again. The pixmap is scaled the second time the page is
+ * painted at the same size: until then, or while zooming, only the painted
+ * part is scaled.
+ */
+struct ScaledPixmap
+{
+    // the QPixmap::cacheKey() of the pixmap of the page, which changes as
+    // soon as the generator delivers a new one
+    qint64 sourceKey;
+    QSize size;
+    QPixmap pixmap;
+};
+
+typedef QPair< const Okular::Page *, const Okular::DocumentObserver * > ScaledPixmapKey;
+typedef QCache< ScaledPixmapKey, ScaledPixmap > ScaledPixmapCache;
+
+/**
+ * The settings an accessibility render mode transforms the colors with.
+ */
+struct RenderModeSettings
+{
+    RenderModeSettings()
+        : renderMode( Okular::SettingsCore::renderMode() ),
+          foreground( Okular::Settings::recolorForeground().rgba() ),
+          background( Okular::Settings::recolorBackground().rgba() ),
+          contrast( Okular::Settings::bWContrast() ),
+          threshold( Okular::Settings::bWThreshold() )
+    {
+    }
+
+    bool operator==( const RenderModeSettings &other ) const
+    {
+        return renderMode == other.renderMode && foreground == other.foreground && background == other.background
+            && contrast == other.contrast && threshold == other.threshold;
+    }
+
+    int renderMode;
+    QRgb foreground;
+    QRgb background;
+    int contrast;
+    int threshold;
+};
+
+/**
+ * The pixmap of a page for an observer with the colors of the accessibility
+ * render mode, so that they are transformed once per pixmap rendered rather
+ * than on each paint.
+ */
+struct AccessiblePixmap
+{
+    qint64 sourceKey;
+    RenderModeSettings settings;
+    QPixmap pixmap;
+};
+
+typedef QCache< ScaledPixmapKey, AccessiblePixmap > AccessiblePixmapCache;
+
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS( ScaledPixmapCache, scaledPixmaps, ( SCALEDPIXMAPCACHE_SIZE ) )
+Q_GLOBAL_STATIC_WITH_ARGS( AccessiblePixmapCache, accessiblePixmaps, ( ACCESSIBLEPIXMAPCACHE_SIZE ) )
+
+// returns the size of a cache of painted pixmaps for the memory level, in
+// KiB, from its size for the Normal level
+static int paintedPixmapCacheSize( int normalSize )
+{
+    switch ( Okular::SettingsCore::memoryLevel() )
+    {
+        case Okular::SettingsCore::EnumMemoryLevel::Low:
+            return 0;
+        case Okular::SettingsCore::EnumMemoryLevel::Aggressive:
+            return normalSize * 2;
+        case Okular::SettingsCore::EnumMemoryLevel::Greedy:
+            return normalSize * 4;
+        default:
+            return normalSize;
+    }
+}
+
+static ScaledPixmapCache *scaledPixmapCache()
+{
+    ScaledPixmapCache *cache = scaledPixmaps();
+    const int size = paintedPixmapCacheSize( SCALEDPIXMAPCACHE_SIZE );
+    if ( cache->maxCost() != size )
+        cache->setMaxCost( size );
+    return cache;
+}
+
+static AccessiblePixmapCache *accessiblePixmapCache()
+{
+    AccessiblePixmapCache *cache = accessiblePixmaps();
+    const int size = paintedPixmapCacheSize( ACCESSIBLEPIXMAPCACHE_SIZE );
+    if ( cache->maxCost() != size )
+        cache->setMaxCost( size );
+    return cache;
+}
+
+// transforms the colors of image following the accessibility render mode
+static void applyRenderMode( QImage *image )
+{
+    switch ( Okular::SettingsCore::renderMode() )
+    {
+        case Okular::SettingsCore::EnumRenderMode::Inverted:
+            // Invert image pixels using QImage internal function
+            image->invertPixels(QImage::InvertRgb);
+            break;
+        case Okular::SettingsCore::EnumRenderMode::Recolor:
+            ColorTransforms::recolor( image, Okular::Settings::recolorForeground(), Okular::Settings::recolorBackground() );
+            break;
+        case Okular::SettingsCore::EnumRenderMode::BlackWhite:
+            // Manual Gray and Contrast
+            ColorTransforms::blackWhite( image, Okular::Settings::bWContrast(), 255 - Okular::Settings::bWThreshold() );
+            break;
+        default: ;
+    }
+}
+
+// returns pixmap, the one of page for observer, with the colors of the
+// accessibility render mode, or a null pixmap if it is too big to be kept
+static QPixmap accessiblePixmap( const Okular::Page *page, const Okular::DocumentObserver *observer, const QPixmap &pixmap )
+{
+    AccessiblePixmapCache *cache = accessiblePixmapCache();
+    const ScaledPixmapKey key( page, observer );
+    const RenderModeSettings settings;
+    AccessiblePixmap *accessible = cache->object( key );
+    if ( accessible && accessible->sourceKey == pixmap.cacheKey() && accessible->settings == settings )
+        return accessible->pixmap;
+
+    const int cost = (qint64)pixmap.width() * pixmap.height() * 4 / 1024;
+    if ( cost > cache->maxCost() / 2 )
+        return QPixmap();
+
+    QImage image = pixmap.toImage().convertToFormat( QImage::Format_ARGB32_Premultiplied );
+    applyRenderMode( &image );
+
+    accessible = new AccessiblePixmap;
+    accessible->sourceKey = pixmap.cacheKey();
+    accessible->settings = settings;
+    accessible->pixmap = QPixmap::fromImage( image );
+    const QPixmap result = accessible->pixmap;
+    cache->insert( key, accessible, cost );
+    return result;
+}
+
+// draws the part @p dLimitsInPixmap of @p pixmap scaled to @p dScaledSize
+// at @p topLeft, all in device pixels but @p topLeft
+static void drawScaledPixmap( QPainter *painter, const QPointF &topLeft, const Okular::Page *page,
+    const Okular::DocumentObserver *observer, const QPixmap &pixmap, const QSize &dScaledSize,
+    const QRect &dLimitsInPixmap, qreal dpr )
+{
+    const QRect dPart = dLimitsInPixmap & QRect( QPoint( 0, 0 ), dScaledSize );
+    if ( dPart.isEmpty() )
+        return;
+    const QRectF target( topLeft + QPointF( dPart.topLeft() - dLimitsInPixmap.topLeft() ) / dpr, QSizeF( dPart.size() ) / dpr );
+
+    if ( pixmap.size() == dScaledSize )
+    {
+        painter->drawPixmap( target, pixmap, dPart );
+        return;
+    }
+
+    ScaledPixmapCache *cache = scaledPixmapCache();
+    const ScaledPixmapKey key( page, observer );
+    ScaledPixmap *scaled = cache->object( key );
+    if ( scaled && scaled->sourceKey == pixmap.cacheKey() && scaled->size == dScaledSize )
+    {
+        if ( !scaled->pixmap.isNull() )
+        {
+            painter->drawPixmap( target, scaled->pixmap, dPart );
+            return;
+        }
+
+        // painted at this size again, likely scrolling: scale it all once,
+        // unless it would not fit in the cache anyway
+        const int cost = (qint64)dScaledSize.width() * dScaledSize.height() * pixmap.depth() / 8 / 1024;
+        if ( cost <= cache->maxCost() / 2 )
+        {
+            ScaledPixmap *full = new ScaledPixmap;
+            full->sourceKey = scaled->sourceKey;
+            full->size = dScaledSize;
+            full->pixmap = pixmap.scaled( dScaledSize );
+            painter->drawPixmap( target, full->pixmap, dPart );
+            cache->insert( key, full, cost );
+            return;
+        }
+    }
+    else if ( cache->maxCost() > 0 )
+    {
+        scaled = new ScaledPixmap;
+        scaled->sourceKey = pixmap.cacheKey();
+        scaled->size = dScaledSize;
+        cache->insert( key, scaled, 0 );
+    }
+
+    // scale only the part of the pixmap that is painted
+    const double xScale = pixmap.width() / (double)dScaledSize.width();
+    const double yScale = pixmap.height() / (double)dScaledSize.height();
+    const QRectF source( dPart.x() * xScale, dPart.y() * yScale, dPart.width() * xScale, dPart.height() * yScale );
+    painter->drawPixmap( target, pixmap, source );
+}
+
+void PagePainter::releasePixmaps( const Okular::DocumentObserver *observer, const Okular::Page *page )
+{
+    foreach ( const ScaledPixmapKey &key, scaledPixmaps()->keys() )
+    {
+        if ( key.second == observer && ( !page || key.first == page ) )
+            scaledPixmaps()->remove( key );
+    }
+    foreach ( const ScaledPixmapKey &key, accessiblePixmaps()->keys() )
+    {
+        if ( key.second == observer && ( !page || key.first == page ) )
+            accessiblePixmaps()->remove( key );
+    }
+}
+
 inline QPen buildPen( const Okular::Annotation *ann, double width, const QColor &color )
 {
     QPen p(
@@ -108,10 +337,9 @@ void PagePainter::paintCroppedPageOnPainter( QPainter * destPainter, const Okula
         /** 1 - RETRIEVE THE 'PAGE+ID' PIXMAP OR A SIMILAR 'PAGE' ONE **/
         const QPixmap *p = page->_o_nearestPixmap( observer, dScaledWidth, dScaledHeight );
 
-        if (p != NULL) {
+        // not detached from the one of the page, see drawScaledPixmap()
+        if (p != NULL)
             pixmap = *p;
-            pixmap.setDevicePixelRatio( qApp->devicePixelRatio() );
-        }
 
         /** 1B - IF NO PIXMAP, DRAW EMPTY PAGE **/
         double pixmapRescaleRatio = !pixmap.isNull() ? dScaledWidth / (double)pixmap.width() : -1;
@@ -254,6 +482,16 @@ void PagePainter::paintCroppedPageOnPainter( QPainter * destPainter, const Okula
 
     /** 3 - ENABLE BACKBUFFERING IF DIRECT IMAGE MANIPULATION IS NEEDED **/
     bool bufferAccessibility = (flags & Accessibility) && Okular::SettingsCore::changeColors() && (Okular::SettingsCore::renderMode() != Okular::SettingsCore::EnumRenderMode::Paper);
+    // the colors of the page pixmap are transformed once for all the paints
+    if ( bufferAccessibility && !hasTilesManager )
+    {
+        const QPixmap transformed = accessiblePixmap( page, observer, pixmap );
+        if ( !transformed.isNull() )
+        {
+            pixmap = transformed;
+            bufferAccessibility = false;
+        }
+    }
     bool useBackBuffer = bufferAccessibility || bufferedHighlights || bufferedAnnotations || viewPortPoint;
     QPixmap * backPixmap = nullptr;
     QPainter * mixedPainter = nullptr;
@@ -295,9 +533,7 @@ void PagePainter::paintCroppedPageOnPainter( QPainter * destPainter, const Okula
         }
         else
         {
-            QPixmap scaledCroppedPixmap = pixmap.scaled(dScaledWidth, dScaledHeight).copy(dLimitsInPixmap);
-            scaledCroppedPixmap.setDevicePixelRatio(dpr);
-            destPainter->drawPixmap( limits.topLeft(), scaledCroppedPixmap, QRectF(0, 0, dLimits.width(),dLimits.height()));
+            drawScaledPixmap( destPainter, limits.topLeft(), page, observer, pixmap, QSize( dScaledWidth, dScaledHeight ), dLimitsInPixmap, dpr );
         }
 
         // 4A.2. active painter is the one passed to this method
@@ -350,50 +586,14 @@ void PagePainter::paintCroppedPageOnPainter( QPainter * destPainter, const Okula
         else
         {
             // 4B.1. draw the page pixmap: normal or scaled
-            QPixmap scaledCroppedPixmap = pixmap.scaled(dScaledWidth, dScaledHeight).copy(dLimitsInPixmap);
-            scaledCroppedPixmap.setDevicePixelRatio(dpr);
-            p.drawPixmap( 0, 0, scaledCroppedPixmap );
+            drawScaledPixmap( &p, QPointF( 0, 0 ), page, observer, pixmap, QSize( dScaledWidth, dScaledHeight ), dLimitsInPixmap, dpr );
         }
 
         p.end();
 
         // 4B.2. modify pixmap following accessibility settings
         if ( bufferAccessibility )
-        {
-            switch ( Okular::SettingsCore::renderMode() )
-            {
-                case Okular::SettingsCore::EnumRenderMode::Inverted:
-                    // Invert image pixels using QImage internal function
-                    backImage.invertPixels(QImage::InvertRgb);
-                    break;
-                case Okular::SettingsCore::EnumRenderMode::Recolor:
-                    recolor(&backImage, Okular::Settings::recolorForeground(), Okular::Settings::recolorBackground());
-                    break;
-                case Okular::SettingsCore::EnumRenderMode::BlackWhite:
-                    // Manual Gray and Contrast
-                    unsigned int * data = (unsigned int *)backImage.bits();
-                    int val, pixels = backImage.width() * backImage.height(),
-                        con = Okular::Settings::bWContrast(), thr = 255 - Okular::Settings::bWThreshold();
-                    for( int i = 0; i < pixels; ++i )
-                    {
-                        val = qGray( data[i] );
-                        if ( val > thr )
-                            val = 128 + (127 * (val - thr)) / (255 - thr);
-                        else if ( val < thr )
-                            val = (128 * val) / thr;
-                        if ( con > 2 )
-                        {
-                            val = con * ( val - thr ) / 2 + thr;
-                            if ( val > 255 )
-                                val = 255;
-                            else if ( val < 0 )
-                                val = 0;
-                        }
-                        data[i] = qRgba( val, val, val, 255 );
-                    }
-                    break;
-            }
-        }
+            applyRenderMode( &backImage );
 
         // 4B.3. highlight rects in page
         if ( bufferedHighlights )
@@ -875,32 +1075,6 @@ void PagePainter::cropPixmapOnImage( QImage & dest, const QPixmap * src, const Q
     }
 }
 
-void PagePainter::recolor(QImage *image, const QColor &foreground, const QColor &background)
-{
-    if (image->format() != QImage::Format_ARGB32_Premultiplied) {
-        qCWarning(OkularUiDebug) << "Wrong image format! Converting...";
-        *image = image->convertToFormat(QImage::Format_ARGB32_Premultiplied);
-    }
-
-    Q_ASSERT(image->format() == QImage::Format_ARGB32_Premultiplied);
-
-    const float scaleRed = background.redF() - foreground.redF();
-    const float scaleGreen = background.greenF() - foreground.greenF();
-    const float scaleBlue = background.blueF() - foreground.blueF();
-
-    for (int y=0; y<image->height(); y++) {
-        QRgb *pixels = reinterpret_cast<QRgb*>(image->scanLine(y));
-
-        for (int x=0; x<image->width(); x++) {
-            const int lightness = qGray(pixels[x]);
-            pixels[x] = qRgba(scaleRed * lightness + foreground.red(),
-                           scaleGreen * lightness + foreground.green(),
-                           scaleBlue * lightness + foreground.blue(),
-                           qAlpha(pixels[x]));
-        }
-    }
-}
-
 /** Private Helpers :: Image Drawing **/
 // from Arthur - qt4
 static inline int qt_div_255(int x) { return (x + (x>>8) + 0x80) >> 8; }
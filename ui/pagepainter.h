@@ -52,9 +52,13 @@ class Q_DECL_EXPORT PagePainter
             int flags, int scaledWidth, int scaledHeight, const QRect & pageLimits,
             const Okular::NormalizedRect & crop, Okular::NormalizedPoint *viewPortPoint );
 
+        // forget the pixmaps of 'observer' kept as painted, scaled to the
+        // painted size or with the accessibility colors, to be called when
+        // they change; those of 'page' only if given
+        static void releasePixmaps( const Okular::DocumentObserver *observer, const Okular::Page *page = nullptr );
+
     private:
         static void cropPixmapOnImage( QImage & dest, const QPixmap * src, const QRect & r );
-        static void recolor(QImage *image, const QColor &foreground, const QColor &background);
 
         // set the alpha component of the image to a given value
         static void changeImageAlpha( QImage & image, unsigned int alpha );
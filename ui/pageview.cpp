@@ -81,6 +81,7 @@
 #include "core/document_p.h"
 #include "core/form.h"
 #include "core/page.h"
+#include "core/page_p.h"
 #include "core/misc.h"
 #include "core/generator.h"
 #include "core/movie.h"
@@ -133,6 +134,8 @@ public:
     Okular::Document * document;
     QVector< PageViewItem * > items;
     QLinkedList< PageViewItem * > visibleItems;
+    PageViewItemIndex itemIndex;
+    bool itemWidgetsDirty;
     MagnifierView *magnifierView;
 
     // view layout (columns and continuous in Settings), zoom and mouse
@@ -147,6 +150,8 @@ public:
     QColor mouseSelectionColor;
     bool mouseTextSelecting;
     QSet< int > pagesWithTextSelection;
+    // the pages whose form and video widgets wait for the page data
+    QSet< int > pagesWithoutWidgets;
     bool mouseOnRect;
     int mouseMode;
     MouseAnnotation * mouseAnnotation;
@@ -320,6 +325,7 @@ PageView::PageView( QWidget *parent, Okular::Document *document )
     d->autoScrollTimer = nullptr;
     d->annotator = nullptr;
     d->dirtyLayout = false;
+    d->itemWidgetsDirty = false;
     d->blockViewport = false;
     d->blockPixmapsRequest = false;
     d->messageWindow = new PageViewMessage(this);
@@ -461,6 +467,7 @@ PageView::~PageView()
         delete *dIt;
     delete d->formsWidgetController;
     d->document->removeObserver( this );
+    PagePainter::releasePixmaps( this );
     delete d;
 }
 
@@ -964,13 +971,17 @@ void PageView::notifySetup( const QVector< Okular::Page * > & pageSet, int setup
     // mouseAnnotation must not access our PageViewItem widgets any longer
     d->mouseAnnotation->reset();
 
+    PagePainter::releasePixmaps( this );
+
     // delete all widgets (one for each page in pageSet)
     QVector< PageViewItem * >::const_iterator dIt = d->items.constBegin(), dEnd = d->items.constEnd();
     for ( ; dIt != dEnd; ++dIt )
         delete *dIt;
     d->items.clear();
     d->visibleItems.clear();
+    d->itemIndex.clear();
     d->pagesWithTextSelection.clear();
+    d->pagesWithoutWidgets.clear();
     toggleFormWidgets( false );
     if ( d->formsWidgetController )
         d->formsWidgetController->dropRadioButtons();
@@ -986,53 +997,11 @@ void PageView::notifySetup( const QVector< Okular::Page * > & pageSet, int setup
 #ifdef PAGEVIEW_DEBUG
         qCDebug(OkularUiDebug).nospace() << "cropped geom for " << d->items.last()->pageNumber() << " is " << d->items.last()->croppedGeometry();
 #endif
-        const QLinkedList< Okular::FormField * > pageFields = (*setIt)->formFields();
-        QLinkedList< Okular::FormField * >::const_iterator ffIt = pageFields.constBegin(), ffEnd = pageFields.constEnd();
-        for ( ; ffIt != ffEnd; ++ffIt )
-        {
-            Okular::FormField * ff = *ffIt;
-            FormWidgetIface * w = FormWidgetFactory::createWidget( ff, viewport() );
-            if ( w )
-            {
-                w->setPageItem( item );
-                w->setFormWidgetsController( d->formWidgetsController() );
-                w->setVisibility( false );
-                w->setCanBeFilled( d->document->isAllowed( Okular::AllowFillForms ) );
-                item->formWidgets().insert( ff->id(), w );
-                hasformwidgets = true;
-            }
-        }
-        const QLinkedList< Okular::Annotation * > annotations = (*setIt)->annotations();
-        QLinkedList< Okular::Annotation * >::const_iterator aIt = annotations.constBegin(), aEnd = annotations.constEnd();
-        for ( ; aIt != aEnd; ++aIt )
-        {
-            Okular::Annotation * a = *aIt;
-            if ( a->subType() == Okular::Annotation::AMovie )
-            {
-                Okular::MovieAnnotation * movieAnn = static_cast< Okular::MovieAnnotation * >( a );
-                VideoWidget * vw = new VideoWidget( movieAnn, movieAnn->movie(), d->document, viewport() );
-                item->videoWidgets().insert( movieAnn->movie(), vw );
-                vw->pageInitialized();
-            }
-            else if ( a->subType() == Okular::Annotation::ARichMedia )
-            {
-                Okular::RichMediaAnnotation * richMediaAnn = static_cast< Okular::RichMediaAnnotation * >( a );
-                VideoWidget * vw = new VideoWidget( richMediaAnn, richMediaAnn->movie(), d->document, viewport() );
-                item->videoWidgets().insert( richMediaAnn->movie(), vw );
-                vw->pageInitialized();
-            }
-            else if ( a->subType() == Okular::Annotation::AScreen )
-            {
-                const Okular::ScreenAnnotation * screenAnn = static_cast< Okular::ScreenAnnotation * >( a );
-                Okular::Movie *movie = GuiUtils::renditionMovieFromScreenAnnotation( screenAnn );
-                if ( movie )
-                {
-                    VideoWidget * vw = new VideoWidget( screenAnn, movie, d->document, viewport() );
-                    item->videoWidgets().insert( movie, vw );
-                    vw->pageInitialized();
-                }
-            }
-        }
+        // the widgets of a page whose data is not loaded yet come with it
+        if ( Okular::PagePrivate::get( *setIt )->m_dataPending )
+            d->pagesWithoutWidgets.insert( item->pageNumber() );
+        else if ( createItemWidgets( item ) )
+            hasformwidgets = true;
     }
 
     // invalidate layout so relayout/repaint will happen on next viewport change
@@ -1042,7 +1011,12 @@ void PageView::notifySetup( const QVector< Okular::Page * > & pageSet, int setup
         // because we might end up in notifyViewportChanged while slotRelayoutPages
         // has not been done and we don't want that to happen
         d->dirtyLayout = true;
-        QMetaObject::invokeMethod(this, "slotRelayoutPages", Qt::QueuedConnection);
+        // a reloaded document keeps showing its pixmaps, lay them out right
+        // away so the viewport does not jump meanwhile
+        if ( setupFlags & Okular::DocumentObserver::DocumentReloaded )
+            slotRelayoutPages();
+        else
+            QMetaObject::invokeMethod(this, "slotRelayoutPages", Qt::QueuedConnection);
     }
     else
     {
@@ -1057,7 +1031,7 @@ void PageView::notifySetup( const QVector< Okular::Page * > & pageSet, int setup
     }
 
     // OSD to display pages
-    if ( documentChanged && pageSet.count() > 0 && Okular::Settings::showOSD() )
+    if ( documentChanged && !( setupFlags & Okular::DocumentObserver::DocumentReloaded ) && pageSet.count() > 0 && Okular::Settings::showOSD() )
         d->messageWindow->display(
             i18np(" Loaded a one-page document.",
                  " Loaded a %1-page document.",
@@ -1076,6 +1050,59 @@ void PageView::notifySetup( const QVector< Okular::Page * > & pageSet, int setup
     selectionClear();
 }
 
+bool PageView::createItemWidgets( PageViewItem * item )
+{
+    bool hasformwidgets = false;
+    const QLinkedList< Okular::FormField * > pageFields = item->page()->formFields();
+    QLinkedList< Okular::FormField * >::const_iterator ffIt = pageFields.constBegin(), ffEnd = pageFields.constEnd();
+    for ( ; ffIt != ffEnd; ++ffIt )
+    {
+        Okular::FormField * ff = *ffIt;
+        FormWidgetIface * w = FormWidgetFactory::createWidget( ff, viewport() );
+        if ( w )
+        {
+            w->setPageItem( item );
+            w->setFormWidgetsController( d->formWidgetsController() );
+            w->setVisibility( false );
+            w->setCanBeFilled( d->document->isAllowed( Okular::AllowFillForms ) );
+            item->formWidgets().insert( ff->id(), w );
+            hasformwidgets = true;
+        }
+    }
+    const QLinkedList< Okular::Annotation * > annotations = item->page()->annotations();
+    QLinkedList< Okular::Annotation * >::const_iterator aIt = annotations.constBegin(), aEnd = annotations.constEnd();
+    for ( ; aIt != aEnd; ++aIt )
+    {
+        Okular::Annotation * a = *aIt;
+        if ( a->subType() == Okular::Annotation::AMovie )
+        {
+            Okular::MovieAnnotation * movieAnn = static_cast< Okular::MovieAnnotation * >( a );
+            VideoWidget * vw = new VideoWidget( movieAnn, movieAnn->movie(), d->document, viewport() );
+            item->videoWidgets().insert( movieAnn->movie(), vw );
+            vw->pageInitialized();
+        }
+        else if ( a->subType() == Okular::Annotation::ARichMedia )
+        {
+            Okular::RichMediaAnnotation * richMediaAnn = static_cast< Okular::RichMediaAnnotation * >( a );
+            VideoWidget * vw = new VideoWidget( richMediaAnn, richMediaAnn->movie(), d->document, viewport() );
+            item->videoWidgets().insert( richMediaAnn->movie(), vw );
+            vw->pageInitialized();
+        }
+        else if ( a->subType() == Okular::Annotation::AScreen )
+        {
+            const Okular::ScreenAnnotation * screenAnn = static_cast< Okular::ScreenAnnotation * >( a );
+            Okular::Movie *movie = GuiUtils::renditionMovieFromScreenAnnotation( screenAnn );
+            if ( movie )
+            {
+                VideoWidget * vw = new VideoWidget( screenAnn, movie, d->document, viewport() );
+                item->videoWidgets().insert( movie, vw );
+                vw->pageInitialized();
+            }
+        }
+    }
+    return hasformwidgets;
+}
+
 void PageView::updateActionState( bool haspages, bool documentChanged, bool hasformwidgets )
 {
     if ( d->aPageSizes )
@@ -1308,8 +1335,27 @@ void PageView::notifyPageChanged( int pageNumber, int changedFlags )
     if ( changedFlags & DocumentObserver::Bookmark )
         return;
 
+    if ( changedFlags & DocumentObserver::Pixmap )
+        PagePainter::releasePixmaps( this, d->document->page( pageNumber ) );
+
     if ( changedFlags & DocumentObserver::Annotations )
     {
+        // the data of the page may just have been loaded
+        if ( d->pagesWithoutWidgets.remove( pageNumber ) && pageNumber < d->items.count() )
+        {
+            PageViewItem * item = d->items[ pageNumber ];
+            if ( createItemWidgets( item ) && d->aToggleForms && !d->aToggleForms->isEnabled() )
+            {
+                d->aToggleForms->setEnabled( true );
+                emit formWidgetsAvailable();
+            }
+            // size and place the new widgets as a relayout would
+            item->setWHZC( item->croppedWidth(), item->croppedHeight(), item->zoomFactor(), item->crop() );
+            item->setFormWidgetsVisible( d->m_formsVisible );
+            if ( d->visibleItems.contains( item ) )
+                slotRequestVisiblePixmaps();
+        }
+
         const QLinkedList< Okular::Annotation * > annots = d->document->page( pageNumber )->annotations();
         const QLinkedList< Okular::Annotation * >::ConstIterator annItEnd = annots.end();
         QHash< Okular::Annotation*, AnnotWindow * >::Iterator it = d->m_annowindows.begin();
@@ -1379,7 +1425,10 @@ void PageView::notifyContentsCleared( int changedFlags )
 {
     // if pixmaps were cleared, re-ask them
     if ( changedFlags & DocumentObserver::Pixmap )
+    {
+        PagePainter::releasePixmaps( this );
         QMetaObject::invokeMethod(this, "slotRequestVisiblePixmaps", Qt::QueuedConnection);
+    }
 }
 
 void PageView::notifyZoom( int factor )
@@ -3656,7 +3705,8 @@ void PageView::updateItemSize( PageViewItem * item, int colWidth, int rowHeight
 PageViewItem * PageView::pickItemOnPoint( int x, int y )
 {
     PageViewItem * item = nullptr;
-    QLinkedList< PageViewItem * >::const_iterator iIt = d->visibleItems.constBegin(), iEnd = d->visibleItems.constEnd();
+    const QVector< PageViewItem * > items = d->itemIndex.itemsIn( QRect( x, y, 1, 1 ) );
+    QVector< PageViewItem * >::const_iterator iIt = items.constBegin(), iEnd = items.constEnd();
     for ( ; iIt != iEnd; ++iIt )
     {
         PageViewItem * i = *iIt;
@@ -4530,8 +4580,10 @@ void PageView::slotRelayoutPages()
         delete [] colWidth;
         delete [] rowHeight;
 
-    // 3) reset dirty state
+    // 3) reset dirty state, index the new geometries
     d->dirtyLayout = false;
+    d->itemIndex.rebuild( d->items );
+    d->itemWidgetsDirty = true;
 
     // 4) update scrollview's contents size and recenter view
     bool wasUpdatesEnabled = viewport()->updatesEnabled();
@@ -4579,6 +4631,29 @@ void PageView::delayedResizeEvent()
     slotRequestVisiblePixmaps();
 }
 
+static void moveItemWidgets( PageViewItem * i, const QRect &viewportRect, const QRect &viewportRectAtZeroZero )
+{
+    foreach( FormWidgetIface *fwi, i->formWidgets() )
+    {
+        Okular::NormalizedRect r = fwi->rect();
+        fwi->moveTo(
+            qRound( i->uncroppedGeometry().left() + i->uncroppedWidth() * r.left ) + 1 - viewportRect.left(),
+            qRound( i->uncroppedGeometry().top() + i->uncroppedHeight() * r.top ) + 1 - viewportRect.top() );
+    }
+    Q_FOREACH ( VideoWidget *vw, i->videoWidgets() )
+    {
+        const Okular::NormalizedRect r = vw->normGeometry();
+        vw->move(
+            qRound( i->uncroppedGeometry().left() + i->uncroppedWidth() * r.left ) + 1 - viewportRect.left(),
+            qRound( i->uncroppedGeometry().top() + i->uncroppedHeight() * r.top ) + 1 - viewportRect.top() );
+
+        if ( vw->isPlaying() && viewportRectAtZeroZero.intersected( vw->geometry() ).isEmpty() ) {
+            vw->stop();
+            vw->pageLeft();
+        }
+    }
+}
+
 static void slotRequestPreloadPixmap( Okular::DocumentObserver * observer, const PageViewItem * i, const QRect &expandedViewportRect, QLinkedList< Okular::PixmapRequest * > *requestedPixmaps )
 {
     Okular::NormalizedRect preRenderRegion;
@@ -4632,34 +4707,35 @@ void PageView::slotRequestVisiblePixmaps( int newValue )
     // Margin (in pixels) around the viewport to preload
     const int pixelsToExpand = 512;
 
-    // iterate over all items
+    // only the items in the viewport matter, the index finds them without
+    // walking all of them
+    const QVector< PageViewItem * > viewportItems = d->itemIndex.itemsIn( viewportRect );
+
+    // move the widgets of the items in the viewport, and of the ones that
+    // just left it; the widgets of the other items are out of sight already.
+    // After a relayout the widgets of any item may be in sight
+    if ( d->itemWidgetsDirty )
+    {
+        foreach ( PageViewItem * i, d->items )
+            moveItemWidgets( i, viewportRect, viewportRectAtZeroZero );
+        d->itemWidgetsDirty = false;
+    }
+    else
+    {
+        foreach ( PageViewItem * i, d->visibleItems )
+            moveItemWidgets( i, viewportRect, viewportRectAtZeroZero );
+        foreach ( PageViewItem * i, viewportItems )
+            moveItemWidgets( i, viewportRect, viewportRectAtZeroZero );
+    }
+
+    // iterate over the items in the viewport
     d->visibleItems.clear();
     QLinkedList< Okular::PixmapRequest * > requestedPixmaps;
     QVector< Okular::VisiblePageRect * > visibleRects;
-    QVector< PageViewItem * >::const_iterator iIt = d->items.constBegin(), iEnd = d->items.constEnd();
+    QVector< PageViewItem * >::const_iterator iIt = viewportItems.constBegin(), iEnd = viewportItems.constEnd();
     for ( ; iIt != iEnd; ++iIt )
     {
         PageViewItem * i = *iIt;
-        foreach( FormWidgetIface *fwi, i->formWidgets() )
-        {
-            Okular::NormalizedRect r = fwi->rect();
-            fwi->moveTo(
-                qRound( i->uncroppedGeometry().left() + i->uncroppedWidth() * r.left ) + 1 - viewportRect.left(),
-                qRound( i->uncroppedGeometry().top() + i->uncroppedHeight() * r.top ) + 1 - viewportRect.top() );
-        }
-        Q_FOREACH ( VideoWidget *vw, i->videoWidgets() )
-        {
-            const Okular::NormalizedRect r = vw->normGeometry();
-            vw->move(
-                qRound( i->uncroppedGeometry().left() + i->uncroppedWidth() * r.left ) + 1 - viewportRect.left(),
-                qRound( i->uncroppedGeometry().top() + i->uncroppedHeight() * r.top ) + 1 - viewportRect.top() );
-
-            if ( vw->isPlaying() && viewportRectAtZeroZero.intersected( vw->geometry() ).isEmpty() ) {
-                vw->stop();
-                vw->pageLeft();
-            }
-        }
-
         if ( !i->isVisible() )
             continue;
 #ifdef PAGEVIEW_DEBUG
@@ -4698,7 +4774,7 @@ void PageView::slotRequestVisiblePixmaps( int newValue )
 #ifdef PAGEVIEW_DEBUG
             kWarning() << "rerequesting visible pixmaps for page" << i->pageNumber() << "!";
 #endif
-            Okular::PixmapRequest * p = new Okular::PixmapRequest( this, i->pageNumber(), i->uncroppedWidth(), i->uncroppedHeight(), PAGEVIEW_PRIO, Okular::PixmapRequest::Asynchronous );
+            Okular::PixmapRequest * p = new Okular::PixmapRequest( this, i->pageNumber(), i->uncroppedWidth(), i->uncroppedHeight(), PAGEVIEW_PRIO, Okular::PixmapRequest::Asynchronous | Okular::PixmapRequest::Progressive );
             requestedPixmaps.push_back( p );
 
             if ( i->page()->hasTilesManager( this ) )
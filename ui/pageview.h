@@ -127,6 +127,8 @@ Q_OBJECT
         void mouseForwardButtonClick();
         void escPressed();
         void fitWindowToPage( const QSize& pageViewPortSize, const QSize& pageSize );
+        // the first form widgets showed up after the document was set up
+        void formWidgetsAvailable();
 
     protected:
         bool event( QEvent * event ) override;
@@ -184,6 +186,9 @@ Q_OBJECT
         void scrollTo( int x, int y );
 
         void toggleFormWidgets( bool on );
+        // creates the form and video widgets of the page of @p item,
+        // returns whether there are form widgets
+        bool createItemWidgets( PageViewItem * item );
 
         void resizeContentArea( const QSize & newSize );
         void updatePageStep();
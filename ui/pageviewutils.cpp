@@ -29,6 +29,8 @@
 
 // system includes
 #include <math.h>
+#include <algorithm>
+#include <climits>
 
 // local includes
 #include "formwidgets.h"
@@ -217,6 +219,68 @@ void PageViewItem::reloadFormWidgetsState()
     }
 }
 
+/*********************/
+/** PageViewItemIndex */
+/*********************/
+
+static bool itemAbove( const PageViewItem *item1, const PageViewItem *item2 )
+{
+    if ( item1->croppedGeometry().top() != item2->croppedGeometry().top() )
+        return item1->croppedGeometry().top() < item2->croppedGeometry().top();
+    return item1->pageNumber() < item2->pageNumber();
+}
+
+static bool itemBefore( const PageViewItem *item1, const PageViewItem *item2 )
+{
+    return item1->pageNumber() < item2->pageNumber();
+}
+
+void PageViewItemIndex::rebuild( const QVector< PageViewItem * > &items )
+{
+    clear();
+    foreach ( PageViewItem *item, items )
+    {
+        if ( item->isVisible() )
+            m_items.append( item );
+    }
+    std::sort( m_items.begin(), m_items.end(), itemAbove );
+
+    m_maxBottom.reserve( m_items.count() );
+    int maxBottom = INT_MIN;
+    foreach ( const PageViewItem *item, m_items )
+    {
+        maxBottom = qMax( maxBottom, item->croppedGeometry().bottom() );
+        m_maxBottom.append( maxBottom );
+    }
+}
+
+void PageViewItemIndex::clear()
+{
+    m_items.clear();
+    m_maxBottom.clear();
+}
+
+QVector< PageViewItem * > PageViewItemIndex::itemsIn( const QRect &rect ) const
+{
+    QVector< PageViewItem * > result;
+    if ( rect.isEmpty() )
+        return result;
+
+    // the items before the first one reaching down to the area are all above it
+    int i = std::lower_bound( m_maxBottom.constBegin(), m_maxBottom.constEnd(), rect.top() ) - m_maxBottom.constBegin();
+    for ( ; i < m_items.count(); ++i )
+    {
+        PageViewItem *item = m_items.at( i );
+        if ( item->croppedGeometry().top() > rect.bottom() )
+            break;
+        if ( item->croppedGeometry().intersects( rect ) )
+            result.append( item );
+    }
+
+    std::sort( result.begin(), result.end(), itemBefore );
+    return result;
+}
+
 /*********************/
 /** PageViewMessage  */
 /*********************/
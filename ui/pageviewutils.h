@@ -15,6 +15,7 @@
 #include <qrect.h>
 #include <qhash.h>
 #include <qtoolbutton.h>
+#include <qvector.h>
 
 
 #include "core/area.h"
@@ -92,6 +93,30 @@ class PageViewItem
 };
 
 
+/**
+ * @short PageViewItemIndex finds the items in an area of the PageView.
+ *
+ * The visible items are kept sorted by their top edge, along with the
+ * running maximum of their bottom edges, so that the items intersecting an
+ * area are found with a binary search plus a walk over the rows it spans,
+ * whatever the number of pages. The index must be rebuilt after the items
+ * are moved.
+ */
+class PageViewItemIndex
+{
+    public:
+        void rebuild( const QVector< PageViewItem * > &items );
+        void clear();
+
+        /* Visible items whose cropped geometry intersects rect, in page order */
+        QVector< PageViewItem * > itemsIn( const QRect &rect ) const;
+
+    private:
+        QVector< PageViewItem * > m_items;
+        QVector< int > m_maxBottom;
+};
+
+
 /**
  * @short A widget that displays messages in the top-left corner.
  *
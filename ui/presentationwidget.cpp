@@ -73,6 +73,18 @@
 // comment this to disable the top-right progress indicator
 #define ENABLE_PROGRESS_OVERLAY
 
+// how long the previous slide stays while the current one renders, before
+// a placeholder is shown instead
+#define PLACEHOLDER_DELAY 150
+
+// the settings a slide is painted with, a slide composed ahead with others
+// is of no use any more
+static QVariantList slidePaintSettings()
+{
+    return QVariantList() << Okular::SettingsCore::changeColors() << Okular::SettingsCore::renderMode()
+        << Okular::SettingsCore::paperColor() << Okular::Settings::recolorForeground() << Okular::Settings::recolorBackground()
+        << Okular::Settings::bWContrast() << Okular::Settings::bWThreshold() << Okular::Settings::slidesBackgroundColor();
+}
 
 // a frame contains a pointer to the page object, its geometry and the
 // transition effect to the next frame
@@ -145,10 +157,10 @@ PresentationWidget::PresentationWidget( QWidget * parent, Okular::Document * doc
     m_screenInhibitCookie(0), m_sleepInhibitCookie(0),
     m_parentWidget( parent ),
     m_document( doc ), m_frameIndex( -1 ), m_topBar( nullptr ), m_pagesEdit( nullptr ), m_searchBar( nullptr ),
-    m_ac( collection ), m_screenSelect( nullptr ), m_isSetup( false ), m_blockNotifications( false ), m_inBlackScreenMode( false ),
+    m_ac( collection ), m_screenSelect( nullptr ), m_isSetup( false ), m_inBlackScreenMode( false ),
     m_showSummaryView( Okular::Settings::slidesShowSummary() ),
     m_advanceSlides( Okular::SettingsCore::slidesAdvance() ),
-    m_goToNextPageOnRelease( false )
+    m_goToNextPageOnRelease( false ), m_showingPlaceholder( false ), m_precomposedIndex( -1 )
 {
     Q_UNUSED( parent )
     setAttribute( Qt::WA_DeleteOnClose );
@@ -250,6 +262,13 @@ PresentationWidget::PresentationWidget( QWidget * parent, Okular::Document * doc
     m_nextPageTimer = new QTimer( this );
     m_nextPageTimer->setSingleShot( true );
     connect(m_nextPageTimer, &QTimer::timeout, this, &PresentationWidget::slotNextPage);
+    m_placeholderTimer = new QTimer( this );
+    m_placeholderTimer->setSingleShot( true );
+    m_placeholderTimer->setInterval( PLACEHOLDER_DELAY );
+    connect(m_placeholderTimer, &QTimer::timeout, this, &PresentationWidget::slotShowPlaceholder);
+    m_precomposeTimer = new QTimer( this );
+    m_precomposeTimer->setSingleShot( true );
+    connect(m_precomposeTimer, &QTimer::timeout, this, &PresentationWidget::slotPrecomposeNextPage);
 
     connect(m_document, &Okular::Document::processMovieAction, this, &PresentationWidget::slotProcessMovieAction);
     connect(m_document, &Okular::Document::processRenditionAction, this, &PresentationWidget::slotProcessRenditionAction);
@@ -294,6 +313,7 @@ PresentationWidget::~PresentationWidget()
 
     // remove this widget from document observer
     m_document->removeObserver( this );
+    PagePainter::releasePixmaps( this );
 
     foreach( QAction *action, m_topBar->actions() )
     {
@@ -324,6 +344,9 @@ void PresentationWidget::notifySetup( const QVector< Okular::Page * > & pageSet,
     if ( !m_frames.isEmpty() )
         qCWarning(OkularUiDebug) << "Frames setup changed while a Presentation is in progress.";
     m_frames.clear();
+    m_precomposedPixmap = QPixmap();
+    m_precomposedIndex = -1;
+    PagePainter::releasePixmaps( this );
 
     // create the new frames
     QVector< Okular::Page * >::const_iterator setIt = pageSet.begin(), setEnd = pageSet.end();
@@ -394,13 +417,36 @@ void PresentationWidget::notifyViewportChanged( bool /*smoothMove*/ )
 
 void PresentationWidget::notifyPageChanged( int pageNumber, int changedFlags )
 {
-    // if we are blocking the notifications, do nothing
-    if ( m_blockNotifications )
+    if ( !( changedFlags & ( DocumentObserver::Pixmap | DocumentObserver::Annotations | DocumentObserver::Highlights ) ) )
         return;
 
+    if ( changedFlags & DocumentObserver::Pixmap )
+        PagePainter::releasePixmaps( this, m_document->page( pageNumber ) );
+
     // check if it's the last requested pixmap. if so update the widget.
-    if ( (changedFlags & ( DocumentObserver::Pixmap | DocumentObserver::Annotations | DocumentObserver::Highlights ) ) && pageNumber == m_frameIndex )
-        generatePage( changedFlags & ( DocumentObserver::Annotations | DocumentObserver::Highlights ) );
+    if ( pageNumber == m_frameIndex )
+    {
+        m_placeholderTimer->stop();
+        if ( m_showingPlaceholder )
+        {
+            // the transition already went to the placeholder, just swap it
+            m_showingPlaceholder = false;
+            if ( m_transitionTimer->isActive() )
+                m_transitionTimer->stop();
+            generatePage( true );
+        }
+        else
+        {
+            generatePage( changedFlags & ( DocumentObserver::Annotations | DocumentObserver::Highlights ) );
+        }
+    }
+    else if ( pageNumber == m_frameIndex + 1 )
+    {
+        // compose the next slide again with what changed
+        m_precomposedPixmap = QPixmap();
+        m_precomposedIndex = -1;
+        m_precomposeTimer->start();
+    }
 }
 
 void PresentationWidget::notifyCurrentPageChanged( int previousPage, int currentPage )
@@ -439,22 +485,20 @@ void PresentationWidget::notifyCurrentPageChanged( int previousPage, int current
     if ( currentPage != -1 )
     {
         m_frameIndex = currentPage;
-
-        // check if pixmap exists or else request it
-        PresentationFrame * frame = m_frames[ m_frameIndex ];
-        int pixW = frame->geometry.width();
-        int pixH = frame->geometry.height();
+        m_placeholderTimer->stop();
+        m_showingPlaceholder = false;
 
         bool signalsBlocked = m_pagesEdit->signalsBlocked();
         m_pagesEdit->blockSignals( true );
         m_pagesEdit->setText( QString::number( m_frameIndex + 1 ) );
         m_pagesEdit->blockSignals( signalsBlocked );
 
-        // if pixmap not inside the Okular::Page we request it and wait for
-        // notifyPixmapChanged call or else we can proceed to pixmap generation
-        if ( !frame->page->hasPixmap( this, ceil(pixW * qApp->devicePixelRatio()), ceil(pixH * qApp->devicePixelRatio()) ) )
+        // if pixmap not inside the Okular::Page it is rendered in the
+        // background, and notifyPageChanged() shows it; the previous slide
+        // stays meanwhile, or a placeholder if it takes long
+        if ( !hasFramePixmap( m_frameIndex ) )
         {
-            requestPixmaps();
+            m_placeholderTimer->start();
         }
         else
         {
@@ -462,6 +506,9 @@ void PresentationWidget::notifyCurrentPageChanged( int previousPage, int current
             generatePage();
         }
 
+        // move the window of slides rendered ahead along
+        requestPixmaps();
+
         // perform the page opening action, if any
         if ( m_document->page( m_frameIndex )->pageAction( Okular::Page::Opening ) )
             m_document->processAction( m_document->page( m_frameIndex )->pageAction( Okular::Page::Opening ) );
@@ -488,16 +535,28 @@ void PresentationWidget::notifyCurrentPageChanged( int previousPage, int current
 
 bool PresentationWidget::canUnloadPixmap( int pageNumber ) const
 {
-    if ( Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Low ||
-         Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Normal )
+    if ( Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Low )
     {
         // can unload all pixmaps except for the currently visible one
         return pageNumber != m_frameIndex;
     }
     else
     {
-        // can unload all pixmaps except for the currently visible one, previous and next
-        return qAbs(pageNumber - m_frameIndex) <= 1;
+        // can unload all pixmaps except for the currently visible one, the
+        // previous one and the ones rendered ahead
+        return pageNumber < m_frameIndex - 1 || pageNumber > m_frameIndex + lookAheadPages();
+    }
+}
+
+void PresentationWidget::reparseConfig()
+{
+    // compose the slides again with the new colors
+    m_precomposedPixmap = QPixmap();
+    m_precomposedIndex = -1;
+    if ( m_frameIndex != -1 )
+    {
+        generatePage( true );
+        m_precomposeTimer->start();
     }
 }
 
@@ -1019,16 +1078,27 @@ void PresentationWidget::generatePage( bool disableTransition )
         m_previousPagePixmap = m_lastRenderedPixmap;
     }
 
-    // opens the painter over the pixmap
-    QPainter pixmapPainter;
-    pixmapPainter.begin( &m_lastRenderedPixmap );
-    // generate welcome page
-    if ( m_frameIndex == -1 )
-        generateIntroPage( pixmapPainter );
-    // generate a normal pixmap with extended margin filling
-    if ( m_frameIndex >= 0 && m_frameIndex < (int)m_document->pages() )
-        generateContentsPage( m_frameIndex, pixmapPainter );
-    pixmapPainter.end();
+    if ( m_frameIndex != -1 && m_frameIndex == m_precomposedIndex && m_precomposedPixmap.size() == m_lastRenderedPixmap.size()
+         && m_precomposedSettings == slidePaintSettings() )
+    {
+        // composed while the previous slide was shown
+        m_lastRenderedPixmap = m_precomposedPixmap;
+        m_precomposedPixmap = QPixmap();
+        m_precomposedIndex = -1;
+    }
+    else
+    {
+        // opens the painter over the pixmap
+        QPainter pixmapPainter;
+        pixmapPainter.begin( &m_lastRenderedPixmap );
+        // generate welcome page
+        if ( m_frameIndex == -1 )
+            generateIntroPage( pixmapPainter );
+        // generate a normal pixmap with extended margin filling
+        if ( m_frameIndex >= 0 && m_frameIndex < (int)m_document->pages() )
+            generateContentsPage( m_frameIndex, pixmapPainter );
+        pixmapPainter.end();
+    }
 
     // generate the top-right corner overlay
 #ifdef ENABLE_PROGRESS_OVERLAY
@@ -1060,6 +1130,10 @@ void PresentationWidget::generatePage( bool disableTransition )
         QPoint p = mapFromGlobal( QCursor::pos() );
         testCursorOnLink( p.x(), p.y() );
     }
+
+    // get the next slide ready once the transition is over
+    if ( !m_showingPlaceholder )
+        m_precomposeTimer->start();
 }
 
 void PresentationWidget::generateIntroPage( QPainter & p )
@@ -1402,62 +1476,62 @@ void PresentationWidget::repositionContent()
 
 }
 
-void PresentationWidget::requestPixmaps()
+bool PresentationWidget::hasFramePixmap( int pageNumber ) const
 {
-    PresentationFrame * frame = m_frames[ m_frameIndex ];
-    int pixW = frame->geometry.width();
-    int pixH = frame->geometry.height();
+    const PresentationFrame * frame = m_frames[ pageNumber ];
+    const qreal dpr = qApp->devicePixelRatio();
+    return frame->page->hasPixmap( this, ceil( frame->geometry.width() * dpr ), ceil( frame->geometry.height() * dpr ) );
+}
 
-    // operation will take long: set busy cursor
-    QApplication::setOverrideCursor( QCursor( Qt::BusyCursor ) );
-    // request the pixmap
-    QLinkedList< Okular::PixmapRequest * > requests;
-    requests.push_back( new Okular::PixmapRequest( this, m_frameIndex, pixW, pixH, PRESENTATION_PRIO, Okular::PixmapRequest::NoFeature ) );
-    // restore cursor
-    QApplication::restoreOverrideCursor();
-    // ask for next and previous page if not in low memory usage setting
-    if ( Okular::SettingsCore::memoryLevel() != Okular::SettingsCore::EnumMemoryLevel::Low )
-    {
-        int pagesToPreload = 1;
+int PresentationWidget::lookAheadPages() const
+{
+    // If greedy, preload everything
+    if ( Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Greedy )
+        return (int)m_document->pages();
+
+    // ask for the next pages if not in low memory usage setting
+    if ( Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Low )
+        return 0;
 
-        // If greedy, preload everything
-        if (Okular::SettingsCore::memoryLevel() == Okular::SettingsCore::EnumMemoryLevel::Greedy)
-            pagesToPreload = (int)m_document->pages();
+    return Okular::Settings::slidesLookAhead();
+}
 
-        Okular::PixmapRequest::PixmapRequestFeatures requestFeatures = Okular::PixmapRequest::Preload;
-        requestFeatures |= Okular::PixmapRequest::Asynchronous;
+void PresentationWidget::requestPixmaps()
+{
+    QLinkedList< Okular::PixmapRequest * > requests;
 
-        for( int j = 1; j <= pagesToPreload; j++ )
-        {
-            int tailRequest = m_frameIndex + j;
-            if ( tailRequest < (int)m_document->pages() )
-            {
-                PresentationFrame *nextFrame = m_frames[ tailRequest ];
-                pixW = nextFrame->geometry.width();
-                pixH = nextFrame->geometry.height();
-                if ( !nextFrame->page->hasPixmap( this, pixW, pixH ) )
-                    requests.push_back( new Okular::PixmapRequest( this, tailRequest, pixW, pixH, PRESENTATION_PRELOAD_PRIO, requestFeatures ) );
-            }
+    // the current slide is rendered in the background too, so that input
+    // is never blocked by it
+    PresentationFrame * frame = m_frames[ m_frameIndex ];
+    if ( !hasFramePixmap( m_frameIndex ) )
+        requests.push_back( new Okular::PixmapRequest( this, m_frameIndex, frame->geometry.width(), frame->geometry.height(), PRESENTATION_PRIO, Okular::PixmapRequest::Asynchronous ) );
 
-            int headRequest = m_frameIndex - j;
-            if ( headRequest >= 0 )
-            {
-                PresentationFrame *prevFrame = m_frames[ headRequest ];
-                pixW = prevFrame->geometry.width();
-                pixH = prevFrame->geometry.height();
-                if ( !prevFrame->page->hasPixmap( this, pixW, pixH ) )
-                    requests.push_back( new Okular::PixmapRequest( this, headRequest, pixW, pixH, PRESENTATION_PRELOAD_PRIO, requestFeatures ) );
-            }
+    // then the slides ahead, nearest first, and the previous one
+    const Okular::PixmapRequest::PixmapRequestFeatures requestFeatures = Okular::PixmapRequest::Preload | Okular::PixmapRequest::Asynchronous;
+    const int pagesToPreload = lookAheadPages();
+    for ( int j = 1; j <= pagesToPreload; j++ )
+    {
+        const int tailRequest = m_frameIndex + j;
+        if ( tailRequest >= (int)m_document->pages() )
+            break;
 
-            // stop if we've already reached both ends of the document
-            if ( headRequest < 0 && tailRequest >= (int)m_document->pages() )
-                break;
+        if ( !hasFramePixmap( tailRequest ) )
+        {
+            PresentationFrame *nextFrame = m_frames[ tailRequest ];
+            requests.push_back( new Okular::PixmapRequest( this, tailRequest, nextFrame->geometry.width(), nextFrame->geometry.height(), PRESENTATION_PRELOAD_PRIO + j - 1, requestFeatures ) );
         }
     }
+
+    const int headRequest = m_frameIndex - 1;
+    if ( Okular::SettingsCore::memoryLevel() != Okular::SettingsCore::EnumMemoryLevel::Low && headRequest >= 0 && !hasFramePixmap( headRequest ) )
+    {
+        PresentationFrame *prevFrame = m_frames[ headRequest ];
+        requests.push_back( new Okular::PixmapRequest( this, headRequest, prevFrame->geometry.width(), prevFrame->geometry.height(), PRESENTATION_PRELOAD_PRIO + 1, requestFeatures ) );
+    }
+
     m_document->requestPixmaps( requests );
 }
 
-
 void PresentationWidget::slotNextPage()
 {
     int nextIndex = m_frameIndex + 1;
@@ -1551,7 +1625,10 @@ void PresentationWidget::slotTransitionStep()
             pixmapPainter.drawPixmap( 0, 0, m_currentPagePixmap );
             update();
             if( m_currentPixmapOpacity >= 1 )
+            {
+                m_precomposeTimer->start();
                 return;
+            }
         } break;
         default:
         {
@@ -1560,6 +1637,7 @@ void PresentationWidget::slotTransitionStep()
                 // it's better to fix the transition to cover the whole screen than
                 // enabling the following line that wastes cpu for nothing
                 //update();
+                m_precomposeTimer->start();
                 return;
             }
 
@@ -1573,6 +1651,41 @@ void PresentationWidget::slotTransitionStep()
     m_transitionTimer->start( m_transitionDelay );
 }
 
+void PresentationWidget::slotShowPlaceholder()
+{
+    if ( m_frameIndex == -1 || hasFramePixmap( m_frameIndex ) )
+        return;
+
+    // the page is painted from a smaller pixmap of it, or as a blank one
+    m_showingPlaceholder = true;
+    generatePage();
+}
+
+void PresentationWidget::slotPrecomposeNextPage()
+{
+    // the transition goes on undisturbed, the next slide is composed after it
+    if ( m_transitionTimer->isActive() || m_showingPlaceholder )
+        return;
+
+    const int nextIndex = m_frameIndex + 1;
+    if ( m_frameIndex == -1 || nextIndex >= m_frames.count() || nextIndex == m_precomposedIndex )
+        return;
+
+    // composed once its pixmap is there, see notifyPageChanged()
+    if ( !hasFramePixmap( nextIndex ) )
+        return;
+
+    const qreal dpr = qApp->devicePixelRatio();
+    m_precomposedPixmap = QPixmap( m_width * dpr, m_height * dpr );
+    m_precomposedPixmap.setDevicePixelRatio( dpr );
+    QPainter pixmapPainter;
+    pixmapPainter.begin( &m_precomposedPixmap );
+    generateContentsPage( nextIndex, pixmapPainter );
+    pixmapPainter.end();
+    m_precomposedIndex = nextIndex;
+    m_precomposedSettings = slidePaintSettings();
+}
+
 void PresentationWidget::slotDelayedEvents()
 {
     recalcGeometry();
@@ -1703,14 +1816,16 @@ void PresentationWidget::applyNewScreenSize( const QSize & oldSize )
     const_cast< Okular::Page * >( m_frames[ m_frameIndex ]->page )->deletePixmap( this );
     // force the regeneration of the pixmap
     m_lastRenderedPixmap = QPixmap();
-    m_blockNotifications = true;
     requestPixmaps();
-    m_blockNotifications = false;
     }
+    m_precomposedPixmap = QPixmap();
+    m_precomposedIndex = -1;
     if ( m_transitionTimer->isActive() )
     {
         m_transitionTimer->stop();
     }
+    // until the pixmap of the new size is there, a placeholder is shown
+    m_showingPlaceholder = m_frameIndex != -1;
     generatePage( true /* no transitions */ );
 }
 
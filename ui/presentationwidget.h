@@ -14,6 +14,7 @@
 #include <qlist.h>
 #include <qpixmap.h>
 #include <qstringlist.h>
+#include <qvariant.h>
 #include <qwidget.h>
 #include "core/area.h"
 #include "core/observer.h"
@@ -58,6 +59,9 @@ class PresentationWidget : public QWidget, public Okular::DocumentObserver
         bool canUnloadPixmap( int pageNumber ) const override;
         void notifyCurrentPageChanged( int previous, int current ) override;
 
+        // paint with the new settings
+        void reparseConfig();
+
     public Q_SLOTS:
         void slotFind();
 
@@ -93,6 +97,8 @@ class PresentationWidget : public QWidget, public Okular::DocumentObserver
         void recalcGeometry();
         void repositionContent();
         void requestPixmaps();
+        bool hasFramePixmap( int page ) const;
+        int lookAheadPages() const;
         void setScreen( int );
         void applyNewScreenSize( const QSize & oldSize );
         void inhibitPowerManagement();
@@ -120,6 +126,8 @@ class PresentationWidget : public QWidget, public Okular::DocumentObserver
         QTimer * m_transitionTimer;
         QTimer * m_overlayHideTimer;
         QTimer * m_nextPageTimer;
+        QTimer * m_placeholderTimer;
+        QTimer * m_precomposeTimer;
         int m_transitionDelay;
         int m_transitionMul;
         int m_transitionSteps;
@@ -128,6 +136,11 @@ class PresentationWidget : public QWidget, public Okular::DocumentObserver
         QPixmap m_currentPagePixmap;
         QPixmap m_previousPagePixmap;
         double m_currentPixmapOpacity;
+        bool m_showingPlaceholder;
+        // the next slide, composed ahead of the transition to it
+        QPixmap m_precomposedPixmap;
+        int m_precomposedIndex;
+        QVariantList m_precomposedSettings;
 
         // misc stuff
         QWidget * m_parentWidget;
@@ -142,7 +155,6 @@ class PresentationWidget : public QWidget, public Okular::DocumentObserver
         KSelectAction * m_screenSelect;
         QDomElement m_currentDrawingToolElement;
         bool m_isSetup;
-        bool m_blockNotifications;
         bool m_inBlackScreenMode;
         bool m_showSummaryView;
         bool m_advanceSlides;
@@ -155,6 +167,8 @@ class PresentationWidget : public QWidget, public Okular::DocumentObserver
         void slotLastPage();
         void slotHideOverlay();
         void slotTransitionStep();
+        void slotShowPlaceholder();
+        void slotPrecomposeNextPage();
         void slotDelayedEvents();
         void slotPageChanged();
         void clearDrawings();
@@ -26,7 +26,7 @@
 
 SearchLineEdit::SearchLineEdit( QWidget * parent, Okular::Document * document )
     : KLineEdit( parent ), m_document( document ), m_minLength( 0 ),
-      m_caseSensitivity( Qt::CaseInsensitive ),
+      m_caseSensitivity( Qt::CaseInsensitive ), m_searchOptions( Okular::NoSearchOption ),
       m_searchType( Okular::Document::AllDocument ), m_id( -1 ),
       m_moveViewport( false ), m_changed( false ), m_fromStart( true ),
       m_findAsYouType( true ), m_searchRunning( false )
@@ -54,6 +54,12 @@ void SearchLineEdit::setSearchCaseSensitivity( Qt::CaseSensitivity cs )
     m_changed = true;
 }
 
+void SearchLineEdit::setSearchOptions( Okular::SearchOptions options )
+{
+    m_searchOptions = options;
+    m_changed = true;
+}
+
 void SearchLineEdit::setSearchMinimumLength( int length )
 {
     m_minLength = length;
@@ -242,7 +248,7 @@ void SearchLineEdit::startSearch()
         emit searchStarted();
         m_searchRunning = true;
         m_document->searchText( m_id, thistext, m_fromStart, m_caseSensitivity,
-                                m_searchType, m_moveViewport, m_color );
+                                m_searchType, m_moveViewport, m_color, m_searchOptions );
     }
     else
         m_document->resetSearch( m_id );
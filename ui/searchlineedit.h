@@ -30,6 +30,7 @@ class SearchLineEdit : public KLineEdit
         void clearText();
 
         void setSearchCaseSensitivity( Qt::CaseSensitivity cs );
+        void setSearchOptions( Okular::SearchOptions options );
         void setSearchMinimumLength( int length );
         void setSearchType( Okular::Document::SearchType type );
         void setSearchId( int id );
@@ -58,6 +59,7 @@ class SearchLineEdit : public KLineEdit
         QTimer * m_inputDelayTimer;
         int m_minLength;
         Qt::CaseSensitivity m_caseSensitivity;
+        Okular::SearchOptions m_searchOptions;
         Okular::Document::SearchType m_searchType;
         int m_id;
         QColor m_color;